@@ -16,6 +16,8 @@
 #include <wrl.h>
 #include <cstring>
 
+#include "named_property_table.hpp"
+
 #pragma push_macro("MIDL_CONST_ID")
 #undef MIDL_CONST_ID
 #define MIDL_CONST_ID const __declspec(selectany)
@@ -298,19 +300,18 @@ namespace ABI {
                             GRAPHICS_EFFECT_PROPERTY_MAPPING Mapping;
                         };
 
-                        HRESULT GetNamedPropertyMappingImpl(_In_count_(namedPropertyCount)
-                            const NamedProperty* namedProperties,
-                            UINT namedPropertyCount,
+                        // The table is built at compile time, a lookup hashes the name once instead of
+                        // comparing it against every property.
+                        template <size_t NamedPropertyCount>
+                        HRESULT GetNamedPropertyMappingImpl(
+                            const NamedPropertyTable<NamedProperty, NamedPropertyCount>& namedProperties,
                             _In_z_ LPCWSTR name,
                             _Out_ UINT* index,
                             _Out_ GRAPHICS_EFFECT_PROPERTY_MAPPING* mapping) {
-                            for (UINT i = 0; i < namedPropertyCount; ++i) {
-                                const auto& prop = namedProperties[i];
-                                if (_wcsicmp(name, prop.Name) == 0) {
-                                    *index = prop.Index;
-                                    *mapping = prop.Mapping;
-                                    return S_OK;
-                                }
+                            if (const auto* prop = namedProperties.Find(name)) {
+                                *index = prop->Index;
+                                *mapping = prop->Mapping;
+                                return S_OK;
                             }
                             return E_INVALIDARG;
                         }
@@ -398,9 +399,9 @@ namespace ABI {
   IFACEMETHODIMP GetNamedPropertyMapping(                                                      \
       _In_z_ LPCWSTR name, _Out_ UINT* index, _Out_ GRAPHICS_EFFECT_PROPERTY_MAPPING* mapping) \
       override {                                                                               \
-    static const NamedProperty s_Properties[] = {__VA_ARGS__};                                 \
-    return GetNamedPropertyMappingImpl(                                                        \
-        s_Properties, _countof(s_Properties), name, index, mapping);                           \
+    static constexpr NamedProperty s_Properties[] = {__VA_ARGS__};                             \
+    static constexpr NamedPropertyTable s_Table{s_Properties};                                 \
+    return GetNamedPropertyMappingImpl(s_Table, name, index, mapping);                         \
   }
 //----------------------------------------------------
 
@@ -1,8 +1,36 @@
 #include "framework.h"
 
+#include <wil/resource.h>
 #include <wil/result.h>
 #include <windowsx.h>
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+#include "animation_curve.hpp"
+#include "arena.hpp"
+#include "blend_mode.hpp"
+#include "caption_glyphs.hpp"
+#include "composition_recorder.hpp"
+#include "element_set.hpp"
+#include "environment_settings.hpp"
+#include "frame_scheduler.hpp"
+#include "glyph_cache.hpp"
+#include "graphics_device_pool.hpp"
+#include "glyph_rasterizer.hpp"
+#include "hit_test_code.hpp"
+#include "inline_function.hpp"
+#include "mouse_event.hpp"
+#include "mouse_leave_tracker.hpp"
+#include "mouse_state_machine.hpp"
+#include "row_layout.hpp"
+#include "system_menu.hpp"
+#include "trace_ring.hpp"
+#include "window_model.hpp"
 
 const SIZE szInitial = {700, 500};
 
@@ -17,9 +45,47 @@ namespace abi = ABI::Windows::UI::Composition;
 
 namespace Canvas = winrt::Microsoft::Graphics::Canvas;
 
+// Shared by every window, see EnsureCompositor.
 UIC::Compositor compositor{nullptr};
-UIC::Desktop::DesktopWindowTarget target{nullptr};
-UIC::ContainerVisual root{nullptr};
+winrt::Windows::System::DispatcherQueueController dispatcher_queue_controller{nullptr};
+
+// Every composition property write goes through the Set* helpers below, which skip writes of the
+// value a property already has.
+CompositionRecorder composition_recorder;
+
+// The recorder keys WinRT objects by the interface pointer behind the projection.
+template <typename T>
+struct CompositionObjectKey<
+    T,
+    std::enable_if_t<std::is_base_of_v<winrt::Windows::Foundation::IUnknown, T>>> {
+  static const void* Get(const T& object) { return winrt::get_abi(object); }
+};
+
+// Layout and renderer state changes are batched and applied once per DispatcherQueue tick. Low
+// priority lets a resize loop deliver every pending WM_SIZE before the frame is flushed.
+FrameScheduler frame_scheduler{[](std::function<void()> flush) {
+  return dispatcher_queue_controller.DispatcherQueue().TryEnqueue(
+      winrt::Windows::System::DispatcherQueuePriority::Low, [flush]() {
+        flush();
+        composition_recorder.EndFrame();
+      });
+}};
+
+void SetOffset(const UIC::Visual& visual, Numerics::float3 offset) {
+  SetOffset(composition_recorder, visual, offset);
+}
+
+void SetSize(const UIC::Visual& visual, Numerics::float2 size) {
+  SetSize(composition_recorder, visual, size);
+}
+
+void SetIsVisible(const UIC::Visual& visual, bool visible) {
+  SetIsVisible(composition_recorder, visual, visible);
+}
+
+void SetBrush(const UIC::SpriteVisual& visual, const UIC::CompositionBrush& brush) {
+  SetBrush(composition_recorder, visual, brush);
+}
 
 UIC::CompositionBrush CreateBackdropBrush(UIC::Compositor compositor) {
   auto with_blurred_backdrop =
@@ -43,41 +109,107 @@ void SetBackdrop(UIC::Desktop::DesktopWindowTarget target) {
   supports_backdrop->put_SystemBackdrop(brush.as<UIC::abi::ICompositionBrush>().get());
 }
 
+// The CanvasDevice and the CompositionGraphicsDevice every canvas brush draws with, for
+// GraphicsDevicePool.
+struct CompositionGraphicsBackend {
+  using Compositor = UIC::Compositor;
+  using Surface = UIC::CompositionDrawingSurface;
+  using Size = winrt::Windows::Foundation::Size;
+
+  struct Devices {
+    Canvas::CanvasDevice canvas_device;
+    UIC::CompositionGraphicsDevice composition_device;
+    Canvas::CanvasDevice::DeviceLost_revoker device_lost;
+  };
+
+  Devices CreateDevices(const Compositor& compositor, std::function<void()> device_lost) {
+    auto canvas_device = Canvas::CanvasDevice::GetSharedDevice();
+    auto revoker = canvas_device.DeviceLost(
+        winrt::auto_revoke,
+        [device_lost = std::move(device_lost)](auto&&, auto&&) { device_lost(); });
+    auto composition_device =
+        Canvas::UI::Composition::CanvasComposition::CreateCompositionGraphicsDevice(
+            compositor, canvas_device);
+    return Devices{canvas_device, composition_device, std::move(revoker)};
+  }
+
+  Surface CreateDrawingSurface(Devices& devices, const Size& size) {
+    return devices.composition_device.CreateDrawingSurface(
+        size,
+        winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
+        winrt::Windows::Graphics::DirectX::DirectXAlphaMode::Premultiplied);
+  }
+};
+
+void RedrawSurfaces();
+
+// DeviceLost can be raised in the middle of drawing a glyph into the cache, so the redraw waits
+// for the UI thread to get back to its queue.
+GraphicsDevicePool<CompositionGraphicsBackend> graphics_device_pool{[]() {
+  dispatcher_queue_controller.DispatcherQueue().TryEnqueue([]() { RedrawSurfaces(); });
+}};
+
+// Draws into `update_rect` (in pixels) of an existing drawing surface, leaving the rest of the
+// surface alone. The session keeps surface coordinates, translated so that `callable` can draw
+// at the origin as if the rect was the whole surface.
 template <typename Callable>
-UIC::CompositionSurfaceBrush CreateCanvasBrush(UIC::Compositor compositor,
-                                               winrt::Windows::Foundation::Size size,
-                                               Callable&& callable) {
-  auto canvas_device = Canvas::CanvasDevice::GetSharedDevice();
-  auto composition_device =
-      Canvas::UI::Composition::CanvasComposition::CreateCompositionGraphicsDevice(compositor,
-                                                                                  canvas_device);
-  auto drawing_surface = composition_device.CreateDrawingSurface(
-      size,
-      winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
-      winrt::Windows::Graphics::DirectX::DirectXAlphaMode::Premultiplied);
-
-  {
-    auto drawing_session =
-        Canvas::UI::Composition::CanvasComposition::CreateDrawingSession(drawing_surface);
+void DrawToSurface(UIC::CompositionDrawingSurface surface,
+                   const Rect& update_rect,
+                   Callable&& callable) {
+  // A copy, losing the device drops the pool's.
+  auto canvas_device = graphics_device_pool.GetDevices(surface.Compositor()).canvas_device;
+  try {
+    auto drawing_session = Canvas::UI::Composition::CanvasComposition::CreateDrawingSession(
+        surface,
+        Foundation::Rect{static_cast<float>(update_rect.left),
+                         static_cast<float>(update_rect.top),
+                         static_cast<float>(update_rect.Width()),
+                         static_cast<float>(update_rect.Height())});
+    drawing_session.Clear(UI::Colors::Transparent());
+    drawing_session.Transform(Numerics::make_float3x2_translation(
+        static_cast<float>(update_rect.left), static_cast<float>(update_rect.top)));
     callable(canvas_device, drawing_session);
     drawing_session.Flush();
+  } catch (const winrt::hresult_error& error) {
+    if (!canvas_device.IsDeviceLost(error.code())) {
+      throw;
+    }
+    // Win2D only raises DeviceLost when told to. The GraphicsDevicePool then has the surface
+    // drawn again with a new device.
+    canvas_device.RaiseDeviceLost();
   }
-
-  auto surface_brush = compositor.CreateSurfaceBrush();
-  surface_brush.Surface(drawing_surface);
-  return surface_brush;
 }
 
-UIC::CompositionSurfaceBrush CreateSvgBrush(UIC::Compositor compositor,
-                                            winrt::Windows::Foundation::Size size,
-                                            winrt::hstring svg) {
-  return CreateCanvasBrush(
-      compositor,
-      size,
-      [size, svg = std::move(svg)](Canvas::CanvasDevice canvas_device,
-                                   Canvas::CanvasDrawingSession drawing_session) {
-        auto svg_document = Canvas::Svg::CanvasSvgDocument::LoadFromXml(canvas_device, svg);
-        drawing_session.DrawSvg(svg_document, size);
+// Rasterizes on the CPU and only uploads the finished pixels, so no geometry work happens on the
+// device.
+void FillGlyphToSurface(UIC::CompositionDrawingSurface surface,
+                        const Rect& update_rect,
+                        const GlyphPath& glyph,
+                        float scale) {
+  auto width = update_rect.Width();
+  auto height = update_rect.Height();
+
+  GlyphRasterizer rasterizer{width, height};
+  rasterizer.AddPath(glyph, scale);
+  std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+  // Kept between glyphs, it only grows to the largest glyph cell.
+  thread_local std::vector<uint8_t> coverage;
+  coverage.resize(static_cast<size_t>(width) * height);
+  rasterizer.ResolveBgra(0, 0, 0, coverage.data(), pixels.data(), static_cast<size_t>(width) * 4);
+
+  DrawToSurface(
+      surface,
+      update_rect,
+      [&](Canvas::CanvasDevice canvas_device, Canvas::CanvasDrawingSession drawing_session) {
+        auto bitmap = Canvas::CanvasBitmap::CreateFromBytes(
+            canvas_device,
+            pixels,
+            width,
+            height,
+            winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
+            96.0f,
+            Canvas::CanvasAlphaMode::Premultiplied);
+        drawing_session.DrawImage(bitmap);
       });
 }
 
@@ -106,150 +238,161 @@ bool IsRTL() {
   return (reading_layout == 1);
 }
 
-enum class HitTestCode : uint32_t {
-  Error = static_cast<uint32_t>(HTERROR),
-  Nowhere = static_cast<uint32_t>(HTNOWHERE),
-  Client = HTCLIENT,
-  Caption = HTCAPTION,
-  SystemMenu = HTSYSMENU,
-  GrowBox = HTGROWBOX,
-  Menu = HTMENU,
-  HorizontalScroll = HTHSCROLL,
-  VerticalScroll = HTVSCROLL,
-  MinimizeButton = HTMINBUTTON,
-  MaximizeButton = HTMAXBUTTON,
-  LeftBorder = HTLEFT,
-  RightBorder = HTRIGHT,
-  TopBorder = HTTOP,
-  TopLeftCorner = HTTOPLEFT,
-  TopRightCorner = HTTOPRIGHT,
-  BottomBorder = HTBOTTOM,
-  BottomLeftCorner = HTBOTTOMLEFT,
-  BottomRightCorner = HTBOTTOMRIGHT,
-  Border = HTBORDER,
-  Object = HTOBJECT,
-  CloseButton = HTCLOSE,
-  HelpButton = HTHELP
-};
-
-std::ostream& operator<<(std::ostream& stream, const HitTestCode& ht) {
-#define CASE_(value)       \
-  case HitTestCode::value: \
-    return stream << #value;
-
-  switch (ht) {
-    CASE_(Error);
-    CASE_(Nowhere);
-    CASE_(Client);
-    CASE_(Caption);
-    CASE_(SystemMenu);
-    CASE_(GrowBox);
-    CASE_(Menu);
-    CASE_(HorizontalScroll);
-    CASE_(VerticalScroll);
-    CASE_(MinimizeButton);
-    CASE_(MaximizeButton);
-    CASE_(LeftBorder);
-    CASE_(RightBorder);
-    CASE_(TopBorder);
-    CASE_(TopLeftCorner);
-    CASE_(TopRightCorner);
-    CASE_(BottomBorder);
-    CASE_(BottomLeftCorner);
-    CASE_(BottomRightCorner);
-    CASE_(Border);
-    CASE_(Object);
-    CASE_(CloseButton);
-    CASE_(HelpButton);
-  }
-
-  return stream << "Unknown HitTestCode " << static_cast<uint32_t>(ht);
-#undef CASE_
-}
-
-bool IsSizeHitTestCode(HitTestCode code) {
-  auto value = static_cast<uint32_t>(code);
-  return value >= HTSIZEFIRST && value <= HTSIZELAST;
-}
-
+// Dropped on WM_SETTINGCHANGE, which is also how a UI language change is announced.
+EnvironmentSettings environment_settings{
+    IsRTL, []() { return ::GetSystemMetrics(SM_MENUDROPALIGNMENT) != 0; }};
+
+#define CHECK_HIT_TEST_CODE_(code, ht) \
+  static_assert(static_cast<uint32_t>(HitTestCode::code) == static_cast<uint32_t>(ht), #ht)
+
+CHECK_HIT_TEST_CODE_(Error, HTERROR);
+CHECK_HIT_TEST_CODE_(Nowhere, HTNOWHERE);
+CHECK_HIT_TEST_CODE_(Client, HTCLIENT);
+CHECK_HIT_TEST_CODE_(Caption, HTCAPTION);
+CHECK_HIT_TEST_CODE_(SystemMenu, HTSYSMENU);
+CHECK_HIT_TEST_CODE_(GrowBox, HTGROWBOX);
+CHECK_HIT_TEST_CODE_(Menu, HTMENU);
+CHECK_HIT_TEST_CODE_(HorizontalScroll, HTHSCROLL);
+CHECK_HIT_TEST_CODE_(VerticalScroll, HTVSCROLL);
+CHECK_HIT_TEST_CODE_(MinimizeButton, HTMINBUTTON);
+CHECK_HIT_TEST_CODE_(MaximizeButton, HTMAXBUTTON);
+CHECK_HIT_TEST_CODE_(LeftBorder, HTLEFT);
+CHECK_HIT_TEST_CODE_(RightBorder, HTRIGHT);
+CHECK_HIT_TEST_CODE_(TopBorder, HTTOP);
+CHECK_HIT_TEST_CODE_(TopLeftCorner, HTTOPLEFT);
+CHECK_HIT_TEST_CODE_(TopRightCorner, HTTOPRIGHT);
+CHECK_HIT_TEST_CODE_(BottomBorder, HTBOTTOM);
+CHECK_HIT_TEST_CODE_(BottomLeftCorner, HTBOTTOMLEFT);
+CHECK_HIT_TEST_CODE_(BottomRightCorner, HTBOTTOMRIGHT);
+CHECK_HIT_TEST_CODE_(Border, HTBORDER);
+CHECK_HIT_TEST_CODE_(Object, HTOBJECT);
+CHECK_HIT_TEST_CODE_(CloseButton, HTCLOSE);
+CHECK_HIT_TEST_CODE_(HelpButton, HTHELP);
+#undef CHECK_HIT_TEST_CODE_
+
+#define CHECK_SYSTEM_MENU_COMMAND_(command, sc) \
+  static_assert(static_cast<uint32_t>(SystemMenuCommand::command) == (sc), #sc)
+
+CHECK_SYSTEM_MENU_COMMAND_(Size, SC_SIZE);
+CHECK_SYSTEM_MENU_COMMAND_(Move, SC_MOVE);
+CHECK_SYSTEM_MENU_COMMAND_(Minimize, SC_MINIMIZE);
+CHECK_SYSTEM_MENU_COMMAND_(Maximize, SC_MAXIMIZE);
+CHECK_SYSTEM_MENU_COMMAND_(Close, SC_CLOSE);
+CHECK_SYSTEM_MENU_COMMAND_(Restore, SC_RESTORE);
+#undef CHECK_SYSTEM_MENU_COMMAND_
+
+using AbiBlendMode = UIC::abi::Effects::BlendEffectMode;
+
+#define CHECK_BLEND_MODE_(mode)                                                  \
+  static_assert(static_cast<uint32_t>(BlendMode::mode) ==                        \
+                    static_cast<uint32_t>(AbiBlendMode::BlendEffectMode_##mode), \
+                #mode)
+
+CHECK_BLEND_MODE_(Multiply);
+CHECK_BLEND_MODE_(Screen);
+CHECK_BLEND_MODE_(Darken);
+CHECK_BLEND_MODE_(Lighten);
+CHECK_BLEND_MODE_(Dissolve);
+CHECK_BLEND_MODE_(ColorBurn);
+CHECK_BLEND_MODE_(LinearBurn);
+CHECK_BLEND_MODE_(DarkerColor);
+CHECK_BLEND_MODE_(LighterColor);
+CHECK_BLEND_MODE_(ColorDodge);
+CHECK_BLEND_MODE_(LinearDodge);
+CHECK_BLEND_MODE_(Overlay);
+CHECK_BLEND_MODE_(SoftLight);
+CHECK_BLEND_MODE_(HardLight);
+CHECK_BLEND_MODE_(VividLight);
+CHECK_BLEND_MODE_(LinearLight);
+CHECK_BLEND_MODE_(PinLight);
+CHECK_BLEND_MODE_(HardMix);
+CHECK_BLEND_MODE_(Difference);
+CHECK_BLEND_MODE_(Exclusion);
+CHECK_BLEND_MODE_(Hue);
+CHECK_BLEND_MODE_(Saturation);
+CHECK_BLEND_MODE_(Color);
+CHECK_BLEND_MODE_(Luminosity);
+CHECK_BLEND_MODE_(Subtract);
+CHECK_BLEND_MODE_(Division);
+#undef CHECK_BLEND_MODE_
+
+static_assert(IsSizeHitTestCode(static_cast<HitTestCode>(HTSIZEFIRST)) &&
+                  IsSizeHitTestCode(static_cast<HitTestCode>(HTSIZELAST)),
+              "HTSIZEFIRST..HTSIZELAST");
+
+// One per window. The applier is the window's, see WindowModel; it knows what was set on the menu
+// last time, so that only what differs has to change.
 class SystemMenu {
  public:
-  explicit SystemMenu(HWND hwnd)
-      : hwnd_{hwnd}, hmenu_{THROW_LAST_ERROR_IF_NULL(::GetSystemMenu(hwnd, FALSE))} {}
+  SystemMenu(HWND hwnd, SystemMenuStateApplier& applier)
+      : hwnd_{hwnd},
+        hmenu_{THROW_LAST_ERROR_IF_NULL(::GetSystemMenu(hwnd, FALSE))},
+        applier_{applier} {}
 
-  void Show(HitTestCode hit_test_code, bool right_button, const POINT& client_point) {
+  SystemMenu(const SystemMenu&) = delete;
+  SystemMenu& operator=(const SystemMenu&) = delete;
+
+  void Show(HitTestCode hit_test_code, bool right_button, const Point& client_point) {
+    auto popup = GetSystemMenuPopupFlags(environment_settings, right_button);
     UINT flags = TPM_TOPALIGN | TPM_RIGHTBUTTON | TPM_RETURNCMD;
-    WI_SetFlagIf(flags, TPM_LAYOUTRTL, IsRTL());
-    WI_SetFlagIf(flags, TPM_RIGHTBUTTON, right_button);
-    WI_SetFlagIf(flags, TPM_RIGHTALIGN, ::GetSystemMetrics(SM_MENUDROPALIGNMENT));
+    WI_SetFlagIf(flags, TPM_LAYOUTRTL, popup.layout_rtl);
+    WI_SetFlagIf(flags, TPM_RIGHTBUTTON, popup.right_button);
+    WI_SetFlagIf(flags, TPM_RIGHTALIGN, popup.right_align);
 
     PrepareToShow(hit_test_code);
 
-    POINT screen_point = client_point;
+    POINT screen_point{client_point.x, client_point.y};
     THROW_IF_WIN32_BOOL_FALSE(::ClientToScreen(hwnd_, &screen_point));
 
+    showing_ = true;
     auto command =
         ::TrackPopupMenu(hmenu_, flags, screen_point.x, screen_point.y, 0, hwnd_, nullptr);
+    showing_ = false;
     ::SendMessageW(hwnd_, WM_SYSCOMMAND, command, MAKELPARAM(screen_point.x, screen_point.y));
   }
 
- private:
-  void PrepareToShow(HitTestCode hit_test_code) {
-    uint16_t default_command = SC_CLOSE;
-    if (hit_test_code == HitTestCode::Caption) {
-      default_command = ::IsZoomed(hwnd_) ? SC_RESTORE : SC_MAXIMIZE;
+  // From WM_INITMENUPOPUP. When Windows shows the menu itself (Alt+Space, the taskbar) it sets
+  // the items its own way, after which we no longer know their state.
+  void InitMenuPopup(HMENU menu) {
+    if (menu == hmenu_ && !showing_) {
+      applier_.Forget();
     }
-    THROW_IF_WIN32_BOOL_FALSE(::SetMenuDefaultItem(hmenu_, default_command, FALSE));
-
-    bool maximized = ::IsZoomed(hwnd_);
-    bool minimized = ::IsIconic(hwnd_);
-    bool restored = !maximized && !minimized;
+  }
 
-    SetMenuItemEnabled(SC_RESTORE, !restored);
-    SetMenuItemEnabled(SC_SIZE, restored);
-    SetMenuItemEnabled(SC_MOVE, restored);
-    SetMenuItemEnabled(SC_MINIMIZE, !minimized);
-    SetMenuItemEnabled(SC_MAXIMIZE, !maximized);
+  // The applier's menu calls.
+  void EnableItem(SystemMenuCommand command, bool enabled) {
+    auto id = static_cast<UINT>(command);
+    THROW_LAST_ERROR_IF(::EnableMenuItem(hmenu_, id, enabled ? MF_ENABLED : MF_DISABLED) == -1);
   }
 
-  void SetMenuItemEnabled(uint16_t command, bool enabled) {
-    THROW_LAST_ERROR_IF(::EnableMenuItem(hmenu_, command, enabled ? MF_ENABLED : MF_DISABLED) ==
-                        -1);
+  void SetDefaultItem(SystemMenuCommand command) {
+    THROW_IF_WIN32_BOOL_FALSE(::SetMenuDefaultItem(hmenu_, static_cast<UINT>(command), FALSE));
   }
 
  private:
+  void PrepareToShow(HitTestCode hit_test_code) {
+    applier_.Apply(GetSystemMenuState(::IsZoomed(hwnd_) != FALSE,
+                                      ::IsIconic(hwnd_) != FALSE,
+                                      hit_test_code == HitTestCode::Caption));
+  }
+
   HWND hwnd_;
   HMENU hmenu_;
+  SystemMenuStateApplier& applier_;
+  bool showing_ = false;
 };
 
-enum class RendererState { Normal, MouseOver, MouseDown };
-
 class Renderer {
  public:
   virtual ~Renderer() = default;
   virtual void SetRasterizationScale(float) {}
   virtual void SetState(RendererState) {}
+  // After the graphics device was lost, for renderers that draw into surfaces.
+  virtual void RedrawSurfaces() {}
 
   virtual UIC::Visual Visual() = 0;
 };
 
-template <typename RendererT>
-class DelegatingRenderer : public Renderer {
- protected:
-  template <typename... Args>
-  DelegatingRenderer(Args&&... args) : renderer_{std::forward<Args>(args)...} {}
-
-  RendererT& Delegate() { return renderer_; }
-
- public:
-  void SetRasterizationScale(float scale) { renderer_.SetRasterizationScale(scale); }
-  void SetState(RendererState state) { renderer_.SetState(state); }
-  UIC::Visual Visual() { return renderer_.Visual(); }
-
- private:
-  RendererT renderer_;
-};
-
 struct RendererColors {
   RendererColors(UI::Color color) : normal{color}, hover{color}, active{color} {}
   RendererColors(UI::Color normal, UI::Color hover, UI::Color active)
@@ -259,71 +402,147 @@ struct RendererColors {
   UI::Color active;
 };
 
-class ContainerRenderer final : public Renderer {
+// A container whose children are known at compile time. They are stored inline in a tuple and
+// the fan-out is unrolled, so propagating state is a direct (and inlinable) call per child
+// instead of a virtual call through a list.
+template <typename... Children>
+class StaticContainerRenderer final : public Renderer {
  public:
-  explicit ContainerRenderer(UIC::Compositor compositor)
-      : visual_{compositor.CreateContainerVisual()} {}
+  StaticContainerRenderer(UIC::Compositor compositor, Children... children)
+      : children_{std::move(children)...}, visual_{compositor.CreateContainerVisual()} {
+    ForEach([this](auto& child) { visual_.Children().InsertAtTop(child.Visual()); });
+  }
 
-  void InsertAtTop(std::unique_ptr<Renderer> renderer) {
-    visual_.Children().InsertAtTop(renderer->Visual());
-    renderers_.emplace_back(std::move(renderer));
+  template <size_t Index>
+  auto& Get() {
+    return std::get<Index>(children_);
   }
 
-  void SetState(RendererState state) final { ForEach(&Renderer::SetState, state); }
+  void SetState(RendererState state) final {
+    ForEach([state](auto& child) { child.SetState(state); });
+  }
 
-  void SetRasterizationScale(float dpi) final { ForEach(&Renderer::SetRasterizationScale, dpi); }
+  void SetRasterizationScale(float scale) final {
+    ForEach([scale](auto& child) { child.SetRasterizationScale(scale); });
+  }
+
+  void RedrawSurfaces() final {
+    ForEach([](auto& child) { child.RedrawSurfaces(); });
+  }
 
   UIC::Visual Visual() final { return visual_; }
 
  private:
-  template <typename Callable, typename... Args>
-  void ForEach(Callable&& callable, Args&&... args) {
-    for (auto& renderer : renderers_) {
-      std::invoke(callable, renderer, args...);
-    }
+  template <typename Callable>
+  void ForEach(Callable&& callable) {
+    std::apply([&](auto&... children) { (callable(children), ...); }, children_);
   }
 
- private:
-  std::vector<std::unique_ptr<Renderer>> renderers_;
+  std::tuple<Children...> children_;
   UIC::ContainerVisual visual_;
 };
 
+// The brush color is an expression over a property set holding the three colors and the state,
+// so a state change is a single scalar write and the compositor picks the color.
 class BackgroundRenderer final : public Renderer {
  public:
   BackgroundRenderer(UIC::Compositor compositor, RendererColors background_colors)
       : visual_{compositor.CreateSpriteVisual()},
-        colors_{background_colors},
-        brush_{compositor.CreateColorBrush()} {
-    visual_.Brush(brush_);
+        brush_{compositor.CreateColorBrush()},
+        properties_{compositor.CreatePropertySet()} {
+    SetBrush(visual_, brush_);
     visual_.RelativeSizeAdjustment({1, 1});
-    brush_.Color(background_colors.normal);
+
+    properties_.InsertColor(L"Normal", background_colors.normal);
+    properties_.InsertColor(L"Hover", background_colors.hover);
+    properties_.InsertColor(L"Active", background_colors.active);
+    // Animated from here on, so not through the recorder.
+    properties_.InsertScalar(L"State", StateValue(RendererState::Normal));
+
+    // State goes 0, 1, 2 for normal, hover, active. Written with lerps rather than comparisons
+    // so that animating State blends between the colors.
+    auto color = compositor.CreateExpressionAnimation(
+        L"ColorLerp(ColorLerp(p.Normal, p.Hover, Clamp(p.State, 0, 1)), p.Active, "
+        L"Clamp(p.State - 1, 0, 1))");
+    color.SetReferenceParameter(L"p", properties_);
+    brush_.StartAnimation(L"Color", color);
+
+    // Hover eases in and out, a press springs in, and letting go eases back to hover.
+    auto ease = CubicBezier{0.25, 0.1, 0.25, 1};
+    auto press = Spring{1.0, 0.1};
+    auto press_duration = std::chrono::duration_cast<Foundation::TimeSpan>(
+        std::chrono::duration<double>{press.Duration()});
+    transitions_ = {
+        CreateTransition(compositor, ease, RendererState::Normal, kHoverDuration),
+        CreateTransition(compositor, ease, RendererState::MouseOver, kHoverDuration),
+        CreateTransition(compositor, press, RendererState::MouseDown, press_duration)};
   }
 
+  // The compositor runs the transition, all this thread does is start it.
   void SetState(RendererState state) final {
+    if (state == state_) {
+      return;
+    }
+    state_ = state;
+    properties_.StartAnimation(L"State", transitions_[static_cast<size_t>(state)]);
+  }
+
+  UIC::Visual Visual() final { return visual_; }
+
+ private:
+  static constexpr std::chrono::milliseconds kHoverDuration{150};
+  // Enough for the linear steps between key frames to be within a couple of 8-bit color steps
+  // of the curve, see AnimationCurveKeyFrameError.
+  static constexpr size_t kTransitionKeyFrames = 32;
+
+  static float StateValue(RendererState state) {
     switch (state) {
       case RendererState::MouseDown:
-        brush_.Color(colors_.active);
-        break;
+        return 2.0f;
       case RendererState::MouseOver:
-        brush_.Color(colors_.hover);
-        break;
+        return 1.0f;
       default:
-        brush_.Color(colors_.normal);
-        break;
+        return 0.0f;
     }
   }
 
-  UIC::Visual Visual() final { return visual_; }
+  // Animates State from wherever it is, mid-transition included, to the value for the given
+  // state along the curve.
+  template <typename Curve>
+  static UIC::ScalarKeyFrameAnimation CreateTransition(const UIC::Compositor& compositor,
+                                                       const Curve& curve,
+                                                       RendererState state,
+                                                       Foundation::TimeSpan duration) {
+    auto animation = compositor.CreateScalarKeyFrameAnimation();
+    auto linear = compositor.CreateLinearEasingFunction();
+    auto distance = L"(" + std::to_wstring(StateValue(state)) + L" - this.StartingValue)";
+    for (const auto& frame : SampleKeyFrames<kTransitionKeyFrames>(curve)) {
+      animation.InsertExpressionKeyFrame(
+          frame.progress,
+          L"this.StartingValue + " + distance + L" * " + std::to_wstring(frame.value),
+          linear);
+    }
+    animation.Duration(duration);
+    return animation;
+  }
 
- private:
-  UIC::CompositionColorBrush brush_;
   UIC::SpriteVisual visual_;
-  RendererColors colors_;
+  UIC::CompositionColorBrush brush_;
+  UIC::CompositionPropertySet properties_;
+  std::array<UIC::ScalarKeyFrameAnimation, 3> transitions_{nullptr, nullptr, nullptr};
+  RendererState state_ = RendererState::Normal;
+};
+
+// What a SpriteRenderer paints: a brush and, for brushes that must be shown at their own pixel
+// size rather than stretched to the parent, the size the visual should take.
+struct SpriteContent {
+  UIC::CompositionBrush brush = nullptr;
+  std::optional<Numerics::float2> size;
 };
 
 class SpriteRenderer final : public Renderer {
  public:
-  using BrushFactory = std::function<UIC::CompositionBrush(UIC::Compositor, float)>;
+  using BrushFactory = InlineFunction<SpriteContent(UIC::Compositor, float)>;
 
   SpriteRenderer(UIC::Compositor compositor, BrushFactory brush_factory = nullptr)
       : compositor_{std::move(compositor)},
@@ -344,13 +563,20 @@ class SpriteRenderer final : public Renderer {
     }
   }
 
+  // The brush factory hands out a brush on a new surface, see GlyphCache.
+  void RedrawSurfaces() final { Update(); }
+
   UIC::Visual Visual() final { return visual_; }
   UIC::SpriteVisual SpriteVisual() { return visual_; }
 
  private:
   void Update() {
-    brush_ = brush_factory_ ? brush_factory_(compositor_, scale_) : nullptr;
-    visual_.Brush(brush_);
+    auto content = brush_factory_ ? brush_factory_(compositor_, scale_) : SpriteContent{};
+    brush_ = content.brush;
+    SetBrush(visual_, brush_);
+    if (content.size) {
+      SetSize(visual_, *content.size);
+    }
   }
 
   BrushFactory brush_factory_;
@@ -361,90 +587,194 @@ class SpriteRenderer final : public Renderer {
   float scale_ = 1.0f;
 };
 
-std::unique_ptr<SpriteRenderer> MakeButtonGlyphRenderer(UIC::Compositor compositor,
-                                                        winrt::hstring glyph) {
-  return std::make_unique<SpriteRenderer>(
-      compositor,
-      [glyph = std::move(glyph)](UIC::Compositor compositor, float rasterization_scale) {
-        auto size = 16.0f * rasterization_scale;
-        auto brush = CreateSvgBrush(compositor, {size, size}, glyph);
-        brush.Stretch(UIC::CompositionStretch::None);
-        brush.SnapToPixels(true);
-        return brush;
-      });
+// Draws the glyph cache's atlas pages as composition surfaces. Every glyph gets its own surface
+// brush, offset so that the page shows through a glyph-sized visual at the glyph's cell; brushes
+// already handed out keep their page's surface alive after GlyphAtlasCache drops it.
+struct CompositionGlyphBackend {
+  using Page = UIC::CompositionDrawingSurface;
+
+  struct Glyph {
+    UIC::CompositionSurfaceBrush brush{nullptr};
+    Numerics::float2 size;  // In pixels, padding included.
+  };
+
+  Page CreatePage(int32_t size) {
+    auto surface = graphics_device_pool.CreateDrawingSurface(
+        compositor, {static_cast<float>(size), static_cast<float>(size)});
+    DrawToSurface(surface, Rect{0, 0, size, size}, [](auto&&, auto&&) {});
+    return surface;
+  }
+
+  Glyph DrawGlyph(
+      Page& page, const Rect& cell, const Rect& glyph_rect, const GlyphPath& glyph, float scale) {
+    FillGlyphToSurface(page, glyph_rect, glyph, scale);
+
+    auto brush = compositor.CreateSurfaceBrush(page);
+    brush.Stretch(UIC::CompositionStretch::None);
+    brush.HorizontalAlignmentRatio(0.0f);
+    brush.VerticalAlignmentRatio(0.0f);
+    brush.Offset({-static_cast<float>(cell.left), -static_cast<float>(cell.top)});
+    brush.SnapToPixels(true);
+    return Glyph{brush, {static_cast<float>(cell.Width()), static_cast<float>(cell.Height())}};
+  }
+
+  UIC::Compositor compositor{nullptr};
+};
+
+// Rasterized glyphs shared by every SpriteRenderer, see GlyphAtlasCache. Starts over when the
+// compositor or the graphics device changes, the surfaces are no good after either.
+class GlyphCache : public GlyphAtlasCache<CompositionGlyphBackend> {
+ public:
+  static constexpr size_t kMaxBytes = 4 * 1024 * 1024;
+  static constexpr int32_t kPageSize = 256;
+
+  GlyphCache() : GlyphAtlasCache{kMaxBytes, kPageSize} {}
+
+  Glyph Get(UIC::Compositor compositor, const GlyphPath& glyph, float rasterization_scale) {
+    if (GetBackend().compositor != compositor ||
+        generation_ != graphics_device_pool.Generation()) {
+      Clear();
+      GetBackend().compositor = compositor;
+      generation_ = graphics_device_pool.Generation();
+    }
+    return GlyphAtlasCache::Get(glyph, rasterization_scale);
+  }
+
+ private:
+  uint32_t generation_ = 0;
+};
+
+GlyphCache glyph_cache;
+
+SpriteRenderer MakeButtonGlyphRenderer(UIC::Compositor compositor, const GlyphPath& glyph) {
+  return SpriteRenderer{
+      compositor, [glyph = &glyph](UIC::Compositor compositor, float rasterization_scale) {
+        auto cached = glyph_cache.Get(compositor, *glyph, rasterization_scale);
+        return SpriteContent{cached.brush, cached.size};
+      }};
 }
 
-class ButtonRenderer final : public DelegatingRenderer<ContainerRenderer> {
+// Every glyph is a SpriteRenderer, the index only exists so that a pack can expand to one per
+// glyph.
+template <size_t>
+using GlyphSpriteRenderer = SpriteRenderer;
+
+template <typename Indices>
+struct ButtonChildren;
+
+template <size_t... Indices>
+struct ButtonChildren<std::index_sequence<Indices...>> {
+  using Type = StaticContainerRenderer<BackgroundRenderer, GlyphSpriteRenderer<Indices>...>;
+};
+
+// A background with GlyphCount glyphs on top, only the active one of which is visible. The
+// whole button is one object with no further allocations.
+template <size_t GlyphCount>
+class ButtonRenderer final : public Renderer {
  public:
-  ButtonRenderer(UIC::Compositor compositor, RendererColors background_colors, winrt::hstring glyph)
-      : ButtonRenderer{compositor, background_colors, std::vector{glyph}} {}
+  using Glyphs = std::array<const GlyphPath*, GlyphCount>;
 
   ButtonRenderer(UIC::Compositor compositor,
                  RendererColors background_colors,
-                 const std::vector<winrt::hstring>& glyphs)
-      : DelegatingRenderer{compositor} {
-    Delegate().InsertAtTop(std::make_unique<BackgroundRenderer>(compositor, background_colors));
-    glyph_visuals_.reserve(glyphs.size());
-
-    auto first = true;
-    for (const auto& glyph : glyphs) {
-      auto renderer = MakeButtonGlyphRenderer(compositor, glyph);
-      auto visual = renderer->Visual();
-      glyph_visuals_.push_back(visual);
-      Delegate().InsertAtTop(std::move(renderer));
-
-      visual.RelativeSizeAdjustment({1, 1});
-      visual.IsVisible(first);
-      first = false;
-    }
-  }
+                 const Glyphs& glyphs)
+      : ButtonRenderer{
+            compositor, background_colors, glyphs, std::make_index_sequence<GlyphCount>{}} {}
 
   void SetActiveGlyph(size_t index) {
-    for (size_t i = 0; i < glyph_visuals_.size(); ++i) {
-      glyph_visuals_[i].IsVisible(i == index);
-    }
+    ForEachGlyph([index](SpriteRenderer& glyph, size_t i) {
+      SetIsVisible(glyph.SpriteVisual(), i == index);
+    });
   }
 
+  void SetState(RendererState state) final { children_.SetState(state); }
+  void SetRasterizationScale(float scale) final { children_.SetRasterizationScale(scale); }
+  void RedrawSurfaces() final { children_.RedrawSurfaces(); }
+  UIC::Visual Visual() final { return children_.Visual(); }
+
  private:
-  std::vector<UIC::Visual> glyph_visuals_;
+  template <size_t... Indices>
+  ButtonRenderer(UIC::Compositor compositor,
+                 RendererColors background_colors,
+                 const Glyphs& glyphs,
+                 std::index_sequence<Indices...>)
+      : children_{compositor,
+                  BackgroundRenderer{compositor, background_colors},
+                  MakeButtonGlyphRenderer(compositor, *glyphs[Indices])...} {
+    ForEachGlyph([](SpriteRenderer& glyph, size_t i) {
+      // The glyph visual is sized to its atlas cell, keep it centered in the button.
+      auto visual = glyph.SpriteVisual();
+      visual.AnchorPoint({0.5f, 0.5f});
+      visual.RelativeOffsetAdjustment({0.5f, 0.5f, 0.0f});
+      SetIsVisible(visual, i == 0);
+    });
+  }
+
+  template <typename Callable>
+  void ForEachGlyph(Callable&& callable) {
+    ForEachGlyph(callable, std::make_index_sequence<GlyphCount>{});
+  }
+
+  // The background is child 0, glyph i is child i + 1.
+  template <typename Callable, size_t... Indices>
+  void ForEachGlyph(Callable& callable, std::index_sequence<Indices...>) {
+    (callable(children_.template Get<Indices + 1>(), Indices), ...);
+  }
+
+  typename ButtonChildren<std::make_index_sequence<GlyphCount>>::Type children_;
 };
 
-enum class MouseButton { Left, Right };
+Rect ToRect(const RECT& rect) {
+  return Rect{rect.left, rect.top, rect.right, rect.bottom};
+}
+
+Point ToPoint(const POINT& point) {
+  return Point{point.x, point.y};
+}
 
-class Element {
+class Element : public ElementSetMember {
  public:
+  // Renderers are allocated from `arena`, which must outlive the element.
+  explicit Element(Arena& arena) : arena_{arena} {}
+
  public:
   virtual ~Element() = default;
-  virtual void MouseClick(MouseButton, const POINT&) {}
-  virtual void MouseDoubleClick(MouseButton, const POINT&) {}
-  virtual void MouseDown(MouseButton, const POINT&) {}
+  virtual void MouseClick(MouseButton, const Point&) {}
+  virtual void MouseDoubleClick(MouseButton, const Point&) {}
+  virtual void MouseDown(MouseButton, const Point&) {}
   virtual void MouseEnter() {}
   virtual void MouseLeave() {}
-  virtual void MouseUp(MouseButton, const POINT&) {}
+  virtual void MouseUp(MouseButton, const Point&) {}
   virtual void WindowMaximized(bool) {}
 
  public:
-  const RECT& Bounds() const { return bounds_; }
-  void Bounds(RECT bounds) {
-    bounds_ = std::move(bounds);
+  using ElementSetMember::Bounds;
+  void Bounds(const Rect& bounds) {
+    if (!SetBounds(bounds)) {
+      return;
+    }
     if (renderer_) {
       auto left = static_cast<float>(bounds.left);
       auto top = static_cast<float>(bounds.top);
-      Visual().Offset({left, top, 0.0f});
+      SetOffset(Visual(), {left, top, 0.0f});
 
-      auto width = static_cast<float>(bounds.right - bounds.left);
-      auto height = static_cast<float>(bounds.bottom - bounds.top);
-      Visual().Size({width, height});
+      auto width = static_cast<float>(bounds.Width());
+      auto height = static_cast<float>(bounds.Height());
+      SetSize(Visual(), {width, height});
     }
   }
 
   bool CallDefWindowProc() const { return call_dwp_; }
   void CallDefWindowProc(bool value) { call_dwp_ = value; }
 
-  bool Contains(const POINT& pt) const { return ::PtInRect(&bounds_, pt); }
+  bool Contains(const Point& pt) const { return Bounds().Contains(pt); }
 
   HitTestCode HitTest() const { return hit_test_result_; }
-  void HitTest(HitTestCode value) { hit_test_result_ = value; }
+  // Also resets the DefWindowProc routing to the code's default, so CallDefWindowProc(bool) has
+  // to come after.
+  void HitTest(HitTestCode value) {
+    hit_test_result_ = value;
+    call_dwp_ = GetHitTestCodeInfo(value).call_def_window_proc;
+  }
 
   void MouseState(RendererState state) {
     if (renderer_) {
@@ -453,6 +783,10 @@ class Element {
   }
 
   void SetDpi(uint32_t dpi) {
+    if (dpi == dpi_) {
+      return;
+    }
+    dpi_ = dpi;
     if (renderer_) {
       renderer_->SetRasterizationScale(dpi / 96.0f);
     }
@@ -460,45 +794,39 @@ class Element {
 
   UIC::Visual Visual() const { return renderer_ ? renderer_->Visual() : nullptr; }
 
+  void RedrawSurfaces() {
+    if (renderer_) {
+      renderer_->RedrawSurfaces();
+    }
+  }
+
  protected:
   template <typename T, typename... Args>
   T& CreateRenderer(Args&&... args) {
-    auto renderer = std::make_unique<T>(std::forward<Args>(args)...);
-    T& ref = *renderer;
-    renderer_ = std::move(renderer);
-    return ref;
+    T& renderer = arena_.Make<T>(std::forward<Args>(args)...);
+    renderer_ = &renderer;
+    return renderer;
   }
 
  private:
-  RECT bounds_{};
+  Arena& arena_;
+  uint32_t dpi_ = 0;
   bool call_dwp_ = false;
   HitTestCode hit_test_result_ = HitTestCode::Client;
-  std::unique_ptr<Renderer> renderer_ = nullptr;
+  Renderer* renderer_ = nullptr;
 };
 
-static constexpr const wchar_t* MaximizeGlyph =
-    L"<svg viewBox='0 0 16 16'><path d='M4.5 3A1.5 1.5 0 003 4.5v7A1.5 1.5 0 004.5 13h7a1.5 1.5 0 "
-    L"001.5-1.5v-7A1.5 1.5 0 0011.5 3h-7zm0 1h7a.5.5 0 01.5.5v7a.5.5 0 01-.5.5h-7a.5.5 0 "
-    L"01-.5-.5v-7a.5.5 0 01.5-.5z'></path></svg>";
-
-static constexpr const wchar_t* RestoreGlyph =
-    L"<svg viewBox='0 0 16 16'><path d='M5.084 4a1.5 1.5 0 011.415-1h3.5a3 3 0 013 3v3.5a1.5 1.5 0 "
-    L"01-1 1.415V6a2 2 0 00-2-2H5.084z'></path><path d='M4.5 5h5A1.5 1.5 0 0111 6.5v5A1.5 1.5 0 "
-    L"019.5 13h-5A1.5 1.5 0 013 11.5v-5A1.5 1.5 0 014.5 5zm0 1a.5.5 0 00-.5.5v5a.5.5 0 "
-    L"00.5.5h5a.5.5 0 00.5-.5v-5a.5.5 0 00-.5-.5h-5z'></path></svg>";
-
 class MaximizeElement : public Element {
  public:
-  explicit MaximizeElement(HWND hwnd, UIC::Compositor compositor, RendererColors background)
-      : hwnd_{hwnd},
-        renderer_{CreateRenderer<ButtonRenderer>(
-            compositor,
-            background,
-            std::vector<winrt::hstring>{RestoreGlyph, MaximizeGlyph})} {
+  MaximizeElement(Arena& arena, HWND hwnd, UIC::Compositor compositor, RendererColors background)
+      : Element{arena},
+        hwnd_{hwnd},
+        renderer_{CreateRenderer<ButtonRenderer<2>>(
+            compositor, background, ButtonRenderer<2>::Glyphs{&RestoreGlyph, &MaximizeGlyph})} {
     HitTest(HitTestCode::MaximizeButton);
   }
 
-  void MouseClick(MouseButton button, const POINT&) final {
+  void MouseClick(MouseButton button, const Point&) final {
     if (button == MouseButton::Left) {
       ::ShowWindow(hwnd_, ::IsZoomed(hwnd_) ? SW_RESTORE : SW_MAXIMIZE);
     }
@@ -507,23 +835,20 @@ class MaximizeElement : public Element {
   void Maximized(bool value) { renderer_.SetActiveGlyph(value ? 0 : 1); }
 
  private:
-  ButtonRenderer& renderer_;
+  ButtonRenderer<2>& renderer_;
   HWND hwnd_;
 };
 
-constexpr const wchar_t* MinimizeGlyph =
-    L"<svg viewBox='0 0 16 16'><path d='M3.5 7h9c.28 0 .5.22.5.5s-.22.5-.5.5h-9c-.28 "
-    L"0-.5-.22-.5-.5s.22-.5.5-.5z'></path></svg>";
-
 class MinimizeElement : public Element {
  public:
-  explicit MinimizeElement(HWND hwnd, UIC::Compositor compositor, RendererColors background)
-      : hwnd_{hwnd} {
+  MinimizeElement(Arena& arena, HWND hwnd, UIC::Compositor compositor, RendererColors background)
+      : Element{arena}, hwnd_{hwnd} {
     HitTest(HitTestCode::MinimizeButton);
-    CreateRenderer<ButtonRenderer>(compositor, background, MinimizeGlyph);
+    CreateRenderer<ButtonRenderer<1>>(
+        compositor, background, ButtonRenderer<1>::Glyphs{&MinimizeGlyph});
   }
 
-  void MouseClick(MouseButton button, const POINT&) final {
+  void MouseClick(MouseButton button, const Point&) final {
     if (button == MouseButton::Left) {
       ::CloseWindow(hwnd_);
     }
@@ -533,21 +858,16 @@ class MinimizeElement : public Element {
   HWND hwnd_;
 };
 
-constexpr const wchar_t* CloseGlyph =
-    L"<svg viewBox='0 0 16 16'><path d='M2.589 2.716l.058-.069a.498.498 0 01.637-.058l.069.058L8 "
-    L"7.293l4.646-4.647a.5.5 0 01.707.707L8.707 8l4.647 4.646a.5.5 0 01.058.638l-.058.069a.5.5 0 "
-    L"01-.638.058l-.069-.058L8 8.707l-4.646 4.647a.5.5 0 01-.707-.707L7.293 8 2.646 3.354a.501.501 "
-    L"0 01-.057-.638l.058-.069-.058.069z'></path></svg>";
-
 class CloseElement : public Element {
  public:
-  explicit CloseElement(HWND hwnd, UIC::Compositor compositor, RendererColors background)
-      : hwnd_{hwnd} {
+  CloseElement(Arena& arena, HWND hwnd, UIC::Compositor compositor, RendererColors background)
+      : Element{arena}, hwnd_{hwnd} {
     HitTest(HitTestCode::CloseButton);
-    CreateRenderer<ButtonRenderer>(compositor, background, CloseGlyph);
+    CreateRenderer<ButtonRenderer<1>>(
+        compositor, background, ButtonRenderer<1>::Glyphs{&CloseGlyph});
   }
 
-  void MouseClick(MouseButton button, const POINT&) final {
+  void MouseClick(MouseButton button, const Point&) final {
     if (button == MouseButton::Left) {
       THROW_IF_WIN32_BOOL_FALSE(::DestroyWindow(hwnd_));
     }
@@ -559,209 +879,79 @@ class CloseElement : public Element {
 
 class CaptionElement : public Element {
  public:
-  explicit CaptionElement(HWND hwnd, UIC::Compositor compositor, UI::Color background)
-      : hwnd_{hwnd} {
-    CallDefWindowProc(true);
+  CaptionElement(Arena& arena,
+                 SystemMenu& system_menu,
+                 UIC::Compositor compositor,
+                 UI::Color background)
+      : Element{arena}, system_menu_{system_menu} {
     CreateRenderer<BackgroundRenderer>(compositor, RendererColors{background});
     HitTest(HitTestCode::Caption);
   }
 
-  void MouseClick(MouseButton button, const POINT& pt) final {
+  void MouseClick(MouseButton button, const Point& pt) final {
     if (button == MouseButton::Right) {
-      SystemMenu{hwnd_}.Show(HitTest(), true, pt);
+      system_menu_.Show(HitTest(), true, pt);
     }
   }
 
  private:
-  HWND hwnd_;
+  SystemMenu& system_menu_;
 };
 
 class SystemMenuElement : public Element {
  public:
-  explicit SystemMenuElement(HWND hwnd, UIC::Compositor compositor, UI::Color background)
-      : hwnd_{hwnd} {
+  SystemMenuElement(Arena& arena,
+                    HWND hwnd,
+                    SystemMenu& system_menu,
+                    UIC::Compositor compositor,
+                    UI::Color background)
+      : Element{arena}, hwnd_{hwnd}, system_menu_{system_menu} {
     CreateRenderer<BackgroundRenderer>(compositor, RendererColors{background});
     HitTest(HitTestCode::SystemMenu);
   }
 
-  void MouseDown(MouseButton button, const POINT&) final {
+  void MouseDown(MouseButton button, const Point&) final {
     if (button == MouseButton::Left) {
       ShowMenu(button);
     }
   }
 
-  void MouseClick(MouseButton button, const POINT& point) final {
+  void MouseClick(MouseButton button, const Point& point) final {
     if (button == MouseButton::Right) {
       ShowMenu(button, point);
     }
   }
 
-  void MouseDoubleClick(MouseButton button, const POINT&) final {
+  void MouseDoubleClick(MouseButton button, const Point&) final {
     if (button == MouseButton::Left) {
       THROW_IF_WIN32_BOOL_FALSE(::DestroyWindow(hwnd_));
     }
   }
 
  private:
-  void ShowMenu(MouseButton button, std::optional<POINT> point = std::nullopt) const {
-    SystemMenu{hwnd_}.Show(HitTest(),
-                           button == MouseButton::Right,
-                           point.value_or(POINT{Bounds().left, Bounds().bottom}));
+  void ShowMenu(MouseButton button, std::optional<Point> point = std::nullopt) const {
+    system_menu_.Show(HitTest(),
+                      button == MouseButton::Right,
+                      point.value_or(Point{Bounds().left, Bounds().bottom}));
   }
 
  private:
   HWND hwnd_;
+  SystemMenu& system_menu_;
 };
 
-std::ostream& operator<<(std::ostream& stream, const RECT& rect) {
-  auto width = (rect.right - rect.left);
-  auto height = (rect.bottom - rect.top);
-  return stream << rect.left << "," << rect.top << " " << width << "x" << height;
-}
-
-std::ostream& operator<<(std::ostream& stream, const Element& el) {
-  return stream << el.HitTest() << " (" << el.Bounds() << ')';
-}
-
-std::ostream& operator<<(std::ostream& stream, const Element* el) {
-  if (el) {
-    return stream << *el;
-  } else {
-    return stream << "(none)";
-  }
-}
-
+// Shared by the mouse visuals of every window.
 UIC::CompositionColorBrush mouse_brush = nullptr;
 UIC::CompositionColorBrush mouse_down_brush = nullptr;
-UIC::SpriteVisual mouse_visual = nullptr;
-
-template <typename It>
-class Range {
- public:
-  Range(It begin, It end) : begin_{begin}, end_{end} {}
-
-  It begin() const { return begin_; }
-  It end() const { return end_; }
-
- private:
-  It begin_;
-  It end_;
-};
-
-class ElementSet {
- private:
-  using ElementRef = std::reference_wrapper<Element>;
-  using ElementRefVector = std::vector<ElementRef>;
-
- public:
-  ElementSet() {}
-  ElementSet(std::initializer_list<ElementRef> elements) : elements_{elements} {}
-
-  auto BottomUp() const { return Range{elements_.begin(), elements_.end()}; }
-
-  auto TopDown() const { return Range{elements_.rbegin(), elements_.rend()}; }
-
-  Element* FindAtClientPointTopDown(const POINT& pt) const {
-    for (Element& el : TopDown()) {
-      if (el.Contains(pt)) {
-        return &el;
-      }
-    }
-    return nullptr;
-  }
 
- private:
-  ElementRefVector elements_;
-};
+constexpr int32_t kCaptionHeight = 47;
+constexpr int32_t kCaptionButtonWidth = 44;
 
-class MouseStateMachine {
- public:
-  explicit MouseStateMachine(ElementSet& elements) : elements_{elements} {}
-
-  void MouseDown(Element* element, MouseButton button, const POINT& point) {
-    mouse_down_element_ = element;
-    mouse_down_button_ = button;
-    for (Element& el : elements_.TopDown()) {
-      el.MouseState(&el == element ? RendererState::MouseDown : RendererState::Normal);
-    };
-    if (element) {
-      element->MouseDown(button, point);
-    }
-  }
+// Every Element::Bounds that changes anything sets the visual's Offset and Size, at most.
+constexpr uint64_t kWritesPerBounds = 2;
 
-  void MouseDoubleClick(Element* element, MouseButton button, const POINT& point) {
-    MouseMove(element);
-    if (element) {
-      element->MouseDoubleClick(button, point);
-    }
-  }
-
-  void MouseUp(Element* element, MouseButton button, const POINT& point) {
-    auto same_as_mouse_down = mouse_down_element_ == element && mouse_down_button_ == button;
-    mouse_down_element_ = nullptr;
-    mouse_down_button_ = std::nullopt;
-    MouseMove(element);
-
-    if (element) {
-      element->MouseUp(button, point);
-      if (same_as_mouse_down) {
-        element->MouseClick(button, point);
-      }
-    }
-  }
-
-  void MouseMove(Element* element) {
-    if (element) {
-      MouseOver(*element);
-    } else {
-      MouseLeave();
-    }
-  }
-
-  void MouseLeave() {
-    if (mouse_over_element_) {
-      mouse_over_element_->MouseLeave();
-      mouse_over_element_ = nullptr;
-    }
-    for (Element& el : elements_.TopDown()) {
-      el.MouseState(RendererState::Normal);
-    }
-  }
-
- private:
-  void MouseOver(Element& element) {
-    if (mouse_over_element_ != &element) {
-      if (mouse_over_element_) {
-        mouse_over_element_->MouseLeave();
-      }
-      mouse_over_element_ = &element;
-    }
-
-    for (Element& el : elements_.TopDown()) {
-      if (&el == &element) {
-        el.MouseState(&el == mouse_down_element_ ? RendererState::MouseDown
-                                                 : RendererState::MouseOver);
-      } else {
-        el.MouseState(RendererState::Normal);
-      }
-    };
-  }
-
-  const ElementSet& elements_;
-
-  Element* mouse_down_element_ = nullptr;
-  Element* mouse_over_element_ = nullptr;
-  std::optional<MouseButton> mouse_down_button_;
-};
-
-ElementSet elements;
-std::unique_ptr<CaptionElement> caption_el;
-std::unique_ptr<SystemMenuElement> system_menu_el;
-std::unique_ptr<MinimizeElement> minimize_el;
-std::unique_ptr<MaximizeElement> maximize_el;
-std::unique_ptr<CloseElement> close_el;
-
-MouseStateMachine mouse_state_machine{elements};
+// Message trace, written off the UI thread. See trace_ring.hpp for the file format.
+TraceLog trace_log;
 
 void TrackMouseLeave(HWND hwnd, bool non_client) {
   TRACKMOUSEEVENT tme = {sizeof(tme)};
@@ -783,256 +973,489 @@ void TrackMouseLeave(HWND hwnd, bool non_client) {
   THROW_IF_WIN32_BOOL_FALSE(::TrackMouseEvent(&tme));
 }
 
-void MouseLeave() {
-  mouse_state_machine.MouseLeave();
-  mouse_visual.Brush(nullptr);
+// The leave messages are included, MouseLeaveTracker has to see them.
+bool IsClientMouseMessage(uint32_t message) {
+  return (message >= WM_MOUSEFIRST && message <= WM_MOUSELAST) || message == WM_MOUSELEAVE;
 }
 
-void MouseMove(Element* element, const POINT& pt) {
-  mouse_state_machine.MouseMove(element);
-  mouse_visual.Brush(mouse_brush);
-  mouse_visual.Offset({static_cast<float>(pt.x), static_cast<float>(pt.y), 0.0f});
+bool IsNonClientMouseMessage(uint32_t message) {
+  return (message >= WM_NCMOUSEMOVE && message <= WM_NCXBUTTONDBLCLK) ||
+         message == WM_NCMOUSELEAVE;
 }
 
-void MouseDown(Element* element, MouseButton button, const POINT& pt) {
-  mouse_state_machine.MouseDown(element, button, pt);
-  mouse_visual.Brush(mouse_down_brush);
-}
+UIC::SpriteVisual CreateMouseVisual() {
+  auto ellipse = compositor.CreateEllipseGeometry();
+  ellipse.Radius({8, 8});
+  ellipse.Center({8, 8});
 
-void MouseUp(Element* element, MouseButton button, const POINT& pt) {
-  mouse_state_machine.MouseUp(element, button, pt);
-  mouse_visual.Brush(mouse_brush);
+  auto clip = compositor.CreateGeometricClip(ellipse);
+  auto sprite = compositor.CreateSpriteVisual();
+  sprite.AnchorPoint({0.5, 0.5});
+  SetBrush(sprite, mouse_brush);
+  SetSize(sprite, {16, 16});
+  sprite.Clip(clip);
+  return sprite;
 }
 
-void MouseDoubleClick(Element* element, MouseButton button, const POINT& pt) {
-  mouse_state_machine.MouseDoubleClick(element, button, pt);
+// Creates what every window shares the first time a window needs it: the DispatcherQueue the
+// frame scheduler posts to, the Compositor and the mouse brushes. Glyphs and graphics devices
+// are shared through glyph_cache and graphics_device_pool.
+void EnsureCompositor() {
+  if (compositor) {
+    return;
+  }
+
+  DispatcherQueueOptions options{sizeof(DispatcherQueueOptions)};
+  options.apartmentType = DQTAT_COM_ASTA;
+  options.threadType = DQTYPE_THREAD_CURRENT;
+
+  winrt::check_hresult(::CreateDispatcherQueueController(
+      options,
+      reinterpret_cast<ABI::Windows::System::IDispatcherQueueController**>(
+          winrt::put_abi(dispatcher_queue_controller))));
+
+  compositor = UIC::Compositor();
+  mouse_brush = compositor.CreateColorBrush(UI::Colors::DarkRed());
+  mouse_down_brush = compositor.CreateColorBrush(UI::Colors::Yellow());
 }
 
-void LayoutElements(const RECT& rcClient, uint32_t dpi) {
-  int kButtonHeight = MulDiv(47, dpi, 96);
-  int kButtonWidth = MulDiv(44, dpi, 96);
+// Everything one titlebar window owns: its visual tree, elements, layout and mouse state, the
+// parts that do not need Windows in a WindowModel. The Window lives in the HWND's GWLP_USERDATA
+// from WM_CREATE to WM_NCDESTROY, so finding it for a message is a single lookup.
+class Window {
+ public:
+  static Window& Attach(HWND hwnd) {
+    auto window = new Window{hwnd};
+    ::SetWindowLongPtrW(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(window));
+    windows_.push_back(window);
+    return *window;
+  }
 
-  RECT rcTop = rcClient;
-  rcTop.bottom = kButtonHeight;
-  caption_el->Bounds(rcTop);
+  // From WM_NCDESTROY. The close button and the system menu destroy the window from inside a
+  // mouse handler, with this Window's elements and state machine still on the stack. Then the
+  // window is only marked detached here, and the outermost HandleMouseMessage deletes it on its
+  // way out.
+  static void Detach(HWND hwnd) {
+    auto window = FromHwnd(hwnd);
+    ::SetWindowLongPtrW(hwnd, GWLP_USERDATA, 0);
+    if (!window) {
+      return;
+    }
+    windows_.erase(std::find(windows_.begin(), windows_.end(), window));
+    window->detached_ = true;
+    if (window->handler_depth_ == 0) {
+      delete window;
+    }
+  }
 
-  RECT rcIcon = rcTop;
-  rcIcon.right = rcTop.left + kButtonWidth;
-  system_menu_el->Bounds(rcIcon);
+  static Window* FromHwnd(HWND hwnd) {
+    return reinterpret_cast<Window*>(::GetWindowLongPtrW(hwnd, GWLP_USERDATA));
+  }
 
-  RECT rcClose = rcTop;
-  rcClose.left = rcTop.right - kButtonWidth;
-  close_el->Bounds(rcClose);
+  static size_t Count() { return windows_.size(); }
 
-  RECT rcMaxButton = rcTop;
-  rcMaxButton.left = rcClose.left - kButtonWidth;
-  rcMaxButton.right = rcClose.left;
-  maximize_el->Bounds(rcMaxButton);
+  template <typename Callable>
+  static void ForEach(Callable&& callable) {
+    for (auto window : windows_) {
+      callable(*window);
+    }
+  }
 
-  RECT rcMinButton = rcTop;
-  rcMinButton.left = rcMaxButton.left - kButtonWidth;
-  rcMinButton.right = rcMaxButton.left;
-  minimize_el->Bounds(rcMinButton);
+  Window(const Window&) = delete;
+  Window& operator=(const Window&) = delete;
 
-  for (Element& element : elements.BottomUp()) {
-    element.SetDpi(dpi);
+  ~Window() {
+    frame_scheduler.Cancel(&model_);
+    for (Element& element : model_.Elements().BottomUp()) {
+      frame_scheduler.Cancel(&element);
+    }
+    root_.Children().RemoveAll();
+    composition_recorder.ForgetValues();
   }
-}
 
-UIC::SpriteVisual CreateMouseVisual() {
-  auto ellipse = compositor.CreateEllipseGeometry();
-  ellipse.Radius({8, 8});
-  ellipse.Center({8, 8});
+  // Each WM_SIZE only asks for a layout, the layout itself runs with the next frame using
+  // whatever the client rect is by then. The model is the layout's key.
+  void RequestLayout(bool maximized) {
+    frame_scheduler.Request(&model_, [this, maximized]() {
+      RECT rcClient;
+      ::GetClientRect(hwnd_, &rcClient);
+      auto writes = model_.Layout(ToRect(rcClient), dpi_) * kWritesPerBounds;
+      maximize_el_->Maximized(maximized);
+
+      // A guess: assumes each coalesced WM_SIZE would have moved the same elements this one did.
+      layout_writes_ += writes;
+      layout_writes_saved_estimate_ += writes * frame_scheduler.CoalescedCount(&model_);
+    });
+  }
 
-  auto clip = compositor.CreateGeometricClip(ellipse);
-  auto sprite = compositor.CreateSpriteVisual();
-  sprite.AnchorPoint({0.5, 0.5});
-  sprite.Brush(mouse_brush);
-  sprite.Size({16, 16});
-  sprite.Clip(clip);
-  return sprite;
-}
+  uint32_t Dpi() const { return dpi_; }
 
-void CreateRenderers(UIC::ContainerVisual container, HWND hwnd) {
-  caption_el = std::make_unique<CaptionElement>(hwnd, container.Compositor(), UI::Colors::Aqua());
+  void RedrawSurfaces() {
+    for (Element& element : model_.Elements().BottomUp()) {
+      element.RedrawSurfaces();
+    }
+  }
 
-  system_menu_el =
-      std::make_unique<SystemMenuElement>(hwnd, container.Compositor(), UI::Colors::BlueViolet());
+  // From WM_NCDESTROY, next to the process-wide numbers of PrintProcessStats.
+  void PrintStats() const {
+    const auto& mouse = model_.StateMachine().GetStats();
+    std::cout << "Window " << hwnd_ << ":\n";
+    std::cout << "  Mouse: " << mouse.events << " events, " << mouse.state_updates
+              << " renderer state updates\n";
+    const auto& arena = model_.GetArena().GetStats();
+    std::cout << "  Arena: " << arena.objects << " objects in " << arena.bytes << " bytes, "
+              << arena.chunk_allocations << " heap allocations\n";
+    std::cout << "  Layout: " << layout_writes_ << " composition writes, about "
+              << layout_writes_saved_estimate_ << " saved by coalescing WM_SIZE\n";
+    const auto& leave = model_.LeaveTracker().GetStats();
+    std::cout << "  Leave tracking: " << leave.moves << " moves, " << leave.arms
+              << " TrackMouseEvent calls, " << leave.stale_leaves << " stale leaves\n";
+    const auto& menu = model_.MenuApplier().GetStats();
+    std::cout << "  System menu: " << menu.applies << " shown, " << menu.calls
+              << " menu item calls\n";
+  }
 
-  minimize_el = std::make_unique<MinimizeElement>(
-      hwnd,
-      container.Compositor(),
-      RendererColors{
-          UI::Colors::Transparent(), UI::Colors::NavajoWhite(), UI::Colors::LightGray()});
+  void InitMenuPopup(HMENU menu) { system_menu_->InitMenuPopup(menu); }
 
-  maximize_el = std::make_unique<MaximizeElement>(
-      hwnd,
-      container.Compositor(),
-      RendererColors{
-          UI::Colors::Transparent(), UI::Colors::NavajoWhite(), UI::Colors::LightGray()});
+  // From WM_DPICHANGED, before the window is resized for the new DPI.
+  void DpiChanged(uint32_t dpi) { dpi_ = dpi; }
 
-  close_el = std::make_unique<CloseElement>(
-      hwnd,
-      container.Compositor(),
-      RendererColors{UI::Colors::Transparent(), UI::Colors::Red(), UI::Colors::DarkRed()});
+  // The element under `client_point`, if any, for WM_NCHITTEST.
+  Element* FindElement(const POINT& client_point) const {
+    return model_.FindElement(ToPoint(client_point));
+  }
+
+  LRESULT HandleMouseMessage(uint32_t message, WPARAM wparam, LPARAM lparam) {
+    // Nothing of this Window may be used once a handler destroyed the window, see Detach.
+    ++handler_depth_;
+    auto leave_handler = wil::scope_exit([this]() {
+      if (--handler_depth_ == 0 && detached_) {
+        delete this;
+      }
+    });
+
+    // Leave messages carry neither a position nor a hit-test code, and are over no element.
+    POINT point{};
+    HitTestCode hit_test_code = HitTestCode::Client;
+    bool is_nc_message = IsNonClientMouseMessage(message);
+    Element* element = nullptr;
+    if (message != WM_MOUSELEAVE && message != WM_NCMOUSELEAVE) {
+      point = POINT{GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam)};
+      if (is_nc_message) {
+        THROW_IF_WIN32_BOOL_FALSE(::ScreenToClient(hwnd_, &point));
+        hit_test_code = static_cast<HitTestCode>(wparam);
+      }
+      element = model_.FindElement(ToPoint(point));
+    }
 
-  elements = ElementSet{*caption_el, *system_menu_el, *minimize_el, *maximize_el, *close_el};
+    if (auto event = MouseEventFromMessage(message, ToPoint(point))) {
+      bool stale_leave =
+          event->kind == MouseEventKind::Leave && !model_.LeaveTracker().Left(event->non_client);
+      if (!stale_leave) {
+        DispatchMouseEvent(element, *event);
+        if (detached_) {
+          return 0;
+        }
+      }
+      if (event->kind == MouseEventKind::Move) {
+        model_.LeaveTracker().Moved(event->non_client);
+      }
+    }
 
-  for (Element& element : elements.BottomUp()) {
-    if (element.Visual()) {
-      container.Children().InsertAtTop(element.Visual());
+    // The element decides for its own area, its flag starts out as the table's default for its
+    // code. Any other code, like a resize border over the edge of the caption, goes by the table.
+    bool own_area = element && (!is_nc_message || hit_test_code == element->HitTest());
+    bool call_dwp = own_area ? element->CallDefWindowProc()
+                             : !element || GetHitTestCodeInfo(hit_test_code).call_def_window_proc;
+    if (call_dwp) {
+      // Problem: Handle these messages (do NOT call DefWindowProc).
+      //          Default handling for NC messages with the caption button HT codes (like
+      //          MAXBUTTON) have various side effects we do not want (because we're handling the
+      //          input over these areas).
+      //
+      // Notably WM_NCLBUTTONDOWN with HTMAXBUTTON will show an old bitmap of the
+      // 'depressed' maximize button in the default location. See
+      // xxxDCETrackCaptionButton/ xxxTrackCaptionButton.
+      //
+      // Note: We MUST pass HTCAPTION and resize borders to DefWindowProc (or else we'd
+      // break moving and resizing).
+      return ::DefWindowProcW(hwnd_, message, wparam, lparam);
+    } else {
+      return 0;
     }
   }
 
-  mouse_brush = compositor.CreateColorBrush(UI::Colors::DarkRed());
-  mouse_down_brush = compositor.CreateColorBrush(UI::Colors::Yellow());
-  mouse_visual = CreateMouseVisual();
-  container.Children().InsertAtTop(mouse_visual);
-}
+ private:
+  explicit Window(HWND hwnd) : hwnd_{hwnd}, dpi_{::GetDpiForWindow(hwnd)} {
+    auto interop = compositor.as<UIC::abi::Desktop::ICompositorDesktopInterop>();
+    winrt::check_hresult(interop->CreateDesktopWindowTarget(
+        hwnd,
+        FALSE,
+        reinterpret_cast<UIC::abi::Desktop::IDesktopWindowTarget**>(winrt::put_abi(target_))));
+
+    root_ = compositor.CreateContainerVisual();
+    target_.Root(root_);
+    SetBackdrop(target_);
+    CreateElements();
+  }
 
-void LogMessage(bool nc, const char* message, Element* element) {
-  std::cout << (nc ? "NC " : "   ") << message << " element=" << element << '\n';
-}
+  void CreateElements() {
+    auto& arena = model_.GetArena();
+    system_menu_ = &arena.Make<SystemMenu>(hwnd_, model_.MenuApplier());
+
+    caption_el_ =
+        &arena.Make<CaptionElement>(arena, *system_menu_, compositor, UI::Colors::Aqua());
+
+    system_menu_el_ = &arena.Make<SystemMenuElement>(
+        arena, hwnd_, *system_menu_, compositor, UI::Colors::BlueViolet());
+
+    minimize_el_ = &arena.Make<MinimizeElement>(
+        arena,
+        hwnd_,
+        compositor,
+        RendererColors{
+            UI::Colors::Transparent(), UI::Colors::NavajoWhite(), UI::Colors::LightGray()});
+
+    maximize_el_ = &arena.Make<MaximizeElement>(
+        arena,
+        hwnd_,
+        compositor,
+        RendererColors{
+            UI::Colors::Transparent(), UI::Colors::NavajoWhite(), UI::Colors::LightGray()});
+
+    close_el_ = &arena.Make<CloseElement>(
+        arena,
+        hwnd_,
+        compositor,
+        RendererColors{UI::Colors::Transparent(), UI::Colors::Red(), UI::Colors::DarkRed()});
+
+    model_.SetElements({*caption_el_, *system_menu_el_, *minimize_el_, *maximize_el_, *close_el_});
+
+    using Anchor = RowLayout::Anchor;
+    model_.AddToCaptionLayout(*caption_el_, Anchor::Fill);
+    model_.AddToCaptionLayout(*system_menu_el_, Anchor::Left, kCaptionButtonWidth);
+    model_.AddToCaptionLayout(*close_el_, Anchor::Right, kCaptionButtonWidth);
+    model_.AddToCaptionLayout(*maximize_el_, Anchor::Right, kCaptionButtonWidth);
+    model_.AddToCaptionLayout(*minimize_el_, Anchor::Right, kCaptionButtonWidth);
+
+    for (Element& element : model_.Elements().BottomUp()) {
+      if (element.Visual()) {
+        root_.Children().InsertAtTop(element.Visual());
+      }
+    }
 
-bool IsClientMouseMessage(uint32_t message) {
-  return message >= WM_MOUSEFIRST && message <= WM_MOUSELAST;
-}
+    mouse_visual_ = CreateMouseVisual();
+    root_.Children().InsertAtTop(mouse_visual_);
+  }
 
-bool IsNonClientMouseMessage(uint32_t message) {
-  return message >= WM_NCMOUSEMOVE && message <= WM_NCXBUTTONDBLCLK;
-}
+  // The state machine calls into the elements, the mouse visual follows the event here.
+  void DispatchMouseEvent(Element* element, const MouseEvent& event) {
+    model_.StateMachine().Dispatch(element, event);
+    if (detached_) {
+      return;
+    }
+    switch (event.kind) {
+      case MouseEventKind::Move:
+        SetBrush(mouse_visual_, mouse_brush);
+        SetOffset(mouse_visual_,
+                  {static_cast<float>(event.point.x), static_cast<float>(event.point.y), 0.0f});
+        break;
+      case MouseEventKind::Leave:
+        SetBrush(mouse_visual_, nullptr);
+        break;
+      case MouseEventKind::Down:
+        SetBrush(mouse_visual_, mouse_down_brush);
+        break;
+      case MouseEventKind::Up:
+        SetBrush(mouse_visual_, mouse_brush);
+        break;
+      case MouseEventKind::DoubleClick:
+        break;
+    }
+  }
 
-void ConvertToClientMouseMessage(HWND hwnd, uint32_t message, POINT point) {
-  LPARAM lparam = MAKELPARAM(point.x, point.y);
+  static inline std::vector<Window*> windows_;
 
-  WPARAM wparam = 0;
-  WI_SetFlagIf(wparam, MK_CONTROL, ::GetKeyState(VK_CONTROL) != 0);
-  WI_SetFlagIf(wparam, MK_LBUTTON, ::GetKeyState(VK_LBUTTON) != 0);
-  WI_SetFlagIf(wparam, MK_MBUTTON, ::GetKeyState(VK_MBUTTON) != 0);
-  WI_SetFlagIf(wparam, MK_RBUTTON, (::GetKeyState(VK_RBUTTON) | ::GetKeyState(VK_SHIFT)) != 0);
-  WI_SetFlagIf(wparam, MK_XBUTTON1, ::GetKeyState(VK_XBUTTON1) != 0);
-  WI_SetFlagIf(wparam, MK_XBUTTON2, ::GetKeyState(VK_XBUTTON2) != 0);
+  HWND hwnd_;
+  uint32_t dpi_;
+  // Mouse handlers on the stack, and whether the window was destroyed under them.
+  uint32_t handler_depth_ = 0;
+  bool detached_ = false;
+  // Holds the elements, their renderers and the system menu in its arena. Declared before every
+  // member that points into the arena, so that it is destroyed after those.
+  WindowModel<Element> model_{
+      kCaptionHeight,
+      // Applied with the next frame, keyed by element so that a quick over/down/over only draws
+      // the last state.
+      [](Element& element, RendererState state) {
+        frame_scheduler.Request(&element, [&element, state]() { element.MouseState(state); });
+      },
+      [this](bool non_client) { TrackMouseLeave(hwnd_, non_client); },
+      [this](SystemMenuCommand command, bool enabled) {
+        system_menu_->EnableItem(command, enabled);
+      },
+      [this](SystemMenuCommand command) { system_menu_->SetDefaultItem(command); }};
+  SystemMenu* system_menu_ = nullptr;
+
+  UIC::Desktop::DesktopWindowTarget target_{nullptr};
+  UIC::ContainerVisual root_{nullptr};
+  UIC::SpriteVisual mouse_visual_{nullptr};
+
+  CaptionElement* caption_el_ = nullptr;
+  SystemMenuElement* system_menu_el_ = nullptr;
+  MinimizeElement* minimize_el_ = nullptr;
+  MaximizeElement* maximize_el_ = nullptr;
+  CloseElement* close_el_ = nullptr;
+
+  uint64_t layout_writes_ = 0;
+  uint64_t layout_writes_saved_estimate_ = 0;
+};
 
-  constexpr int nc_to_client = (WM_NCMOUSEMOVE - WM_MOUSEMOVE);
-  ::SendMessageW(hwnd, message - nc_to_client, wparam, lparam);
-}
+// Process-wide numbers, printed when the last window goes away.
+void PrintProcessStats() {
+  const auto& stats = composition_recorder.GetStats();
+  std::cout << "Composition: " << stats.Issued() << " writes issued, " << stats.Skipped()
+            << " skipped, over " << stats.frames << " frames, at most "
+            << stats.max_writes_per_frame << " per frame\n";
+  for (size_t i = 0; i < stats.properties.size(); ++i) {
+    std::cout << "  " << CompositionPropertyName(static_cast<CompositionProperty>(i)) << ": "
+              << stats.properties[i].issued << " issued, " << stats.properties[i].skipped
+              << " skipped\n";
+  }
 
-LRESULT HandleMouseMessage(HWND hwnd, uint32_t message, WPARAM wparam, LPARAM lparam) {
-  POINT point{GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam)};
-  bool is_nc_message = IsNonClientMouseMessage(message);
-  HitTestCode hit_test_code = HitTestCode::Client;
+  const auto& glyph_stats = glyph_cache.GetStats();
+  std::cout << "Glyph cache: " << glyph_stats.hits << " hits, " << glyph_stats.misses
+            << " misses, " << glyph_cache.Pages() << " pages, " << glyph_cache.Bytes()
+            << " bytes, " << glyph_cache.Occupancy() * 100 << "% occupied, "
+            << glyph_stats.evicted_pages << " pages evicted\n";
 
-  if (is_nc_message) {
-    THROW_IF_WIN32_BOOL_FALSE(::ScreenToClient(hwnd, &point));
-    hit_test_code = static_cast<HitTestCode>(wparam);
-  }
+  const auto& frames = frame_scheduler.GetStats();
+  std::cout << "Frame scheduler: " << frames.requested << " updates requested, "
+            << frames.coalesced << " coalesced, " << frames.flushes << " flushes\n";
 
-  Element* element = elements.FindAtClientPointTopDown(point);
-  switch (message) {
-    case WM_NCMOUSEMOVE:
-    case WM_MOUSEMOVE:
-      MouseMove(element, point);
-      TrackMouseLeave(hwnd, is_nc_message);
-      break;
+  std::cout << "Trace: " << trace_log.Dropped() << " records dropped\n";
 
-    case WM_NCMOUSELEAVE:
-    case WM_MOUSELEAVE:
-      MouseLeave();
-      break;
+  const auto& settings = environment_settings.GetStats();
+  std::cout << "Environment settings: " << settings.lookups << " lookups, " << settings.fetches
+            << " fetches, " << settings.invalidations << " invalidations\n";
 
-    case WM_NCLBUTTONDOWN:
-    case WM_LBUTTONDOWN:
-      MouseDown(element, MouseButton::Left, point);
-      break;
+  const auto& devices = graphics_device_pool.GetStats();
+  std::cout << "Graphics devices: " << devices.devices_created << " created in "
+            << devices.device_creation_time.count() << " us, " << devices.devices_lost
+            << " lost, " << devices.surfaces_created << " surfaces created in "
+            << devices.surface_creation_time.count() << " us\n";
+}
 
-    case WM_NCLBUTTONUP:
-    case WM_LBUTTONUP:
-      MouseUp(element, MouseButton::Left, point);
-      break;
+// Draws everything that was drawn with a lost device again. The glyph cache goes first, or the
+// renderers would get their blank glyphs back.
+void RedrawSurfaces() {
+  glyph_cache.Clear();
+  Window::ForEach([](Window& window) { window.RedrawSurfaces(); });
+}
 
-    case WM_NCLBUTTONDBLCLK:
-    case WM_LBUTTONDBLCLK:
-      MouseDoubleClick(element, MouseButton::Left, point);
-      break;
+void CreateWebView(HWND hwnd) {
+  THROW_IF_FAILED(::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED));
+  THROW_IF_FAILED(::CreateCoreWebView2Environment(
+      Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
+          [hwnd](HRESULT hr, ICoreWebView2Environment* env) {
+            THROW_IF_FAILED(hr);
+            RETURN_IF_FAILED(env->CreateCoreWebView2Controller(
+                hwnd,
+                Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
+                    [](HRESULT hr, ICoreWebView2Controller* controller) {
+                      THROW_IF_FAILED(hr);
+                      RECT rect{50, 50, 250, 250};
+                      THROW_IF_FAILED(controller->put_Bounds(rect));
+                      controller->put_IsVisible(TRUE);
+                      controller->AddRef();
+                      return S_OK;
+                    })
+                    .Get()));
+            return S_OK;
+          })
+          .Get()));
+}
 
-    case WM_NCRBUTTONDOWN:
-    case WM_RBUTTONDOWN:
-      MouseDown(element, MouseButton::Right, point);
-      break;
+constexpr PCWSTR kWindowClassName = L"WndClass";
 
-    case WM_NCRBUTTONUP:
-    case WM_RBUTTONUP:
-      MouseUp(element, MouseButton::Right, point);
-      break;
+// WM_CHAR sends control characters for Ctrl+letter.
+constexpr WPARAM kCtrlN = 0x0E;
 
-    case WM_NCRBUTTONDBLCLK:
-    case WM_RBUTTONDBLCLK:
-      MouseDoubleClick(element, MouseButton::Right, point);
-      break;
-  }
+LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-  if (IsSizeHitTestCode(hit_test_code) || !element || element->CallDefWindowProc()) {
-    // Problem: Handle these messages (do NOT call DefWindowProc).
-    //          Default handling for NC messages with the caption button HT codes (like MAXBUTTON)
-    //          have various side effects we do not want (because we're handling the input over
-    //          these areas).
-    //
-    // Notably WM_NCLBUTTONDOWN with HTMAXBUTTON will show an old bitmap of the
-    // 'depressed' maximize button in the default location. See
-    // xxxDCETrackCaptionButton/ xxxTrackCaptionButton.
-    //
-    // Note: We MUST pass HTCAPTION and resize borders to DefWindowProc (or else we'd
-    // break moving and resizing).
-    return ::DefWindowProcW(hwnd, message, wparam, lparam);
-  } else {
-    return 0;
-  }
+void RegisterWindowClass(HINSTANCE hInst) {
+  WNDCLASSEX wc = {0};
+  wc.cbSize = sizeof(WNDCLASSEX);
+  wc.style = CS_HREDRAW | CS_VREDRAW;
+  wc.lpfnWndProc = WndProc;
+  wc.hInstance = hInst;
+  wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+  wc.lpszMenuName = NULL;
+  wc.lpszClassName = kWindowClassName;
+
+  THROW_LAST_ERROR_IF(::RegisterClassExW(&wc) == INVALID_ATOM);
+}
+
+void CreateTitlebarWindow(HINSTANCE hInst) {
+  PCWSTR windowTitle = L"BigMaxButton";
+
+  THROW_LAST_ERROR_IF_NULL(::CreateWindowExW(0,
+                                             kWindowClassName,
+                                             windowTitle,
+                                             WS_OVERLAPPEDWINDOW,
+                                             CW_USEDEFAULT,
+                                             CW_USEDEFAULT,
+                                             0,
+                                             0,
+                                             nullptr,
+                                             nullptr,
+                                             hInst,
+                                             nullptr));
 }
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-#define LOG_MESSAGE(message)                                                          \
-  case (message):                                                                     \
-    printf(#message " wParam=%08x lParam=%08x\n", (uint32_t)wParam, (int32_t)lParam); \
+#define TRACE_MESSAGE(message)           \
+  case (message):                        \
+    trace_log.Push(msg, wParam, lParam); \
     break;
 
   switch (msg) {
-    LOG_MESSAGE(WM_SYSCOMMAND);
-    LOG_MESSAGE(WM_CONTEXTMENU);
-    LOG_MESSAGE(WM_ENTERMENULOOP);
-    // LOG_MESSAGE(WM_MOUSEMOVE);
-    LOG_MESSAGE(WM_MOUSELEAVE);
-    LOG_MESSAGE(WM_LBUTTONDOWN);
-    LOG_MESSAGE(WM_LBUTTONUP);
-    LOG_MESSAGE(WM_LBUTTONDBLCLK);
-    LOG_MESSAGE(WM_RBUTTONDOWN);
-    LOG_MESSAGE(WM_RBUTTONUP);
-    LOG_MESSAGE(WM_RBUTTONDBLCLK);
-    LOG_MESSAGE(WM_NCMOUSEMOVE);
-    LOG_MESSAGE(WM_NCMOUSELEAVE);
-    LOG_MESSAGE(WM_NCLBUTTONDOWN);
-    LOG_MESSAGE(WM_NCLBUTTONUP);
-    LOG_MESSAGE(WM_NCLBUTTONDBLCLK);
-    LOG_MESSAGE(WM_NCRBUTTONDOWN);
-    LOG_MESSAGE(WM_NCRBUTTONUP);
-    LOG_MESSAGE(WM_NCRBUTTONDBLCLK);
-  }
-#undef LOG_MESSAGE
+    TRACE_MESSAGE(WM_SYSCOMMAND);
+    TRACE_MESSAGE(WM_CONTEXTMENU);
+    TRACE_MESSAGE(WM_ENTERMENULOOP);
+    // TRACE_MESSAGE(WM_MOUSEMOVE);
+    TRACE_MESSAGE(WM_MOUSELEAVE);
+    TRACE_MESSAGE(WM_LBUTTONDOWN);
+    TRACE_MESSAGE(WM_LBUTTONUP);
+    TRACE_MESSAGE(WM_LBUTTONDBLCLK);
+    TRACE_MESSAGE(WM_RBUTTONDOWN);
+    TRACE_MESSAGE(WM_RBUTTONUP);
+    TRACE_MESSAGE(WM_RBUTTONDBLCLK);
+    TRACE_MESSAGE(WM_NCMOUSEMOVE);
+    TRACE_MESSAGE(WM_NCMOUSELEAVE);
+    TRACE_MESSAGE(WM_NCLBUTTONDOWN);
+    TRACE_MESSAGE(WM_NCLBUTTONUP);
+    TRACE_MESSAGE(WM_NCLBUTTONDBLCLK);
+    TRACE_MESSAGE(WM_NCRBUTTONDOWN);
+    TRACE_MESSAGE(WM_NCRBUTTONUP);
+    TRACE_MESSAGE(WM_NCRBUTTONDBLCLK);
+  }
+#undef TRACE_MESSAGE
+
+  auto window = Window::FromHwnd(hwnd);
 
   switch (msg) {
-    case WM_SIZE: {
-      RECT rcClient;
-      ::GetClientRect(hwnd, &rcClient);
-      const UINT dpi = ::GetDpiForWindow(hwnd);
-      LayoutElements(rcClient, dpi);
-      maximize_el->Maximized(wParam == SIZE_MAXIMIZED);
+    case WM_SIZE:
+      if (window) {
+        window->RequestLayout(wParam == SIZE_MAXIMIZED);
+      }
       break;
-    }
 
     case WM_NCHITTEST: {
       // Get the default HT code and only handle if HTCLIENT.
       UINT ht = (UINT)::DefWindowProcW(hwnd, msg, wParam, lParam);
 
-      if (ht >= HTSIZEFIRST && ht <= HTSIZELAST) {
+      if (IsSizeHitTestCode(static_cast<HitTestCode>(ht))) {
         // This allows the left/right/bottom resize HT codes to flow through.
         return ht;
       }
@@ -1041,13 +1464,15 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
       ::ScreenToClient(hwnd, &ptClient);
 
       // Top resize
-      if (ptClient.y < MulDiv(8, GetDpiForWindow(hwnd), 96)) {
+      auto dpi = window ? window->Dpi() : ::GetDpiForWindow(hwnd);
+      if (ptClient.y < MulDiv(8, dpi, 96)) {
         return HTTOP;
       }
 
-      auto element = elements.FindAtClientPointTopDown(ptClient);
+      auto element = window ? window->FindElement(ptClient) : nullptr;
       if (element) {
-        std::cout << "WM_NCHITTEST element=" << element << " result=" << element->HitTest() << '\n';
+        auto result = static_cast<int32_t>(element->HitTest());
+        trace_log.Push(msg, wParam, lParam, result, ElementSet<Element>::TraceId(element));
         return static_cast<uint32_t>(element->HitTest());
       }
 
@@ -1088,67 +1513,33 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
       break;
 
     case WM_CREATE: {
-      using namespace winrt::Windows::System;
-
-      DispatcherQueueOptions options{sizeof(DispatcherQueueOptions)};
-      options.apartmentType = DQTAT_COM_ASTA;
-      options.threadType = DQTYPE_THREAD_CURRENT;
-
-      DispatcherQueueController controller{nullptr};
-      winrt::check_hresult(::CreateDispatcherQueueController(
-          options,
-          reinterpret_cast<ABI::Windows::System::IDispatcherQueueController**>(
-              winrt::put_abi(controller))));
-
-      compositor = UIC::Compositor();
-      auto interop = compositor.as<UIC::abi::Desktop::ICompositorDesktopInterop>();
-      winrt::check_hresult(interop->CreateDesktopWindowTarget(
-          hwnd,
-          FALSE,
-          reinterpret_cast<UIC::abi::Desktop::IDesktopWindowTarget**>(winrt::put_abi(target))));
-
-      root = compositor.CreateContainerVisual();
-      target.Root(root);
-      SetBackdrop(target);
-      CreateRenderers(root, hwnd);
-
-      THROW_IF_FAILED(::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED));
-      THROW_IF_FAILED(::CreateCoreWebView2Environment(
-          Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
-              [hwnd](HRESULT hr, ICoreWebView2Environment* env) {
-                THROW_IF_FAILED(hr);
-                RETURN_IF_FAILED(env->CreateCoreWebView2Controller(
-                    hwnd,
-                    Microsoft::WRL::Callback<
-                        ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
-                        [](HRESULT hr, ICoreWebView2Controller* controller) {
-                          THROW_IF_FAILED(hr);
-                          RECT rect{50, 50, 250, 250};
-                          THROW_IF_FAILED(controller->put_Bounds(rect));
-                          controller->put_IsVisible(TRUE);
-                          controller->AddRef();
-                          return S_OK;
-                        })
-                        .Get()));
-                return S_OK;
-              })
-              .Get()));
+      EnsureCompositor();
+      Window::Attach(hwnd);
+      CreateWebView(hwnd);
 
+      // Cascade the windows after the first one.
+      auto cascade = static_cast<int>(Window::Count() - 1) * 32;
       UINT dpi = ::GetDpiForWindow(hwnd);
       SIZE sz = {::MulDiv(szInitial.cx, dpi, 96), ::MulDiv(szInitial.cy, dpi, 96)};
-      ::SetWindowPos(hwnd, nullptr, 150, 300, sz.cx, sz.cy, SWP_SHOWWINDOW);
+      ::SetWindowPos(hwnd, nullptr, 150 + cascade, 300 + cascade, sz.cx, sz.cy, SWP_SHOWWINDOW);
       break;
     }
 
-    // Destroy the window on escape key
+    // Destroy the window on escape key, open another one on Ctrl+N
     case WM_CHAR:
       if (wParam == VK_ESCAPE) {
         ::DestroyWindow(hwnd);
+      } else if (wParam == kCtrlN) {
+        auto instance = reinterpret_cast<HINSTANCE>(::GetWindowLongPtrW(hwnd, GWLP_HINSTANCE));
+        CreateTitlebarWindow(instance);
       }
       break;
 
     case WM_DPICHANGED: {
       RECT* prc = (RECT*)lParam;
+      if (window) {
+        window->DpiChanged(LOWORD(wParam));
+      }
 
       ::SetWindowPos(hwnd,
                      nullptr,
@@ -1160,51 +1551,41 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
       break;
     }
 
-    case WM_DESTROY:
-      ::PostQuitMessage(0);
+    case WM_INITMENUPOPUP:
+      if (window) {
+        window->InitMenuPopup(reinterpret_cast<HMENU>(wParam));
+      }
+      break;
+
+    case WM_SETTINGCHANGE:
+      environment_settings.Invalidate();
+      break;
+
+    case WM_NCDESTROY:
+      if (window) {
+        window->PrintStats();
+      }
+      Window::Detach(hwnd);
+      if (Window::Count() == 0) {
+        PrintProcessStats();
+        ::PostQuitMessage(0);
+      }
       break;
   }
 
-  if (IsClientMouseMessage(msg) || IsNonClientMouseMessage(msg)) {
-    return HandleMouseMessage(hwnd, msg, wParam, lParam);
+  if (window && (IsClientMouseMessage(msg) || IsNonClientMouseMessage(msg))) {
+    return window->HandleMouseMessage(msg, wParam, lParam);
   }
 
   return ::DefWindowProcW(hwnd, msg, wParam, lParam);
 }
 
-void InitWindow(HINSTANCE hInst) {
-  PCWSTR wndClassName = L"WndClass";
-  PCWSTR windowTitle = L"BigMaxButton";
-
-  WNDCLASSEX wc = {0};
-  wc.cbSize = sizeof(WNDCLASSEX);
-  wc.style = CS_HREDRAW | CS_VREDRAW;
-  wc.lpfnWndProc = WndProc;
-  wc.hInstance = hInst;
-  wc.hCursor = LoadCursor(NULL, IDC_ARROW);
-  wc.lpszMenuName = NULL;
-  wc.lpszClassName = wndClassName;
-
-  THROW_LAST_ERROR_IF(::RegisterClassExW(&wc) == INVALID_ATOM);
-
-  THROW_LAST_ERROR_IF_NULL(::CreateWindowExW(0,
-                                             wndClassName,
-                                             windowTitle,
-                                             WS_OVERLAPPEDWINDOW,
-                                             CW_USEDEFAULT,
-                                             CW_USEDEFAULT,
-                                             0,
-                                             0,
-                                             nullptr,
-                                             nullptr,
-                                             hInst,
-                                             nullptr));
-}
-
 int __stdcall wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ wchar_t*, _In_ int) {
   ::SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
-  InitWindow(hInstance);
+  trace_log.Start("WindowsProject1.trace");
+  RegisterWindowClass(hInstance);
+  CreateTitlebarWindow(hInstance);
 
   MSG msg;
   while (::GetMessageW(&msg, nullptr, 0, 0)) {
@@ -1212,6 +1593,7 @@ int __stdcall wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ wchar_
     ::DispatchMessageW(&msg);
   }
 
+  trace_log.Stop();
   return 0;
 }
 
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// Easing curves for the transitions the compositor runs. Each maps progress through a
+// transition, 0 to 1, to how far the animated value has got, starting at 0 and ending at 1 but
+// free to overshoot in between. The compositor only interpolates linearly between key frames,
+// so a curve reaches it as the samples SampleKeyFrames takes.
+
+// The CSS cubic-bezier() timing function, with the end points at (0, 0) and (1, 1). x1 and x2
+// must be within [0, 1] so that x grows monotonically with the curve parameter.
+class CubicBezier {
+ public:
+  constexpr CubicBezier(double x1, double y1, double x2, double y2)
+      : cx_{3 * x1},
+        bx_{3 * (x2 - x1) - cx_},
+        ax_{1 - cx_ - bx_},
+        cy_{3 * y1},
+        by_{3 * (y2 - y1) - cy_},
+        ay_{1 - cy_ - by_} {}
+
+  // The Fluent "fast out, slow in" curve, for things that change in response to input.
+  static constexpr CubicBezier FastOutSlowIn() { return {0, 0, 0, 1}; }
+
+  float Evaluate(float progress) const {
+    if (progress <= 0) {
+      return 0;
+    }
+    if (progress >= 1) {
+      return 1;
+    }
+    return static_cast<float>(Y(SolveForParameter(progress)));
+  }
+
+ private:
+  // In x. Where the curve is steep a small error in x is a much larger one in y, so this is well
+  // below what a float can tell apart.
+  static constexpr double kEpsilon = 1e-12;
+
+  double X(double s) const { return ((ax_ * s + bx_) * s + cx_) * s; }
+  double Y(double s) const { return ((ay_ * s + by_) * s + cy_) * s; }
+  double DxDs(double s) const { return (3 * ax_ * s + 2 * bx_) * s + cx_; }
+
+  // The parameter at which x is the given progress. Newton's method converges in a few steps
+  // almost everywhere, bisection covers where the slope is too flat for it.
+  double SolveForParameter(double x) const {
+    double s = x;
+    for (int i = 0; i < 8; ++i) {
+      auto error = X(s) - x;
+      if (std::abs(error) < kEpsilon) {
+        return s;
+      }
+      auto slope = DxDs(s);
+      if (std::abs(slope) < 1e-9) {
+        break;
+      }
+      s -= error / slope;
+    }
+
+    double low = 0;
+    double high = 1;
+    s = x;
+    while (low < high) {
+      auto value = X(s);
+      if (std::abs(value - x) < kEpsilon) {
+        break;
+      }
+      (value < x ? low : high) = s;
+      s = (low + high) / 2;
+      if (high - low < kEpsilon) {
+        break;
+      }
+    }
+    return s;
+  }
+
+  double cx_, bx_, ax_;
+  double cy_, by_, ay_;
+};
+
+// A mass on a spring let go at 0 and pulled to 1, like SpringScalarNaturalMotionAnimation: the
+// period is that of the undamped spring, a damping ratio below 1 overshoots and rings, 1 and
+// above settle without overshooting. The curve lasts until the spring has settled to within
+// kSettleTolerance of 1, which is what Duration gives, and then snaps to 1.
+class Spring {
+ public:
+  static constexpr double kSettleTolerance = 1e-3;
+
+  // damping_ratio must be above 0, an undamped spring never settles.
+  Spring(double damping_ratio, double period_seconds)
+      : damping_ratio_{damping_ratio}, frequency_{2 * kPi / period_seconds} {
+    duration_ = SettleSeconds();
+  }
+
+  double Duration() const { return duration_; }
+
+  float Evaluate(float progress) const {
+    if (progress <= 0) {
+      return 0;
+    }
+    if (progress >= 1) {
+      return 1;
+    }
+    return static_cast<float>(Position(progress * duration_));
+  }
+
+  // Where the mass is after the given time, exactly rather than sampled.
+  double Position(double seconds) const {
+    auto zeta = damping_ratio_;
+    auto omega = frequency_;
+    if (zeta < 1) {
+      auto damped = omega * std::sqrt(1 - zeta * zeta);
+      auto phase = damped * seconds;
+      return 1 - std::exp(-zeta * omega * seconds) *
+                     (std::cos(phase) + zeta * omega / damped * std::sin(phase));
+    }
+    if (zeta == 1) {
+      return 1 - std::exp(-omega * seconds) * (1 + omega * seconds);
+    }
+    auto root = std::sqrt(zeta * zeta - 1);
+    auto r1 = -omega * (zeta - root);
+    auto r2 = -omega * (zeta + root);
+    return 1 - (r2 * std::exp(r1 * seconds) - r1 * std::exp(r2 * seconds)) / (r2 - r1);
+  }
+
+ private:
+  static constexpr double kPi = 3.14159265358979323846;
+
+  double SettleSeconds() const {
+    auto zeta = damping_ratio_;
+    if (zeta < 1) {
+      // The oscillation stays inside an envelope that decays like exp(-zeta * omega * t).
+      auto amplitude = 1 / std::sqrt(1 - zeta * zeta);
+      return std::log(amplitude / kSettleTolerance) / (zeta * frequency_);
+    }
+    // Without overshoot the distance left only shrinks, so bisect for where it gets small enough.
+    double low = 0;
+    double high = 1 / frequency_;
+    while (1 - Position(high) > kSettleTolerance) {
+      low = high;
+      high *= 2;
+    }
+    for (int i = 0; i < 40; ++i) {
+      auto mid = (low + high) / 2;
+      (1 - Position(mid) > kSettleTolerance ? low : high) = mid;
+    }
+    return high;
+  }
+
+  double damping_ratio_;
+  double frequency_;
+  double duration_ = 0;
+};
+
+struct AnimationKeyFrame {
+  float progress;
+  float value;
+};
+
+// Count evenly spaced samples of a curve, from progress 0 to 1, for a key frame animation that
+// eases linearly between them.
+template <size_t Count, typename Curve>
+std::array<AnimationKeyFrame, Count> SampleKeyFrames(const Curve& curve) {
+  static_assert(Count >= 2, "a key frame at each end");
+  std::array<AnimationKeyFrame, Count> frames{};
+  for (size_t i = 0; i < Count; ++i) {
+    auto progress = static_cast<float>(i) / (Count - 1);
+    frames[i] = {progress, curve.Evaluate(progress)};
+  }
+  return frames;
+}
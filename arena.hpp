@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+// Bump allocator for objects that all live and die together, like the renderers and elements of
+// one window. Objects are packed into large chunks instead of each getting its own heap block,
+// and destroyed in reverse order of creation when the arena is reset or goes away.
+class Arena {
+ public:
+  static constexpr size_t kDefaultChunkSize = 16 * 1024;
+
+  struct Stats {
+    size_t objects = 0;
+    size_t bytes = 0;
+    // Heap allocations the arena itself made, the only ones its objects cost.
+    size_t chunk_allocations = 0;
+  };
+
+  explicit Arena(size_t chunk_size = kDefaultChunkSize) : chunk_size_{chunk_size} {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena() {
+    Reset();
+    while (chunks_) {
+      auto next = chunks_->next;
+      std::free(chunks_);
+      chunks_ = next;
+    }
+  }
+
+  template <typename T, typename... Args>
+  T& Make(Args&&... args) {
+    void* memory = Allocate(sizeof(Destructor) + sizeof(T), alignof(T));
+    auto destructor = static_cast<Destructor*>(memory);
+    auto object = new (destructor + 1) T(std::forward<Args>(args)...);
+
+    // Only objects that finished constructing get destroyed, a throwing constructor just leaves
+    // its bytes behind until the next Reset.
+    destructor->destroy = [](void* object) { static_cast<T*>(object)->~T(); };
+    destructor->previous = last_destructor_;
+    last_destructor_ = destructor;
+
+    ++stats_.objects;
+    return *object;
+  }
+
+  // Destroys every object, newest first, and keeps the chunks around for reuse.
+  void Reset() {
+    while (last_destructor_) {
+      auto destructor = last_destructor_;
+      last_destructor_ = destructor->previous;
+      destructor->destroy(destructor + 1);
+    }
+    for (auto chunk = chunks_; chunk; chunk = chunk->next) {
+      chunk->used = 0;
+    }
+    current_ = chunks_;
+    stats_.objects = 0;
+    stats_.bytes = 0;
+  }
+
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  // Sits right in front of every object, aligned so the object after it is too.
+  struct alignas(std::max_align_t) Destructor {
+    void (*destroy)(void*);
+    Destructor* previous;
+  };
+
+  struct alignas(std::max_align_t) Chunk {
+    Chunk* next;
+    size_t size;
+    size_t used;
+
+    uint8_t* Data() { return reinterpret_cast<uint8_t*>(this + 1); }
+  };
+
+  void* Allocate(size_t size, size_t alignment) {
+    static_assert(alignof(Destructor) >= alignof(std::max_align_t));
+    if (alignment > alignof(Destructor)) {
+      throw std::bad_alloc{};
+    }
+    size = (size + alignof(Destructor) - 1) & ~(alignof(Destructor) - 1);
+
+    while (current_ && current_->used + size > current_->size) {
+      current_ = current_->next;
+    }
+    if (!current_) {
+      current_ = NewChunk(size);
+    }
+
+    void* memory = current_->Data() + current_->used;
+    current_->used += size;
+    stats_.bytes += size;
+    return memory;
+  }
+
+  Chunk* NewChunk(size_t min_size) {
+    auto size = min_size > chunk_size_ ? min_size : chunk_size_;
+    auto chunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + size));
+    if (!chunk) {
+      throw std::bad_alloc{};
+    }
+    ++stats_.chunk_allocations;
+
+    // Appended, so that Reset walks chunks in the order they fill up.
+    *chunk = Chunk{nullptr, size, 0};
+    auto tail = &chunks_;
+    while (*tail) {
+      tail = &(*tail)->next;
+    }
+    *tail = chunk;
+    return chunk;
+  }
+
+  size_t chunk_size_;
+  Chunk* chunks_ = nullptr;
+  Chunk* current_ = nullptr;
+  Destructor* last_destructor_ = nullptr;
+  Stats stats_;
+};
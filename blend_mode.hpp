@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// The BlendEffectModes from Windows.UI.Composition.Mica.h, which WindowsProject1.cpp checks these
+// against, so this header does not need the Windows headers.
+enum class BlendMode : uint8_t {
+  Multiply = 0,
+  Screen = 1,
+  Darken = 2,
+  Lighten = 3,
+  Dissolve = 4,
+  ColorBurn = 5,
+  LinearBurn = 6,
+  DarkerColor = 7,
+  LighterColor = 8,
+  ColorDodge = 9,
+  LinearDodge = 10,
+  Overlay = 11,
+  SoftLight = 12,
+  HardLight = 13,
+  VividLight = 14,
+  LinearLight = 15,
+  PinLight = 16,
+  HardMix = 17,
+  Difference = 18,
+  Exclusion = 19,
+  Hue = 20,
+  Saturation = 21,
+  Color = 22,
+  Luminosity = 23,
+  Subtract = 24,
+  Division = 25,
+  Count
+};
+
+constexpr const char* BlendModeName(BlendMode mode) {
+  constexpr const char* kNames[] = {
+      "Multiply", "Screen", "Darken", "Lighten", "Dissolve", "ColorBurn", "LinearBurn",
+      "DarkerColor", "LighterColor", "ColorDodge", "LinearDodge", "Overlay", "SoftLight",
+      "HardLight", "VividLight", "LinearLight", "PinLight", "HardMix", "Difference", "Exclusion",
+      "Hue", "Saturation", "Color", "Luminosity", "Subtract", "Division"};
+  static_assert(std::size(kNames) == static_cast<size_t>(BlendMode::Count), "a name per mode");
+  return mode < BlendMode::Count ? kNames[static_cast<size_t>(mode)] : "?";
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+#include "svg_path.hpp"
+
+// Caption glyphs are SVG paths in a 16x16 viewBox, flattened to polygons at compile time. The path
+// data is kept too, for the tests and benchmarks.
+inline constexpr float kGlyphViewBoxSize = 16.0f;
+inline constexpr size_t kMaxGlyphPoints = 256;
+inline constexpr size_t kMaxGlyphContours = 4;
+
+using GlyphPath = svg::FlattenedPath<kMaxGlyphPoints, kMaxGlyphContours>;
+
+constexpr GlyphPath ParseGlyph(const char* path_data) {
+  return svg::FlattenPath<kMaxGlyphPoints, kMaxGlyphContours>(path_data);
+}
+
+inline constexpr char kMaximizeGlyphData[] =
+    "M4.5 3A1.5 1.5 0 003 4.5v7A1.5 1.5 0 004.5 13h7a1.5 1.5 0 "
+    "001.5-1.5v-7A1.5 1.5 0 0011.5 3h-7zm0 1h7a.5.5 0 01.5.5v7a.5.5 0 01-.5.5h-7a.5.5 0 "
+    "01-.5-.5v-7a.5.5 0 01.5-.5z";
+inline constexpr GlyphPath MaximizeGlyph = ParseGlyph(kMaximizeGlyphData);
+static_assert(MaximizeGlyph.ok, "MaximizeGlyph does not parse");
+
+// Two <path> elements in the original SVG, both filled with the default nonzero rule and not
+// overlapping, so one path with both sets of subpaths draws the same.
+inline constexpr char kRestoreGlyphData[] =
+    "M5.084 4a1.5 1.5 0 011.415-1h3.5a3 3 0 013 3v3.5a1.5 1.5 0 "
+    "01-1 1.415V6a2 2 0 00-2-2H5.084z "
+    "M4.5 5h5A1.5 1.5 0 0111 6.5v5A1.5 1.5 0 "
+    "019.5 13h-5A1.5 1.5 0 013 11.5v-5A1.5 1.5 0 014.5 5zm0 1a.5.5 0 00-.5.5v5a.5.5 0 "
+    "00.5.5h5a.5.5 0 00.5-.5v-5a.5.5 0 00-.5-.5h-5z";
+inline constexpr GlyphPath RestoreGlyph = ParseGlyph(kRestoreGlyphData);
+static_assert(RestoreGlyph.ok, "RestoreGlyph does not parse");
+
+inline constexpr char kMinimizeGlyphData[] =
+    "M3.5 7h9c.28 0 .5.22.5.5s-.22.5-.5.5h-9c-.28 "
+    "0-.5-.22-.5-.5s.22-.5.5-.5z";
+inline constexpr GlyphPath MinimizeGlyph = ParseGlyph(kMinimizeGlyphData);
+static_assert(MinimizeGlyph.ok, "MinimizeGlyph does not parse");
+
+inline constexpr char kCloseGlyphData[] =
+    "M2.589 2.716l.058-.069a.498.498 0 01.637-.058l.069.058L8 "
+    "7.293l4.646-4.647a.5.5 0 01.707.707L8.707 8l4.647 4.646a.5.5 0 01.058.638l-.058.069a.5.5 0 "
+    "01-.638.058l-.069-.058L8 8.707l-4.646 4.647a.5.5 0 01-.707-.707L7.293 8 2.646 3.354a.501.501 "
+    "0 01-.057-.638l.058-.069-.058.069z";
+inline constexpr GlyphPath CloseGlyph = ParseGlyph(kCloseGlyphData);
+static_assert(CloseGlyph.ok, "CloseGlyph does not parse");
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+
+// The composition properties we write, for CompositionRecorder's per-property counts.
+enum class CompositionProperty : uint8_t { Offset, Size, Brush, IsVisible, State, Count };
+
+constexpr const char* CompositionPropertyName(CompositionProperty property) {
+  constexpr const char* kNames[] = {"Offset", "Size", "Brush", "IsVisible", "State"};
+  static_assert(std::size(kNames) == static_cast<size_t>(CompositionProperty::Count),
+                "a name for every property");
+  return property < CompositionProperty::Count ? kNames[static_cast<size_t>(property)] : "?";
+}
+
+// Shadows the last value written to each composition property, so that writes which would set a
+// property to the value it already has can be skipped, and counts both kinds per property and per
+// frame. Objects are identified by address only, so this works the same for real composition
+// objects and for anything standing in for them.
+//
+// The shadow only knows about writes recorded here. A property that is also set some other way
+// must not be recorded, or a later write could be skipped while the object holds another value.
+class CompositionRecorder {
+ public:
+  // Large enough for a float3, the biggest value we write.
+  static constexpr size_t kMaxValueSize = 16;
+
+  struct PropertyStats {
+    uint64_t issued = 0;
+    uint64_t skipped = 0;
+  };
+
+  struct Stats {
+    std::array<PropertyStats, static_cast<size_t>(CompositionProperty::Count)> properties{};
+    uint64_t frames = 0;
+    uint64_t max_writes_per_frame = 0;
+
+    uint64_t Issued() const { return Sum(&PropertyStats::issued); }
+    uint64_t Skipped() const { return Sum(&PropertyStats::skipped); }
+
+   private:
+    uint64_t Sum(uint64_t PropertyStats::*field) const {
+      uint64_t sum = 0;
+      for (const auto& property : properties) {
+        sum += property.*field;
+      }
+      return sum;
+    }
+  };
+
+  // Returns whether the write has to be made, false when the property already has this value.
+  template <typename T>
+  bool Record(const void* object, CompositionProperty property, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "values are compared by their bytes");
+    static_assert(sizeof(T) <= kMaxValueSize, "value does not fit, raise kMaxValueSize");
+
+    // Copied into a zeroed buffer so that the bytes past a small value compare equal. Padding
+    // inside the value is compared too, so T should not have any.
+    Value bytes{};
+    std::memcpy(bytes.data(), &value, sizeof(value));
+
+    auto& stats = stats_.properties[static_cast<size_t>(property)];
+    auto [it, inserted] = last_values_.try_emplace(Key{object, property}, bytes);
+    if (!inserted && it->second == bytes) {
+      ++stats.skipped;
+      return false;
+    }
+    it->second = bytes;
+    ++stats.issued;
+    ++frame_writes_;
+    return true;
+  }
+
+  // Calls `write()` only when Record says the write has to be made.
+  template <typename T, typename WriteFunction>
+  bool Write(const void* object,
+             CompositionProperty property,
+             const T& value,
+             WriteFunction&& write) {
+    if (!Record(object, property, value)) {
+      return false;
+    }
+    write();
+    return true;
+  }
+
+  // Call when objects go away, so that a new object at a recycled address is not taken to hold
+  // the old one's values. The next write to every property is then issued.
+  void ForgetValues() { last_values_.clear(); }
+
+  // Marks the end of a frame, for the per-frame rate of issued writes.
+  void EndFrame() {
+    ++stats_.frames;
+    if (frame_writes_ > stats_.max_writes_per_frame) {
+      stats_.max_writes_per_frame = frame_writes_;
+    }
+    frame_writes_ = 0;
+  }
+
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  struct Key {
+    const void* object;
+    CompositionProperty property;
+
+    bool operator==(const Key& other) const {
+      return object == other.object && property == other.property;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return reinterpret_cast<uintptr_t>(key.object) * 31 + static_cast<size_t>(key.property);
+    }
+  };
+
+  using Value = std::array<uint8_t, kMaxValueSize>;
+
+  std::unordered_map<Key, Value, KeyHash> last_values_;
+  Stats stats_;
+  uint64_t frame_writes_ = 0;
+};
+
+// The recorder key of a composition object for the Set* helpers below, by default its address.
+// Handles that stand for an object, like the WinRT projections, specialize this to the address of
+// the object behind the handle, so that every handle to it shares one shadow.
+template <typename T, typename = void>
+struct CompositionObjectKey {
+  static const void* Get(const T& object) { return &object; }
+};
+
+template <typename T>
+struct CompositionObjectKey<T*> {
+  static const void* Get(T* object) { return object; }
+};
+
+// Every composition property write goes through these, which skip writes of the value a property
+// already has. They take any visual with the WinRT setters, so the tests run them on stand-ins.
+//
+// A WinRT object's key is the interface pointer of the handle it was written through, so each
+// property is always written through the same interface: Visual for the ones every visual has,
+// SpriteVisual for Brush.
+template <typename Visual, typename Float3>
+void SetOffset(CompositionRecorder& recorder, const Visual& visual, const Float3& offset) {
+  recorder.Write(CompositionObjectKey<Visual>::Get(visual), CompositionProperty::Offset, offset,
+                 [&]() { visual.Offset(offset); });
+}
+
+template <typename Visual, typename Float2>
+void SetSize(CompositionRecorder& recorder, const Visual& visual, const Float2& size) {
+  recorder.Write(CompositionObjectKey<Visual>::Get(visual), CompositionProperty::Size, size,
+                 [&]() { visual.Size(size); });
+}
+
+template <typename Visual>
+void SetIsVisible(CompositionRecorder& recorder, const Visual& visual, bool visible) {
+  recorder.Write(CompositionObjectKey<Visual>::Get(visual), CompositionProperty::IsVisible,
+                 visible, [&]() { visual.IsVisible(visible); });
+}
+
+// Brushes are compared by object, a null brush included.
+template <typename SpriteVisual, typename Brush>
+void SetBrush(CompositionRecorder& recorder, const SpriteVisual& visual, const Brush& brush) {
+  const void* brush_key = CompositionObjectKey<Brush>::Get(brush);
+  recorder.Write(CompositionObjectKey<SpriteVisual>::Get(visual), CompositionProperty::Brush,
+                 brush_key, [&]() { visual.Brush(brush); });
+}
+
+// A "State" scalar that a renderer's expressions read. Not for one that is also animated, like
+// BackgroundRenderer's, see CompositionRecorder.
+template <typename PropertySet>
+void SetStateProperty(CompositionRecorder& recorder, const PropertySet& properties, float state) {
+  recorder.Write(CompositionObjectKey<PropertySet>::Get(properties), CompositionProperty::State,
+                 state, [&]() { properties.InsertScalar(L"State", state); });
+}
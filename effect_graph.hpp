@@ -0,0 +1,594 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "blend_mode.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EFFECT_GRAPH_SSE2 1
+#endif
+
+namespace effect_graph {
+
+// A premultiplied pixel with 0 to 1 channels, in the B8G8R8A8 memory order.
+struct Pixel {
+  float b, g, r, a;
+};
+
+// Straight (not premultiplied) color.
+struct Rgb {
+  float r, g, b;
+};
+
+inline float Clamp01(float value) {
+  return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+// The separable blend functions, channel by channel on straight colors. `cb` is the background
+// (destination), `cs` the foreground (source), as in the W3C compositing spec that D2D follows.
+inline float ColorBurn(float cb, float cs) {
+  if (cb >= 1.0f) {
+    return 1.0f;
+  }
+  return cs <= 0.0f ? 0.0f : 1.0f - std::min(1.0f, (1.0f - cb) / cs);
+}
+
+inline float ColorDodge(float cb, float cs) {
+  if (cb <= 0.0f) {
+    return 0.0f;
+  }
+  return cs >= 1.0f ? 1.0f : std::min(1.0f, cb / (1.0f - cs));
+}
+
+inline float HardLight(float cb, float cs) {
+  if (cs <= 0.5f) {
+    return cb * 2.0f * cs;
+  }
+  float screen = 2.0f * cs - 1.0f;
+  return cb + screen - cb * screen;
+}
+
+inline float SoftLight(float cb, float cs) {
+  if (cs <= 0.5f) {
+    return cb - (1.0f - 2.0f * cs) * cb * (1.0f - cb);
+  }
+  float d = cb <= 0.25f ? ((16.0f * cb - 12.0f) * cb + 4.0f) * cb : std::sqrt(cb);
+  return cb + (2.0f * cs - 1.0f) * (d - cb);
+}
+
+inline float BlendChannel(BlendMode mode, float cb, float cs) {
+  switch (mode) {
+    case BlendMode::Multiply:
+      return cb * cs;
+    case BlendMode::Screen:
+      return cb + cs - cb * cs;
+    case BlendMode::Darken:
+      return std::min(cb, cs);
+    case BlendMode::Lighten:
+      return std::max(cb, cs);
+    case BlendMode::ColorBurn:
+      return ColorBurn(cb, cs);
+    case BlendMode::LinearBurn:
+      return std::max(cb + cs - 1.0f, 0.0f);
+    case BlendMode::ColorDodge:
+      return ColorDodge(cb, cs);
+    case BlendMode::LinearDodge:
+      return std::min(cb + cs, 1.0f);
+    case BlendMode::Overlay:
+      return HardLight(cs, cb);
+    case BlendMode::SoftLight:
+      return SoftLight(cb, cs);
+    case BlendMode::HardLight:
+      return HardLight(cb, cs);
+    case BlendMode::VividLight:
+      return cs <= 0.5f ? ColorBurn(cb, 2.0f * cs) : ColorDodge(cb, 2.0f * cs - 1.0f);
+    case BlendMode::LinearLight:
+      return Clamp01(cb + 2.0f * cs - 1.0f);
+    case BlendMode::PinLight:
+      return cs <= 0.5f ? std::min(cb, 2.0f * cs) : std::max(cb, 2.0f * cs - 1.0f);
+    case BlendMode::HardMix:
+      return cb + cs >= 1.0f ? 1.0f : 0.0f;
+    case BlendMode::Difference:
+      return std::fabs(cb - cs);
+    case BlendMode::Exclusion:
+      return cb + cs - 2.0f * cb * cs;
+    case BlendMode::Subtract:
+      return std::max(cb - cs, 0.0f);
+    case BlendMode::Division:
+      if (cs <= 0.0f) {
+        return cb <= 0.0f ? 0.0f : 1.0f;
+      }
+      return std::min(cb / cs, 1.0f);
+    default:
+      return cs;
+  }
+}
+
+// The non-separable helpers from the W3C spec, on straight colors.
+inline float Lum(const Rgb& c) {
+  return 0.3f * c.r + 0.59f * c.g + 0.11f * c.b;
+}
+
+inline Rgb ClipColor(Rgb c) {
+  float l = Lum(c);
+  float n = std::min({c.r, c.g, c.b});
+  float x = std::max({c.r, c.g, c.b});
+  auto clip = [&](float& v) {
+    if (n < 0.0f) {
+      v = l + (v - l) * l / (l - n);
+    }
+    if (x > 1.0f) {
+      v = l + (v - l) * (1.0f - l) / (x - l);
+    }
+  };
+  clip(c.r);
+  clip(c.g);
+  clip(c.b);
+  return c;
+}
+
+inline Rgb SetLum(const Rgb& c, float l) {
+  float d = l - Lum(c);
+  return ClipColor(Rgb{c.r + d, c.g + d, c.b + d});
+}
+
+inline float Sat(const Rgb& c) {
+  return std::max({c.r, c.g, c.b}) - std::min({c.r, c.g, c.b});
+}
+
+inline Rgb SetSat(Rgb c, float s) {
+  float* channels[] = {&c.r, &c.g, &c.b};
+  std::sort(std::begin(channels), std::end(channels), [](float* a, float* b) { return *a < *b; });
+  float& min = *channels[0];
+  float& mid = *channels[1];
+  float& max = *channels[2];
+  if (max > min) {
+    mid = (mid - min) * s / (max - min);
+    max = s;
+  } else {
+    mid = max = 0.0f;
+  }
+  min = 0.0f;
+  return c;
+}
+
+inline Rgb BlendColor(BlendMode mode, const Rgb& cb, const Rgb& cs) {
+  switch (mode) {
+    case BlendMode::DarkerColor:
+      return Lum(cs) < Lum(cb) ? cs : cb;
+    case BlendMode::LighterColor:
+      return Lum(cs) > Lum(cb) ? cs : cb;
+    case BlendMode::Hue:
+      return SetLum(SetSat(cs, Sat(cb)), Lum(cb));
+    case BlendMode::Saturation:
+      return SetLum(SetSat(cb, Sat(cs)), Lum(cb));
+    case BlendMode::Color:
+      return SetLum(cs, Lum(cb));
+    case BlendMode::Luminosity:
+      return SetLum(cb, Lum(cs));
+    default:
+      return Rgb{BlendChannel(mode, cb.r, cs.r),
+                 BlendChannel(mode, cb.g, cs.g),
+                 BlendChannel(mode, cb.b, cs.b)};
+  }
+}
+
+// Cheap integer hash of a pixel position, the noise Dissolve thresholds the foreground alpha
+// against. D2D uses its own noise, so dissolved pixels match it in density, not position.
+inline float DissolveNoise(uint32_t x, uint32_t y) {
+  uint32_t h = x * 0x8da6b343u ^ y * 0xd8163841u;
+  h ^= h >> 15;
+  h *= 0x2c1b3c6du;
+  h ^= h >> 12;
+  return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Source-over of the foreground with its colors replaced by the blend result where both overlap.
+inline Pixel BlendPixel(BlendMode mode, const Pixel& b, const Pixel& s) {
+  Rgb cb{};
+  if (b.a > 0.0f) {
+    cb = Rgb{b.r / b.a, b.g / b.a, b.b / b.a};
+  }
+  Rgb cs{};
+  if (s.a > 0.0f) {
+    cs = Rgb{s.r / s.a, s.g / s.a, s.b / s.a};
+  }
+  auto mixed = BlendColor(mode, cb, cs);
+
+  float both = s.a * b.a;
+  float only_b = 1.0f - s.a;
+  float only_s = 1.0f - b.a;
+  return Pixel{only_b * b.b + only_s * s.b + both * mixed.b,
+               only_b * b.g + only_s * s.g + both * mixed.g,
+               only_b * b.r + only_s * s.r + both * mixed.r,
+               s.a + b.a - both};
+}
+
+inline void BlendRowScalar(BlendMode mode,
+                           const Pixel* background,
+                           const Pixel* foreground,
+                           Pixel* out,
+                           size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = BlendPixel(mode, background[i], foreground[i]);
+  }
+}
+
+#if defined(EFFECT_GRAPH_SSE2)
+
+// One pixel per register. Only the separable modes made of plain arithmetic are here, the rest
+// branch per channel and stay scalar. Returns how many pixels were blended.
+inline size_t BlendRowSse2(BlendMode mode,
+                           const Pixel* background,
+                           const Pixel* foreground,
+                           Pixel* out,
+                           size_t count) {
+  switch (mode) {
+    case BlendMode::Multiply:
+    case BlendMode::Screen:
+    case BlendMode::Darken:
+    case BlendMode::Lighten:
+    case BlendMode::LinearBurn:
+    case BlendMode::LinearDodge:
+    case BlendMode::Difference:
+    case BlendMode::Exclusion:
+    case BlendMode::Subtract:
+      break;
+    default:
+      return 0;
+  }
+
+  static_assert(sizeof(Pixel) == sizeof(__m128), "a Pixel is loaded as one register");
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 sign_mask = _mm_set1_ps(-0.0f);
+  const __m128 color_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+  for (size_t i = 0; i < count; ++i) {
+    __m128 b = _mm_loadu_ps(&background[i].b);
+    __m128 s = _mm_loadu_ps(&foreground[i].b);
+    __m128 ab = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128 as = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+
+    // Unpremultiply, the mask turns the 0/0 of transparent pixels into 0.
+    __m128 cb = _mm_and_ps(_mm_div_ps(b, ab), _mm_cmpgt_ps(ab, zero));
+    __m128 cs = _mm_and_ps(_mm_div_ps(s, as), _mm_cmpgt_ps(as, zero));
+
+    __m128 mixed;
+    switch (mode) {
+      case BlendMode::Multiply:
+        mixed = _mm_mul_ps(cb, cs);
+        break;
+      case BlendMode::Screen:
+        mixed = _mm_sub_ps(_mm_add_ps(cb, cs), _mm_mul_ps(cb, cs));
+        break;
+      case BlendMode::Darken:
+        mixed = _mm_min_ps(cb, cs);
+        break;
+      case BlendMode::Lighten:
+        mixed = _mm_max_ps(cb, cs);
+        break;
+      case BlendMode::LinearBurn:
+        mixed = _mm_max_ps(_mm_sub_ps(_mm_add_ps(cb, cs), one), zero);
+        break;
+      case BlendMode::LinearDodge:
+        mixed = _mm_min_ps(_mm_add_ps(cb, cs), one);
+        break;
+      case BlendMode::Difference:
+        mixed = _mm_andnot_ps(sign_mask, _mm_sub_ps(cb, cs));
+        break;
+      case BlendMode::Exclusion: {
+        __m128 product = _mm_mul_ps(cb, cs);
+        mixed = _mm_sub_ps(_mm_add_ps(cb, cs), _mm_add_ps(product, product));
+        break;
+      }
+      default:
+        mixed = _mm_max_ps(_mm_sub_ps(cb, cs), zero);
+        break;
+    }
+
+    __m128 both = _mm_mul_ps(as, ab);
+    __m128 color = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, as), b), _mm_mul_ps(_mm_sub_ps(one, ab), s)),
+        _mm_mul_ps(both, mixed));
+    __m128 alpha = _mm_sub_ps(_mm_add_ps(as, ab), both);
+    _mm_storeu_ps(&out[i].b,
+                  _mm_or_ps(_mm_and_ps(color_mask, color), _mm_andnot_ps(color_mask, alpha)));
+  }
+  return count;
+}
+
+#endif
+
+inline void BlendRow(BlendMode mode,
+                     const Pixel* background,
+                     const Pixel* foreground,
+                     Pixel* out,
+                     size_t count) {
+  size_t done = 0;
+#if defined(EFFECT_GRAPH_SSE2)
+  done = BlendRowSse2(mode, background, foreground, out, count);
+#endif
+  BlendRowScalar(mode, background + done, foreground + done, out + done, count - done);
+}
+
+}  // namespace effect_graph
+
+// Evaluates the effects of Windows.UI.Composition.Mica.h (BlendEffect, ColorSourceEffect,
+// OpacityEffect) on the CPU, over premultiplied B8G8R8A8 images. It is a reference to check what
+// the compositor draws against, in floats.
+//
+// Nodes can only refer to nodes added before them, so the graph cannot have cycles. Constant
+// subgraphs are folded as they are added: opacity over a color source is just another color, and
+// so is a blend of two colors. Evaluation then goes one output row at a time through the whole
+// graph, with a row of scratch per level, so every node's pixels stay in cache between nodes
+// instead of each node making its own pass over a full-size buffer. Nodes the output does not
+// reach are never evaluated, and a node it reaches along more than one path is evaluated once per
+// row and copied to the others.
+class EffectGraph {
+ public:
+  using NodeId = uint32_t;
+
+  struct Stats {
+    size_t nodes = 0;
+    size_t folded = 0;
+  };
+
+  const Stats& GetStats() const { return stats_; }
+
+  // `pixels` must outlive the graph, rows are `stride` bytes apart. Outside of `width` by
+  // `height` the image is transparent.
+  NodeId Image(const uint8_t* pixels, int32_t width, int32_t height, size_t stride) {
+    Node node{Kind::Image};
+    node.pixels = pixels;
+    node.width = width;
+    node.height = height;
+    node.stride = stride;
+    return Add(node);
+  }
+
+  // A straight color, like ColorSourceEffect's Color.
+  NodeId ColorSource(uint8_t b, uint8_t g, uint8_t r, uint8_t a) {
+    float alpha = a / 255.0f;
+    return AddColor({b / 255.0f * alpha, g / 255.0f * alpha, r / 255.0f * alpha, alpha});
+  }
+
+  NodeId Opacity(NodeId source, float opacity) {
+    opacity = effect_graph::Clamp01(opacity);
+    const auto& input = nodes_.at(source);
+    if (opacity == 1.0f) {
+      ++stats_.folded;
+      return source;
+    }
+    if (input.kind == Kind::ColorSource) {
+      ++stats_.folded;
+      return AddColor(Scale(input.color, opacity));
+    }
+    if (input.kind == Kind::Opacity) {
+      ++stats_.folded;
+      return Opacity(input.first, input.opacity * opacity);
+    }
+
+    Node node{Kind::Opacity, source};
+    node.opacity = opacity;
+    return Add(node);
+  }
+
+  NodeId Blend(BlendMode mode, NodeId background, NodeId foreground) {
+    const auto& b = nodes_.at(background);
+    const auto& s = nodes_.at(foreground);
+    // Dissolve depends on the pixel position, so it is not constant even over two colors.
+    if (b.kind == Kind::ColorSource && s.kind == Kind::ColorSource && mode != BlendMode::Dissolve) {
+      ++stats_.folded;
+      return AddColor(effect_graph::BlendPixel(mode, b.color, s.color));
+    }
+
+    Node node{Kind::Blend, background, foreground};
+    node.mode = mode;
+    return Add(node);
+  }
+
+  // Writes `width` by `height` premultiplied B8G8R8A8 pixels, `stride` bytes per row.
+  void Evaluate(NodeId output,
+                int32_t width,
+                int32_t height,
+                uint8_t* pixels,
+                size_t stride) const {
+    Buffer rows(static_cast<size_t>(Depth(output)) * width);
+    auto cache = MakeRowCache(output, width);
+    for (int32_t y = 0; y < height; ++y) {
+      EvaluateRow(output, y, width, rows.data(), cache);
+
+      uint8_t* row = pixels + y * stride;
+      const auto* in = rows.data();
+      for (int32_t x = 0; x < width; ++x) {
+        row[4 * x + 0] = ToByte(in[x].b);
+        row[4 * x + 1] = ToByte(in[x].g);
+        row[4 * x + 2] = ToByte(in[x].r);
+        row[4 * x + 3] = ToByte(in[x].a);
+      }
+    }
+  }
+
+ private:
+  enum class Kind : uint8_t { Image, ColorSource, Opacity, Blend };
+
+  struct Node {
+    Kind kind;
+    NodeId first = 0;
+    NodeId second = 0;
+    BlendMode mode = BlendMode::Multiply;
+    float opacity = 1.0f;
+    const uint8_t* pixels = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    size_t stride = 0;
+    effect_graph::Pixel color{};
+  };
+
+  using Buffer = std::vector<effect_graph::Pixel>;
+
+  // The last row of every node with more than one user.
+  struct RowCache {
+    // Per node, the index of its row in `rows`, or -1 for a node that is not shared.
+    std::vector<int32_t> slots;
+    // Per row in `rows`, the y it holds, or -1 before the first.
+    std::vector<int32_t> ys;
+    Buffer rows;
+  };
+
+  NodeId Add(const Node& node) {
+    nodes_.push_back(node);
+    ++stats_.nodes;
+    return static_cast<NodeId>(nodes_.size() - 1);
+  }
+
+  NodeId AddColor(const effect_graph::Pixel& color) {
+    Node node{Kind::ColorSource};
+    node.color = color;
+    return Add(node);
+  }
+
+  static effect_graph::Pixel Scale(const effect_graph::Pixel& p, float factor) {
+    return {p.b * factor, p.g * factor, p.r * factor, p.a * factor};
+  }
+
+  static uint8_t ToByte(float value) {
+    return static_cast<uint8_t>(std::lround(effect_graph::Clamp01(value) * 255.0f));
+  }
+
+  // Rows of scratch EvaluateRow needs for `id`, its own output row included. A blend keeps its
+  // background row while the foreground is evaluated into the rows after it.
+  size_t Depth(NodeId id) const {
+    const auto& node = nodes_.at(id);
+    switch (node.kind) {
+      case Kind::Opacity:
+        return Depth(node.first);
+      case Kind::Blend:
+        return std::max(Depth(node.first), 1 + Depth(node.second));
+      default:
+        return 1;
+    }
+  }
+
+  // Counts the users of every node `id` reaches, the output itself counts as one.
+  void CountUses(NodeId id, std::vector<uint32_t>& uses) const {
+    if (uses[id]++ > 0) {
+      return;
+    }
+    const auto& node = nodes_[id];
+    if (node.kind == Kind::Opacity || node.kind == Kind::Blend) {
+      CountUses(node.first, uses);
+    }
+    if (node.kind == Kind::Blend) {
+      CountUses(node.second, uses);
+    }
+  }
+
+  // A color costs no more to fill than to copy, so only other shared nodes get a row.
+  RowCache MakeRowCache(NodeId output, int32_t width) const {
+    std::vector<uint32_t> uses(nodes_.size());
+    CountUses(output, uses);
+
+    RowCache cache;
+    cache.slots.assign(nodes_.size(), -1);
+    for (size_t id = 0; id < nodes_.size(); ++id) {
+      if (uses[id] > 1 && nodes_[id].kind != Kind::ColorSource) {
+        cache.slots[id] = static_cast<int32_t>(cache.ys.size());
+        cache.ys.push_back(-1);
+      }
+    }
+    cache.rows.resize(cache.ys.size() * static_cast<size_t>(width));
+    return cache;
+  }
+
+  // Evaluates row `y` of `id` into `out`, using the rows after it as scratch.
+  void EvaluateRow(NodeId id,
+                   int32_t y,
+                   int32_t width,
+                   effect_graph::Pixel* out,
+                   RowCache& cache) const {
+    auto slot = cache.slots[id];
+    if (slot < 0) {
+      EvaluateNodeRow(id, y, width, out, cache);
+      return;
+    }
+    auto count = static_cast<size_t>(width);
+    auto* cached = cache.rows.data() + static_cast<size_t>(slot) * count;
+    if (cache.ys[slot] == y) {
+      std::copy_n(cached, count, out);
+      return;
+    }
+    EvaluateNodeRow(id, y, width, out, cache);
+    std::copy_n(out, count, cached);
+    cache.ys[slot] = y;
+  }
+
+  void EvaluateNodeRow(NodeId id,
+                       int32_t y,
+                       int32_t width,
+                       effect_graph::Pixel* out,
+                       RowCache& cache) const {
+    const auto& node = nodes_.at(id);
+    auto count = static_cast<size_t>(width);
+
+    switch (node.kind) {
+      case Kind::Image: {
+        std::fill_n(out, count, effect_graph::Pixel{});
+        if (y < node.height) {
+          const uint8_t* row = node.pixels + y * node.stride;
+          for (int32_t x = 0; x < std::min(width, node.width); ++x) {
+            const uint8_t* p = row + 4 * x;
+            out[x] = {p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f};
+          }
+        }
+        return;
+      }
+
+      case Kind::ColorSource:
+        std::fill_n(out, count, node.color);
+        return;
+
+      case Kind::Opacity:
+        EvaluateRow(node.first, y, width, out, cache);
+        for (size_t x = 0; x < count; ++x) {
+          out[x] = Scale(out[x], node.opacity);
+        }
+        return;
+
+      case Kind::Blend:
+        break;
+    }
+
+    auto* foreground = out + count;
+    EvaluateRow(node.first, y, width, out, cache);
+    EvaluateRow(node.second, y, width, foreground, cache);
+    if (node.mode == BlendMode::Dissolve) {
+      DissolveRow(out, foreground, y, width);
+    } else {
+      effect_graph::BlendRow(node.mode, out, foreground, out, count);
+    }
+  }
+
+  // Each foreground pixel is either drawn opaque over the background or left out entirely,
+  // with its alpha as the chance of being drawn.
+  static void DissolveRow(effect_graph::Pixel* background,
+                          const effect_graph::Pixel* foreground,
+                          int32_t y,
+                          int32_t width) {
+    for (int32_t x = 0; x < width; ++x) {
+      const auto& s = foreground[x];
+      if (s.a > 0.0f && effect_graph::DissolveNoise(x, y) < s.a) {
+        background[x] = {s.b / s.a, s.g / s.a, s.r / s.a, 1.0f};
+      }
+    }
+  }
+
+  std::vector<Node> nodes_;
+  Stats stats_;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "geometry.hpp"
+#include "hit_test_index.hpp"
+
+// Base for the elements of an ElementSet. Holds the element's bounds and, while the element is
+// in a set, its slot in the set's HitTestIndex, so that moving the element updates the index.
+class ElementSetMember {
+ public:
+  const Rect& Bounds() const { return bounds_; }
+
+ protected:
+  // Returns false when the element already has these bounds.
+  bool SetBounds(const Rect& bounds) {
+    if (bounds == bounds_) {
+      return false;
+    }
+    bounds_ = bounds;
+    if (hit_test_index_) {
+      hit_test_index_->Update(hit_test_slot_, bounds_);
+    }
+    return true;
+  }
+
+ private:
+  template <typename>
+  friend class ElementSet;
+
+  Rect bounds_{};
+  HitTestIndex* hit_test_index_ = nullptr;
+  HitTestIndex::Slot hit_test_slot_ = 0;
+};
+
+template <typename It>
+class Range {
+ public:
+  Range(It begin, It end) : begin_{begin}, end_{end} {}
+
+  It begin() const { return begin_; }
+  It end() const { return end_; }
+
+ private:
+  It begin_;
+  It end_;
+};
+
+// The elements of one window in z-order, bottom first. ElementT derives from ElementSetMember.
+template <typename ElementT>
+class ElementSet {
+ private:
+  using ElementRef = std::reference_wrapper<ElementT>;
+  using ElementRefVector = std::vector<ElementRef>;
+
+ public:
+  ElementSet() {}
+  ElementSet(std::initializer_list<ElementRef> elements) { Reset(elements); }
+  ElementSet(const ElementSet&) = delete;
+  ElementSet& operator=(const ElementSet&) = delete;
+
+  void Reset(std::initializer_list<ElementRef> elements) {
+    for (ElementSetMember& el : BottomUp()) {
+      el.hit_test_index_ = nullptr;
+    }
+
+    elements_ = elements;
+    hit_test_index_.Clear();
+
+    for (ElementSetMember& el : BottomUp()) {
+      el.hit_test_index_ = &hit_test_index_;
+      el.hit_test_slot_ = hit_test_index_.Add(el.Bounds());
+    }
+  }
+
+  auto BottomUp() const { return Range{elements_.begin(), elements_.end()}; }
+
+  auto TopDown() const { return Range{elements_.rbegin(), elements_.rend()}; }
+
+  // Stable for as long as the set is not reset, 0 means no element.
+  static uint32_t TraceId(const ElementT* element) {
+    return element ? static_cast<const ElementSetMember*>(element)->hit_test_slot_ + 1 : 0;
+  }
+
+  ElementT* FindAtClientPointTopDown(const Point& pt) const {
+    auto slot = hit_test_index_.FindTopmost(pt);
+    return slot ? &elements_[*slot].get() : nullptr;
+  }
+
+ private:
+  ElementRefVector elements_;
+  HitTestIndex hit_test_index_;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+// Process-wide settings that are costly to look up and only change when Windows broadcasts
+// WM_SETTINGCHANGE. Each one is fetched the first time it is needed and kept until Invalidate.
+//
+// The fetch callbacks do the actual lookups, so the cache itself does not need <windows.h>.
+class EnvironmentSettings {
+ public:
+  using Fetch = std::function<bool()>;
+
+  struct Stats {
+    uint64_t lookups = 0;
+    uint64_t fetches = 0;
+    uint64_t invalidations = 0;
+  };
+
+  EnvironmentSettings(Fetch is_rtl, Fetch menu_drop_right_aligned)
+      : rtl_{std::move(is_rtl)}, menu_drop_right_aligned_{std::move(menu_drop_right_aligned)} {}
+
+  EnvironmentSettings(const EnvironmentSettings&) = delete;
+  EnvironmentSettings& operator=(const EnvironmentSettings&) = delete;
+
+  const Stats& GetStats() const { return stats_; }
+
+  // Whether the user's UI language reads right to left.
+  bool IsRtl() { return Get(rtl_); }
+
+  // Whether menus drop down aligned to the right of their anchor, SM_MENUDROPALIGNMENT.
+  bool MenuDropRightAligned() { return Get(menu_drop_right_aligned_); }
+
+  // Every window gets the broadcast, so this runs a few times in a row. Only the first call
+  // after a lookup has anything to drop.
+  void Invalidate() {
+    ++stats_.invalidations;
+    rtl_.value.reset();
+    menu_drop_right_aligned_.value.reset();
+  }
+
+ private:
+  struct Setting {
+    explicit Setting(Fetch fetch) : fetch{std::move(fetch)} {}
+
+    Fetch fetch;
+    std::optional<bool> value;
+  };
+
+  bool Get(Setting& setting) {
+    ++stats_.lookups;
+    if (!setting.value) {
+      setting.value = setting.fetch();
+      ++stats_.fetches;
+    }
+    return *setting.value;
+  }
+
+  Setting rtl_;
+  Setting menu_drop_right_aligned_;
+  Stats stats_;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Collects updates requested between two ticks of a queue and runs them together once per tick.
+// Requests that share a key replace each other, so a storm of WM_SIZE only lays out once with the
+// latest size.
+//
+// The scheduler does not know what a tick is: `post` is handed the flush callback whenever the
+// first update of a frame comes in. On the UI thread that is the DispatcherQueue, anything else
+// that eventually calls back (a timer, a test loop) works the same. `post` returns false when the
+// callback will never run, the queue is shutting down, and the next request posts again.
+class FrameScheduler {
+ public:
+  using Key = const void*;
+  using Update = std::function<void()>;
+  using Post = std::function<bool(std::function<void()>)>;
+
+  struct Stats {
+    uint64_t requested = 0;
+    uint64_t coalesced = 0;
+    uint64_t flushes = 0;
+  };
+
+  explicit FrameScheduler(Post post) : post_{std::move(post)} {}
+
+  FrameScheduler(const FrameScheduler&) = delete;
+  FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+  bool Pending() const { return posted_; }
+  const Stats& GetStats() const { return stats_; }
+
+  void Request(Key key, Update update) {
+    ++stats_.requested;
+    for (auto& pending : pending_) {
+      if (pending.key == key) {
+        ++pending.coalesced;
+        ++stats_.coalesced;
+        pending.update = std::move(update);
+        return;
+      }
+    }
+
+    pending_.push_back(PendingUpdate{key, std::move(update), 0});
+    if (!posted_) {
+      posted_ = post_([this]() { Flush(); });
+    }
+  }
+
+  // Drops the pending update for `key`, if any, for owners that go away before the next frame.
+  void Cancel(Key key) {
+    for (auto* updates : {&pending_, &flushing_}) {
+      for (auto& pending : *updates) {
+        if (pending.key == key) {
+          pending.update = nullptr;
+        }
+      }
+    }
+  }
+
+  // Returns how many requests for `key` the pending update replaced, for callers that want to
+  // know how much work the frame saved. Only meaningful from inside that update.
+  uint32_t CoalescedCount(Key key) const {
+    for (const auto& pending : flushing_) {
+      if (pending.key == key) {
+        return pending.coalesced;
+      }
+    }
+    return 0;
+  }
+
+  // Runs everything pending in request order. Updates requested while flushing go to the next
+  // frame.
+  void Flush() {
+    posted_ = false;
+    if (pending_.empty()) {
+      return;
+    }
+
+    ++stats_.flushes;
+    flushing_.swap(pending_);
+    // Also when an update throws, or the updates after it would run with the next frame's.
+    struct ClearOnExit {
+      ~ClearOnExit() { updates.clear(); }
+      std::vector<PendingUpdate>& updates;
+    } clear_flushing{flushing_};
+
+    for (auto& pending : flushing_) {
+      if (pending.update) {
+        pending.update();
+      }
+    }
+  }
+
+ private:
+  struct PendingUpdate {
+    Key key;
+    Update update;
+    uint32_t coalesced;
+  };
+
+  Post post_;
+  bool posted_ = false;
+  std::vector<PendingUpdate> pending_;
+  std::vector<PendingUpdate> flushing_;
+  Stats stats_;
+};
@@ -23,7 +23,7 @@
 #include <winrt/base.h>
 #include <wrl.h>
 #include "Windows.UI.Composition.Mica.h"
-#include "winrt/Microsoft.Graphics.Canvas.Svg.h"
+#include "winrt/Microsoft.Graphics.Canvas.h"
 #include "winrt/Microsoft.Graphics.Canvas.UI.Composition.h"
 // C RunTime Header Files
 #include <malloc.h>
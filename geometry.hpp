@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+struct Point {
+  int32_t x;
+  int32_t y;
+};
+
+struct Rect {
+  int32_t left;
+  int32_t top;
+  int32_t right;
+  int32_t bottom;
+
+  int32_t Width() const { return right - left; }
+  int32_t Height() const { return bottom - top; }
+
+  bool Empty() const { return right <= left || bottom <= top; }
+
+  // Same semantics as ::PtInRect: left/top inclusive, right/bottom exclusive.
+  bool Contains(const Point& pt) const {
+    return pt.x >= left && pt.x < right && pt.y >= top && pt.y < bottom;
+  }
+
+  bool operator==(const Rect& other) const {
+    return left == other.left && top == other.top && right == other.right &&
+           bottom == other.bottom;
+  }
+  bool operator!=(const Rect& other) const { return !(*this == other); }
+};
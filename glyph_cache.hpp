@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "caption_glyphs.hpp"
+#include "geometry.hpp"
+#include "shelf_packer.hpp"
+
+// Rasterized glyphs, keyed by glyph and rasterization scale, packed into a few shared atlas pages.
+// The caption buttons draw the same handful of glyphs at the same scale, so each one only needs
+// to be rasterized once per scale instead of once per element.
+//
+// Past `max_bytes` the least recently used page is dropped as a whole, together with every glyph
+// on it. What the backend handed out for those glyphs may keep the page alive, but it is never
+// drawn to again.
+//
+// The pages and glyphs themselves come from `Backend`, which has to provide:
+//
+//   using Page = ...;   // Held for as long as the page is in the cache.
+//   using Glyph = ...;  // What Get returns, copied out of the cache.
+//   Page CreatePage(int32_t size);  // A transparent page `size` pixels square.
+//   Glyph DrawGlyph(Page& page, const Rect& cell, const Rect& glyph_rect, const GlyphPath& glyph,
+//                   float scale);
+//
+// DrawGlyph draws `glyph` into `glyph_rect`, which is `cell` without its padding.
+template <typename Backend>
+class GlyphAtlasCache {
+ public:
+  using Glyph = typename Backend::Glyph;
+
+  // Transparent border around every glyph in its cell, so fractional visual offsets never clip
+  // into the glyph itself.
+  static constexpr int32_t kPadding = 1;
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evicted_pages = 0;
+  };
+
+  GlyphAtlasCache(size_t max_bytes, int32_t page_size, Backend backend = {})
+      : backend_{std::move(backend)}, max_bytes_{max_bytes}, page_size_{page_size} {}
+
+  Glyph Get(const GlyphPath& glyph, float scale) {
+    ++tick_;
+    Key key{&glyph, scale};
+    if (auto it = entries_.find(key); it != entries_.end()) {
+      ++stats_.hits;
+      it->second.page->last_used = tick_;
+      return it->second.glyph;
+    }
+
+    ++stats_.misses;
+    auto cell_size = CellSize(scale);
+    auto [page, cell] = Allocate(cell_size);
+    page->last_used = tick_;
+
+    auto glyph_rect = Rect{
+        cell.left + kPadding, cell.top + kPadding, cell.right - kPadding, cell.bottom - kPadding};
+    auto drawn = backend_.DrawGlyph(page->page, cell, glyph_rect, glyph, scale);
+    auto& entry = entries_.emplace(key, Entry{std::move(drawn), page}).first->second;
+    Trim();
+    return entry.glyph;
+  }
+
+  void Clear() {
+    entries_.clear();
+    pages_.clear();
+    bytes_ = 0;
+  }
+
+  // The cell a glyph takes at `scale`, padding included.
+  static int32_t CellSize(float scale) {
+    return static_cast<int32_t>(std::ceil(kGlyphViewBoxSize * scale)) + 2 * kPadding;
+  }
+
+  size_t Bytes() const { return bytes_; }
+  size_t Pages() const { return pages_.size(); }
+  size_t Glyphs() const { return entries_.size(); }
+
+  // Fraction of the pages covered by glyph cells.
+  double Occupancy() const {
+    double occupancy = 0;
+    for (const auto& page : pages_) {
+      occupancy += page.packer.Occupancy();
+    }
+    return pages_.empty() ? 0 : occupancy / pages_.size();
+  }
+
+  const Stats& GetStats() const { return stats_; }
+
+  Backend& GetBackend() { return backend_; }
+  const Backend& GetBackend() const { return backend_; }
+
+ private:
+  struct Key {
+    const GlyphPath* glyph;
+    float scale;
+
+    bool operator==(const Key& other) const {
+      return scale == other.scale && glyph == other.glyph;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<const GlyphPath*>{}(key.glyph) ^ (std::hash<float>{}(key.scale) << 1);
+    }
+  };
+
+  struct Page {
+    typename Backend::Page page;
+    ShelfPacker packer;
+    size_t bytes;
+    uint64_t last_used = 0;
+  };
+
+  using PageIterator = typename std::list<Page>::iterator;
+
+  struct Entry {
+    Glyph glyph;
+    PageIterator page;
+  };
+
+  std::pair<PageIterator, Rect> Allocate(int32_t cell_size) {
+    for (auto page = pages_.begin(); page != pages_.end(); ++page) {
+      if (auto cell = page->packer.Insert(cell_size, cell_size)) {
+        return {page, *cell};
+      }
+    }
+
+    auto page_size = std::max(page_size_, cell_size);
+    auto bytes = static_cast<size_t>(page_size) * page_size * 4;
+    pages_.push_back(
+        Page{backend_.CreatePage(page_size), ShelfPacker{page_size, page_size}, bytes});
+    bytes_ += bytes;
+
+    auto page = std::prev(pages_.end());
+    return {page, *page->packer.Insert(cell_size, cell_size)};
+  }
+
+  void Trim() {
+    // Never drop the page we just used, even if it alone is over budget.
+    while (bytes_ > max_bytes_ && pages_.size() > 1) {
+      auto lru = std::min_element(pages_.begin(), pages_.end(), [](const Page& a, const Page& b) {
+        return a.last_used < b.last_used;
+      });
+      for (auto it = entries_.begin(); it != entries_.end();) {
+        it = it->second.page == lru ? entries_.erase(it) : std::next(it);
+      }
+      bytes_ -= lru->bytes;
+      pages_.erase(lru);
+      ++stats_.evicted_pages;
+    }
+  }
+
+  Backend backend_;
+  size_t max_bytes_;
+  int32_t page_size_;
+  std::list<Page> pages_;
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  size_t bytes_ = 0;
+  uint64_t tick_ = 0;
+  Stats stats_;
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Define GLYPH_RASTERIZER_NO_SSE2 to build the scalar Resolve on x86 too.
+#if !defined(GLYPH_RASTERIZER_NO_SSE2) && \
+    (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__))
+#include <emmintrin.h>
+#define GLYPH_RASTERIZER_SSE2 1
+#endif
+
+#include "svg_path.hpp"
+
+// Scanline rasterizer with exact area coverage, in the style of font-rs. Every edge deposits the
+// signed area it covers into an accumulation buffer; a running sum over the buffer then gives
+// each pixel's winding coverage. Filling uses the nonzero rule for shapes whose contours do not
+// overlap with the same winding, which holds for our glyphs.
+//
+// Everything happens in pixels with y pointing down, on the CPU and without touching a device,
+// so glyphs can be rendered off the UI thread.
+class GlyphRasterizer {
+ public:
+  GlyphRasterizer(int32_t width, int32_t height)
+      : width_{width}, height_{height}, accumulation_(Size() + 4, 0.0f) {}
+
+  int32_t Width() const { return width_; }
+  int32_t Height() const { return height_; }
+
+  void Clear() { std::fill(accumulation_.begin(), accumulation_.end(), 0.0f); }
+
+  template <size_t MaxPoints, size_t MaxContours>
+  void AddPath(const svg::FlattenedPath<MaxPoints, MaxContours>& path, float scale) {
+    path.ForEachContour([&](const svg::Vec2* points, size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        const auto& from = points[i];
+        const auto& to = points[(i + 1) % count];
+        AddLine(from.x * scale, from.y * scale, to.x * scale, to.y * scale);
+      }
+    });
+  }
+
+  void AddLine(float x0, float y0, float x1, float y1) {
+    if (y0 == y1) {
+      return;
+    }
+
+    float direction = 1.0f;
+    if (y0 > y1) {
+      std::swap(x0, x1);
+      std::swap(y0, y1);
+      direction = -1.0f;
+    }
+
+    // Edges must stay inside the buffer horizontally, otherwise the running sum would leak into
+    // the next row. Clamping keeps the area, which is what a pixel at the edge should see.
+    auto max_x = static_cast<float>(width_);
+    x0 = std::clamp(x0, 0.0f, max_x);
+    x1 = std::clamp(x1, 0.0f, max_x);
+
+    float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0;
+    if (y0 < 0.0f) {
+      x -= y0 * dxdy;
+    }
+
+    auto first_row = std::max(0, static_cast<int32_t>(y0));
+    auto end_row = std::min(height_, static_cast<int32_t>(std::ceil(y1)));
+    for (int32_t y = first_row; y < end_row; ++y) {
+      float* row = accumulation_.data() + static_cast<size_t>(y) * width_;
+      float dy = std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0);
+      float x_next = x + dxdy * dy;
+      float d = dy * direction;
+
+      float left = std::min(x, x_next);
+      float right = std::max(x, x_next);
+      float left_floor = std::floor(left);
+      auto left_i = static_cast<int32_t>(left_floor);
+      float right_ceil = std::ceil(right);
+      auto right_i = static_cast<int32_t>(right_ceil);
+
+      if (right_i <= left_i + 1) {
+        // The edge stays within one pixel column on this row.
+        float mid = 0.5f * (x + x_next) - left_floor;
+        row[left_i] += d - d * mid;
+        row[left_i + 1] += d * mid;
+      } else {
+        float inverse_width = 1.0f / (right - left);
+        float left_fraction = left - left_floor;
+        float first_area = 0.5f * inverse_width * (1.0f - left_fraction) * (1.0f - left_fraction);
+        float right_fraction = right - right_ceil + 1.0f;
+        float last_area = 0.5f * inverse_width * right_fraction * right_fraction;
+
+        row[left_i] += d * first_area;
+        if (right_i == left_i + 2) {
+          row[left_i + 1] += d * (1.0f - first_area - last_area);
+        } else {
+          float second_area = inverse_width * (1.5f - left_fraction);
+          row[left_i + 1] += d * (second_area - first_area);
+          for (int32_t xi = left_i + 2; xi < right_i - 1; ++xi) {
+            row[xi] += d * inverse_width;
+          }
+          float before_last = second_area + (right_i - left_i - 3) * inverse_width;
+          row[right_i - 1] += d * (1.0f - before_last - last_area);
+        }
+        row[right_i] += d * last_area;
+      }
+      x = x_next;
+    }
+  }
+
+  // Writes Width() * Height() coverage values, 0 to 255.
+  void Resolve(uint8_t* coverage) const {
+#if defined(GLYPH_RASTERIZER_SSE2)
+    ResolveSse2(coverage);
+#else
+    ResolveScalar(coverage);
+#endif
+  }
+
+  // What Resolve does without SSE2. Public so that the two can be compared.
+  void ResolveScalar(uint8_t* coverage) const { ResolveFrom(0, 0.0f, coverage); }
+
+#if defined(GLYPH_RASTERIZER_SSE2)
+  void ResolveSse2(uint8_t* coverage) const {
+    size_t i = 0;
+    size_t size = Size();
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    __m128 offset = _mm_setzero_ps();
+
+    for (; i + 4 <= size; i += 4) {
+      // Prefix sum of four lanes in two shift-and-add steps, plus the carry from before.
+      __m128 x = _mm_loadu_ps(accumulation_.data() + i);
+      x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+      x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+      x = _mm_add_ps(x, offset);
+
+      __m128 y = _mm_min_ps(_mm_andnot_ps(sign_mask, x), one);
+      __m128i values = _mm_cvtps_epi32(_mm_mul_ps(y, scale));
+      values = _mm_packs_epi32(values, values);
+      values = _mm_packus_epi16(values, values);
+      int32_t packed = _mm_cvtsi128_si32(values);
+      std::copy_n(reinterpret_cast<const uint8_t*>(&packed), 4, coverage + i);
+
+      offset = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    ResolveFrom(i, _mm_cvtss_f32(offset), coverage);
+  }
+#endif
+
+  // Resolves into premultiplied B8G8R8A8 pixels of a single color, `stride` bytes per row.
+  // `coverage` is Width() * Height() bytes of scratch, so that callers can keep it around.
+  void ResolveBgra(uint8_t b,
+                   uint8_t g,
+                   uint8_t r,
+                   uint8_t* coverage,
+                   uint8_t* pixels,
+                   size_t stride) const {
+    Resolve(coverage);
+
+    for (int32_t y = 0; y < height_; ++y) {
+      uint8_t* out = pixels + y * stride;
+      const uint8_t* in = coverage + static_cast<size_t>(y) * width_;
+      for (int32_t x = 0; x < width_; ++x) {
+        uint32_t alpha = in[x];
+        out[0] = static_cast<uint8_t>((b * alpha + 127) / 255);
+        out[1] = static_cast<uint8_t>((g * alpha + 127) / 255);
+        out[2] = static_cast<uint8_t>((r * alpha + 127) / 255);
+        out[3] = static_cast<uint8_t>(alpha);
+        out += 4;
+      }
+    }
+  }
+
+ private:
+  size_t Size() const { return static_cast<size_t>(width_) * height_; }
+
+  // The running sum from value `i` on, `sum` being the sum of the values before it.
+  void ResolveFrom(size_t i, float sum, uint8_t* coverage) const {
+    for (size_t size = Size(); i < size; ++i) {
+      sum += accumulation_[i];
+      coverage[i] = static_cast<uint8_t>(std::lround(std::min(std::fabs(sum), 1.0f) * 255.0f));
+    }
+  }
+
+  int32_t width_;
+  int32_t height_;
+  std::vector<float> accumulation_;
+};
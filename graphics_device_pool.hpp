@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "inline_function.hpp"
+
+// Owns the graphics devices every drawing surface is created with. They are created lazily on
+// first use and dropped together when the device is lost or the compositor changes; the next
+// surface then recreates them. Generation() changes whenever that happens, so caches of surfaces
+// drawn with the old devices know to throw them away.
+//
+// Surfaces drawn with a lost device stay blank, so `device_lost` is called to have them drawn
+// again. It runs from the backend's device lost handler and must not draw right away.
+//
+// The devices and surfaces themselves come from `Backend`, which has to provide:
+//
+//   using Compositor = ...;  // Compared with ==.
+//   using Devices = ...;     // Destroying it must unregister `device_lost`.
+//   using Surface = ...;
+//   using Size = ...;
+//   Devices CreateDevices(const Compositor& compositor, std::function<void()> device_lost);
+//   Surface CreateDrawingSurface(Devices& devices, const Size& size);
+template <typename Backend>
+class GraphicsDevicePool {
+ public:
+  using Compositor = typename Backend::Compositor;
+  using Devices = typename Backend::Devices;
+  using DeviceLost = InlineFunction<void()>;
+
+  struct Stats {
+    size_t devices_created = 0;
+    size_t surfaces_created = 0;
+    size_t devices_lost = 0;
+    std::chrono::microseconds device_creation_time{0};
+    std::chrono::microseconds surface_creation_time{0};
+  };
+
+  explicit GraphicsDevicePool(DeviceLost device_lost, Backend backend = {})
+      : backend_{std::move(backend)}, on_device_lost_{std::move(device_lost)} {}
+
+  GraphicsDevicePool(const GraphicsDevicePool&) = delete;
+  GraphicsDevicePool& operator=(const GraphicsDevicePool&) = delete;
+
+  Devices& GetDevices(const Compositor& compositor) {
+    EnsureDevices(compositor);
+    return *devices_;
+  }
+
+  typename Backend::Surface CreateDrawingSurface(const Compositor& compositor,
+                                                 const typename Backend::Size& size) {
+    EnsureDevices(compositor);
+
+    auto start = std::chrono::steady_clock::now();
+    auto surface = backend_.CreateDrawingSurface(*devices_, size);
+    stats_.surface_creation_time += ElapsedSince(start);
+    ++stats_.surfaces_created;
+    return surface;
+  }
+
+  uint32_t Generation() const { return generation_; }
+  const Stats& GetStats() const { return stats_; }
+
+  Backend& GetBackend() { return backend_; }
+
+ private:
+  void EnsureDevices(const Compositor& compositor) {
+    if (!compositor_ || !(*compositor_ == compositor)) {
+      Reset();
+      compositor_ = compositor;
+    }
+    if (devices_) {
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    devices_ = backend_.CreateDevices(compositor, [this]() {
+      ++stats_.devices_lost;
+      Reset();
+      on_device_lost_();
+    });
+    stats_.device_creation_time += ElapsedSince(start);
+    ++stats_.devices_created;
+  }
+
+  void Reset() {
+    if (devices_) {
+      ++generation_;
+    }
+    devices_.reset();
+  }
+
+  static std::chrono::microseconds ElapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+  }
+
+  Backend backend_;
+  DeviceLost on_device_lost_;
+  std::optional<Compositor> compositor_;
+  std::optional<Devices> devices_;
+  uint32_t generation_ = 0;
+  Stats stats_;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// The WM_NCHITTEST results, with the HT* values spelled out so this header does not need
+// <windows.h>. WindowsProject1.cpp checks them against the real ones.
+enum class HitTestCode : uint32_t {
+  Error = static_cast<uint32_t>(-2),
+  Nowhere = 0,
+  Client = 1,
+  Caption = 2,
+  SystemMenu = 3,
+  GrowBox = 4,
+  Menu = 5,
+  HorizontalScroll = 6,
+  VerticalScroll = 7,
+  MinimizeButton = 8,
+  MaximizeButton = 9,
+  LeftBorder = 10,
+  RightBorder = 11,
+  TopBorder = 12,
+  TopLeftCorner = 13,
+  TopRightCorner = 14,
+  BottomBorder = 15,
+  BottomLeftCorner = 16,
+  BottomRightCorner = 17,
+  Border = 18,
+  Object = 19,
+  CloseButton = 20,
+  HelpButton = 21
+};
+
+namespace hit_test_category {
+constexpr uint32_t kNone = 0;
+constexpr uint32_t kClient = 1 << 0;
+constexpr uint32_t kCaption = 1 << 1;
+constexpr uint32_t kButton = 1 << 2;
+constexpr uint32_t kSize = 1 << 3;
+constexpr uint32_t kFrame = 1 << 4;
+}  // namespace hit_test_category
+
+struct HitTestCodeInfo {
+  // nullptr for values that are not a HitTestCode.
+  const char* name;
+  uint32_t categories;
+
+  // Whether mouse messages over this code go to DefWindowProc by default. Moving and sizing need
+  // it, the caption buttons must not get it or DefWindowProc draws its own pressed buttons.
+  bool call_def_window_proc;
+};
+
+namespace detail {
+
+// Indexed by the code plus two, wrapping around in 32 bits so that HTERROR (-2) lands on the
+// first entry.
+constexpr uint32_t TableIndex(HitTestCode code) {
+  return static_cast<uint32_t>(code) + 2u;
+}
+
+constexpr std::array<HitTestCodeInfo, 24> kHitTestCodeInfos = [] {
+  using namespace hit_test_category;
+
+  std::array<HitTestCodeInfo, 24> infos{};
+  auto set = [&](HitTestCode code, const char* name, uint32_t categories, bool dwp) {
+    infos[TableIndex(code)] = HitTestCodeInfo{name, categories, dwp};
+  };
+
+  set(HitTestCode::Error, "Error", kNone, true);
+  set(HitTestCode::Nowhere, "Nowhere", kNone, true);
+  set(HitTestCode::Client, "Client", kClient, false);
+  set(HitTestCode::Caption, "Caption", kCaption, true);
+  set(HitTestCode::SystemMenu, "SystemMenu", kCaption | kButton, false);
+  set(HitTestCode::GrowBox, "GrowBox", kFrame, true);
+  set(HitTestCode::Menu, "Menu", kFrame, true);
+  set(HitTestCode::HorizontalScroll, "HorizontalScroll", kFrame, true);
+  set(HitTestCode::VerticalScroll, "VerticalScroll", kFrame, true);
+  set(HitTestCode::MinimizeButton, "MinimizeButton", kCaption | kButton, false);
+  set(HitTestCode::MaximizeButton, "MaximizeButton", kCaption | kButton, false);
+  set(HitTestCode::LeftBorder, "LeftBorder", kFrame | kSize, true);
+  set(HitTestCode::RightBorder, "RightBorder", kFrame | kSize, true);
+  set(HitTestCode::TopBorder, "TopBorder", kFrame | kSize, true);
+  set(HitTestCode::TopLeftCorner, "TopLeftCorner", kFrame | kSize, true);
+  set(HitTestCode::TopRightCorner, "TopRightCorner", kFrame | kSize, true);
+  set(HitTestCode::BottomBorder, "BottomBorder", kFrame | kSize, true);
+  set(HitTestCode::BottomLeftCorner, "BottomLeftCorner", kFrame | kSize, true);
+  set(HitTestCode::BottomRightCorner, "BottomRightCorner", kFrame | kSize, true);
+  set(HitTestCode::Border, "Border", kFrame, true);
+  set(HitTestCode::Object, "Object", kNone, true);
+  set(HitTestCode::CloseButton, "CloseButton", kCaption | kButton, false);
+  set(HitTestCode::HelpButton, "HelpButton", kCaption | kButton, false);
+  return infos;
+}();
+
+}  // namespace detail
+
+// Unknown values (including HTTRANSPARENT, which never reaches us) get an entry without a name
+// that routes to DefWindowProc.
+constexpr HitTestCodeInfo GetHitTestCodeInfo(HitTestCode code) {
+  auto index = detail::TableIndex(code);
+  if (index < detail::kHitTestCodeInfos.size() && detail::kHitTestCodeInfos[index].name) {
+    return detail::kHitTestCodeInfos[index];
+  }
+  return HitTestCodeInfo{nullptr, hit_test_category::kNone, true};
+}
+
+constexpr bool IsSizeHitTestCode(HitTestCode code) {
+  return (GetHitTestCodeInfo(code).categories & hit_test_category::kSize) != 0;
+}
+
+static_assert(GetHitTestCodeInfo(HitTestCode::Error).name[0] == 'E', "Error must be biased to 0");
+static_assert(GetHitTestCodeInfo(HitTestCode::HelpButton).name[0] == 'H',
+              "HelpButton must be the last entry");
+static_assert(!GetHitTestCodeInfo(static_cast<HitTestCode>(-1)).name,
+              "HTTRANSPARENT is not a HitTestCode");
+static_assert(!GetHitTestCodeInfo(static_cast<HitTestCode>(22)).name, "past the end");
+static_assert(IsSizeHitTestCode(HitTestCode::LeftBorder) &&
+                  IsSizeHitTestCode(HitTestCode::BottomRightCorner) &&
+                  !IsSizeHitTestCode(HitTestCode::Border),
+              "the size codes are HTSIZEFIRST through HTSIZELAST");
+static_assert(!GetHitTestCodeInfo(HitTestCode::MaximizeButton).call_def_window_proc,
+              "DefWindowProc must not see the caption buttons");
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "geometry.hpp"
+
+// Buckets z-ordered slots into fixed-width columns so that a hit test only looks at the few
+// slots overlapping the column under the point instead of walking every slot.
+//
+// Slots are numbered in insertion order, a higher slot is on top of a lower one. Each column
+// keeps its slots sorted top-down, so the first slot that contains the point wins.
+class HitTestIndex {
+ public:
+  using Slot = uint32_t;
+
+  static constexpr int32_t kColumnWidth = 32;
+
+  Slot Add(const Rect& bounds) {
+    auto slot = static_cast<Slot>(bounds_.size());
+    bounds_.push_back(Rect{});
+    Update(slot, bounds);
+    return slot;
+  }
+
+  void Clear() {
+    bounds_.clear();
+    columns_.clear();
+  }
+
+  void Update(Slot slot, const Rect& bounds) {
+    auto& current = bounds_[slot];
+    if (!current.Empty()) {
+      ForEachColumn(current, [slot](std::vector<Slot>& column) {
+        column.erase(std::find(column.begin(), column.end(), slot));
+      });
+    }
+
+    current = bounds;
+    if (current.Empty()) {
+      return;
+    }
+
+    auto last_column = ColumnAt(current.right - 1);
+    if (last_column >= columns_.size()) {
+      columns_.resize(last_column + 1);
+    }
+
+    ForEachColumn(current, [slot](std::vector<Slot>& column) {
+      auto it = std::lower_bound(column.begin(), column.end(), slot, std::greater<Slot>{});
+      column.insert(it, slot);
+    });
+  }
+
+  std::optional<Slot> FindTopmost(const Point& pt) const {
+    auto column = ColumnAt(pt.x);
+    if (column >= columns_.size()) {
+      return std::nullopt;
+    }
+    for (auto slot : columns_[column]) {
+      if (bounds_[slot].Contains(pt)) {
+        return slot;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  // Everything left of zero shares the first column, hits there still go through Contains.
+  static size_t ColumnAt(int32_t x) {
+    return x < 0 ? 0 : static_cast<size_t>(x / kColumnWidth);
+  }
+
+  template <typename Callable>
+  void ForEachColumn(const Rect& bounds, Callable&& callable) {
+    auto first = ColumnAt(bounds.left);
+    auto last = std::min(ColumnAt(bounds.right - 1), columns_.size() - 1);
+    for (auto i = first; i <= last; ++i) {
+      callable(columns_[i]);
+    }
+  }
+
+  std::vector<Rect> bounds_;
+  std::vector<std::vector<Slot>> columns_;
+};
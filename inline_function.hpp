@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 2 * sizeof(void*)>
+class InlineFunction;
+
+// A std::function that never allocates: the callable is stored in a fixed buffer inside the
+// object, and one that does not fit is a compile error rather than a trip to the heap.
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+ public:
+  InlineFunction() = default;
+  InlineFunction(std::nullptr_t) {}
+
+  template <typename F,
+            typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction>>>
+  InlineFunction(F&& callable) {
+    using Stored = std::decay_t<F>;
+    static_assert(sizeof(Stored) <= Capacity, "callable does not fit, raise Capacity");
+    static_assert(alignof(Stored) <= alignof(std::max_align_t), "callable is over-aligned");
+    static_assert(std::is_nothrow_move_constructible_v<Stored>,
+                  "callable must be nothrow move constructible");
+
+    new (&storage_) Stored(std::forward<F>(callable));
+    ops_ = &kOps<Stored>;
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept { MoveFrom(other); }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  InlineFunction(const InlineFunction&) = delete;
+  InlineFunction& operator=(const InlineFunction&) = delete;
+
+  ~InlineFunction() { Reset(); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  R operator()(Args... args) const {
+    return ops_->invoke(const_cast<void*>(static_cast<const void*>(&storage_)),
+                        std::forward<Args>(args)...);
+  }
+
+ private:
+  struct Ops {
+    R (*invoke)(void*, Args&&...);
+    void (*move)(void* from, void* to);
+    void (*destroy)(void*);
+  };
+
+  template <typename F>
+  static constexpr Ops kOps = {
+      [](void* f, Args&&... args) -> R {
+        return (*static_cast<F*>(f))(std::forward<Args>(args)...);
+      },
+      [](void* from, void* to) {
+        new (to) F(std::move(*static_cast<F*>(from)));
+        static_cast<F*>(from)->~F();
+      },
+      [](void* f) { static_cast<F*>(f)->~F(); },
+  };
+
+  void Reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  void MoveFrom(InlineFunction& other) {
+    if (other.ops_) {
+      other.ops_->move(&other.storage_, &storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  std::aligned_storage_t<Capacity, alignof(std::max_align_t)> storage_;
+  const Ops* ops_ = nullptr;
+};
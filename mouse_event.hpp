@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "geometry.hpp"
+
+enum class MouseButton { Left, Right };
+
+enum class MouseEventKind { Move, Leave, Down, Up, DoubleClick };
+
+// A mouse message with the Win32 encoding stripped off. Client and non-client messages map to
+// the same kinds, `non_client` remembers which one it was. The point is always in client
+// coordinates.
+struct MouseEvent {
+  MouseEventKind kind;
+  MouseButton button;
+  Point point;
+  bool non_client;
+};
+
+// The WM_* values we care about, so the translation below does not need <windows.h>.
+namespace mouse_message {
+constexpr uint32_t kMouseMove = 0x0200;
+constexpr uint32_t kLButtonDown = 0x0201;
+constexpr uint32_t kLButtonUp = 0x0202;
+constexpr uint32_t kLButtonDblClk = 0x0203;
+constexpr uint32_t kRButtonDown = 0x0204;
+constexpr uint32_t kRButtonUp = 0x0205;
+constexpr uint32_t kRButtonDblClk = 0x0206;
+constexpr uint32_t kMouseLeave = 0x02A3;
+constexpr uint32_t kNcMouseMove = 0x00A0;
+constexpr uint32_t kNcXButtonDblClk = 0x00AD;
+constexpr uint32_t kNcMouseLeave = 0x02A2;
+
+constexpr uint32_t kNcToClientOffset = kMouseMove - kNcMouseMove;
+}  // namespace mouse_message
+
+// Returns nullopt for messages the state machine does not handle (middle and X buttons).
+inline std::optional<MouseEvent> MouseEventFromMessage(uint32_t message, Point client_point) {
+  using namespace mouse_message;
+
+  bool non_client =
+      message == kNcMouseLeave || (message >= kNcMouseMove && message <= kNcXButtonDblClk);
+  if (non_client) {
+    message = message == kNcMouseLeave ? kMouseLeave : message + kNcToClientOffset;
+  }
+
+  auto make = [&](MouseEventKind kind, MouseButton button = MouseButton::Left) {
+    return MouseEvent{kind, button, client_point, non_client};
+  };
+
+  switch (message) {
+    case kMouseMove:
+      return make(MouseEventKind::Move);
+    case kMouseLeave:
+      return make(MouseEventKind::Leave);
+    case kLButtonDown:
+      return make(MouseEventKind::Down, MouseButton::Left);
+    case kLButtonUp:
+      return make(MouseEventKind::Up, MouseButton::Left);
+    case kLButtonDblClk:
+      return make(MouseEventKind::DoubleClick, MouseButton::Left);
+    case kRButtonDown:
+      return make(MouseEventKind::Down, MouseButton::Right);
+    case kRButtonUp:
+      return make(MouseEventKind::Up, MouseButton::Right);
+    case kRButtonDblClk:
+      return make(MouseEventKind::DoubleClick, MouseButton::Right);
+  }
+  return std::nullopt;
+}
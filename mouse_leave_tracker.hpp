@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "inline_function.hpp"
+
+// Remembers whether leave tracking is armed and for which area, so that TrackMouseEvent is called
+// once when the mouse enters the client or non-client area instead of on every move.
+//
+// The tracker does not call TrackMouseEvent itself: `arm` is handed whether the non-client area
+// is the one to track. Windows cancels the tracking when it sends the leave message, so `Left`
+// must see every WM_MOUSELEAVE and WM_NCMOUSELEAVE or the next enter goes unnoticed.
+class MouseLeaveTracker {
+ public:
+  using Arm = InlineFunction<void(bool non_client)>;
+
+  struct Stats {
+    uint64_t moves = 0;
+    uint64_t arms = 0;
+    uint64_t stale_leaves = 0;
+  };
+
+  explicit MouseLeaveTracker(Arm arm) : arm_{std::move(arm)} {}
+
+  MouseLeaveTracker(const MouseLeaveTracker&) = delete;
+  MouseLeaveTracker& operator=(const MouseLeaveTracker&) = delete;
+
+  const Stats& GetStats() const { return stats_; }
+
+  void Moved(bool non_client) {
+    ++stats_.moves;
+    auto area = non_client ? Area::NonClient : Area::Client;
+    if (armed_ != area) {
+      // Arming replaces whatever tracking there was for the other area.
+      arm_(non_client);
+      armed_ = area;
+      ++stats_.arms;
+    }
+  }
+
+  // Returns false for a leave from an area we have since re-armed for the other one. Such a
+  // leave is stale: the mouse moved within the window and is still over it.
+  bool Left(bool non_client) {
+    auto area = non_client ? Area::NonClient : Area::Client;
+    if (armed_ != area) {
+      ++stats_.stale_leaves;
+      return false;
+    }
+    armed_ = Area::None;
+    return true;
+  }
+
+ private:
+  enum class Area : uint8_t { None, Client, NonClient };
+
+  Arm arm_;
+  Area armed_ = Area::None;
+  Stats stats_;
+};
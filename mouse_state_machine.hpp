@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "geometry.hpp"
+#include "inline_function.hpp"
+#include "mouse_event.hpp"
+
+enum class RendererState { Normal, MouseOver, MouseDown };
+
+// Turns mouse events into enter, leave, down, up, click and double click calls on the element
+// under the mouse, and works out which state each element is drawn in.
+//
+// ElementT needs MouseDown, MouseUp, MouseClick and MouseDoubleClick taking (MouseButton, const
+// Point&), and MouseLeave(). Drawing states go through `set_state`, so the state machine does not
+// know about renderers and runs the same against elements that stand in for the real ones.
+template <typename ElementT>
+class MouseStateMachine {
+ public:
+  using SetState = InlineFunction<void(ElementT& element, RendererState state)>;
+
+  struct Stats {
+    uint64_t events = 0;
+    // `set_state` calls, at most two per event.
+    uint64_t state_updates = 0;
+  };
+
+  explicit MouseStateMachine(SetState set_state) : set_state_{std::move(set_state)} {}
+
+  MouseStateMachine(const MouseStateMachine&) = delete;
+  MouseStateMachine& operator=(const MouseStateMachine&) = delete;
+
+  const Stats& GetStats() const { return stats_; }
+
+  void Dispatch(ElementT* element, const MouseEvent& event) {
+    ++stats_.events;
+    switch (event.kind) {
+      case MouseEventKind::Move:
+        MouseMove(element);
+        break;
+      case MouseEventKind::Leave:
+        MouseLeave();
+        break;
+      case MouseEventKind::Down:
+        MouseDown(element, event.button, event.point);
+        break;
+      case MouseEventKind::Up:
+        MouseUp(element, event.button, event.point);
+        break;
+      case MouseEventKind::DoubleClick:
+        MouseDoubleClick(element, event.button, event.point);
+        break;
+    }
+  }
+
+  void MouseDown(ElementT* element, MouseButton button, const Point& point) {
+    mouse_down_element_ = element;
+    mouse_down_button_ = button;
+    SetActiveElement(element, RendererState::MouseDown);
+    if (element) {
+      element->MouseDown(button, point);
+    }
+  }
+
+  void MouseDoubleClick(ElementT* element, MouseButton button, const Point& point) {
+    MouseMove(element);
+    if (element) {
+      element->MouseDoubleClick(button, point);
+    }
+  }
+
+  void MouseUp(ElementT* element, MouseButton button, const Point& point) {
+    auto same_as_mouse_down = mouse_down_element_ == element && mouse_down_button_ == button;
+    mouse_down_element_ = nullptr;
+    mouse_down_button_ = std::nullopt;
+    MouseMove(element);
+
+    if (element) {
+      element->MouseUp(button, point);
+      if (same_as_mouse_down) {
+        element->MouseClick(button, point);
+      }
+    }
+  }
+
+  void MouseMove(ElementT* element) {
+    if (element) {
+      MouseOver(*element);
+    } else {
+      MouseLeave();
+    }
+  }
+
+  void MouseLeave() {
+    if (mouse_over_element_) {
+      mouse_over_element_->MouseLeave();
+      mouse_over_element_ = nullptr;
+    }
+    SetActiveElement(nullptr, RendererState::Normal);
+  }
+
+ private:
+  void MouseOver(ElementT& element) {
+    if (mouse_over_element_ != &element) {
+      if (mouse_over_element_) {
+        mouse_over_element_->MouseLeave();
+      }
+      mouse_over_element_ = &element;
+    }
+
+    SetActiveElement(&element,
+                     &element == mouse_down_element_ ? RendererState::MouseDown
+                                                     : RendererState::MouseOver);
+  }
+
+  // At most one element is ever drawn in a state other than Normal. Remembering which one it is
+  // means a transition only touches the previous and the next element, not every element.
+  void SetActiveElement(ElementT* element, RendererState state) {
+    if (active_element_ != element) {
+      if (active_element_) {
+        SetMouseState(*active_element_, RendererState::Normal);
+      }
+      active_element_ = element;
+      active_state_ = RendererState::Normal;
+    }
+
+    if (active_element_ && active_state_ != state) {
+      SetMouseState(*active_element_, state);
+      active_state_ = state;
+    }
+  }
+
+  void SetMouseState(ElementT& element, RendererState state) {
+    set_state_(element, state);
+    ++stats_.state_updates;
+  }
+
+  SetState set_state_;
+
+  ElementT* mouse_down_element_ = nullptr;
+  ElementT* mouse_over_element_ = nullptr;
+  std::optional<MouseButton> mouse_down_button_;
+
+  ElementT* active_element_ = nullptr;
+  RendererState active_state_ = RendererState::Normal;
+  Stats stats_;
+};
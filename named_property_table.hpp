@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace named_property {
+
+// Property names are ASCII identifiers, so only A-Z need folding.
+constexpr wchar_t FoldCase(wchar_t c) {
+  return c >= L'A' && c <= L'Z' ? static_cast<wchar_t>(c - L'A' + L'a') : c;
+}
+
+// FNV-1a over the case-folded name, mixed with `seed`. The low bits of FNV-1a only depend on the
+// low bits of the seed, and the table uses the low bits, so the result goes through the murmur3
+// finalizer for every seed bit to count.
+constexpr uint32_t Hash(const wchar_t* name, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (; *name; ++name) {
+    hash = (hash ^ static_cast<uint32_t>(FoldCase(*name))) * 16777619u;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35u;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+constexpr bool EqualsIgnoreCase(const wchar_t* a, const wchar_t* b) {
+  for (; *a && FoldCase(*a) == FoldCase(*b); ++a, ++b) {
+  }
+  return FoldCase(*a) == FoldCase(*b);
+}
+
+constexpr size_t SlotCount(size_t count) {
+  size_t slots = 1;
+  while (slots < 2 * count) {
+    slots *= 2;
+  }
+  return slots;
+}
+
+}  // namespace named_property
+
+// Case-insensitive lookup from name to entry, built at compile time from an array of entries
+// with a `Name` member. The seed is searched for at compile time so that every name gets a slot
+// of its own: a lookup hashes the name once and looks at one slot, whose entry is then confirmed
+// with a single compare, since a name that is not in the table can still land on a used slot.
+template <typename Entry, size_t N>
+class NamedPropertyTable {
+ public:
+  static constexpr size_t kSlots = named_property::SlotCount(N);
+  static constexpr uint32_t kMaxSeed = 1024;
+
+  // `entries` must have static storage duration, the table points into it.
+  constexpr explicit NamedPropertyTable(const Entry (&entries)[N]) : entries_{entries} {
+    for (uint32_t seed = 0; seed < kMaxSeed; ++seed) {
+      if (TryPlace(seed)) {
+        seed_ = seed;
+        return;
+      }
+    }
+    // Reached only when no seed separates the names, which fails the constant evaluation.
+    throw "no collision-free seed, raise kMaxSeed";
+  }
+
+  constexpr const Entry* Find(const wchar_t* name) const {
+    auto slot = slots_[named_property::Hash(name, seed_) & (kSlots - 1)];
+    if (slot == 0) {
+      return nullptr;
+    }
+    const auto& entry = entries_[slot - 1];
+    return named_property::EqualsIgnoreCase(entry.Name, name) ? &entry : nullptr;
+  }
+
+ private:
+  constexpr bool TryPlace(uint32_t seed) {
+    for (auto& slot : slots_) {
+      slot = 0;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      auto& slot = slots_[named_property::Hash(entries_[i].Name, seed) & (kSlots - 1)];
+      if (slot != 0) {
+        return false;
+      }
+      slot = static_cast<uint16_t>(i + 1);
+    }
+    return true;
+  }
+
+  const Entry* entries_;
+  uint32_t seed_ = 0;
+  // Entry index plus one, zero for an empty slot.
+  uint16_t slots_[kSlots] = {};
+};
+
+namespace detail {
+
+struct NamedPropertyTableTestEntry {
+  const wchar_t* Name;
+  int value;
+};
+
+constexpr NamedPropertyTableTestEntry kNamedPropertyTableTestEntries[] = {
+    {L"Opacity", 1}, {L"Color", 2}, {L"Mode", 3}, {L"BlurAmount", 4}, {L"Source", 5}};
+
+constexpr NamedPropertyTable kNamedPropertyTableTest{kNamedPropertyTableTestEntries};
+
+}  // namespace detail
+
+static_assert(detail::kNamedPropertyTableTest.Find(L"opacity")->value == 1, "case is folded");
+static_assert(detail::kNamedPropertyTableTest.Find(L"BLURAMOUNT")->value == 4, "case is folded");
+static_assert(detail::kNamedPropertyTableTest.Find(L"Mode")->value == 3, "exact names match");
+static_assert(!detail::kNamedPropertyTableTest.Find(L"Modes"), "unknown names do not match");
+static_assert(!detail::kNamedPropertyTableTest.Find(L""), "the empty name does not match");
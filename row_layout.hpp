@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+
+// Lays out a single row of slots along the top edge of a container, in the spirit of a flex row.
+// Widths and the row height are in DIPs and scaled to pixels on arrange.
+//
+//  - Left slots are stacked from the left edge in the order they were added.
+//  - Right slots are stacked from the right edge inwards in the order they were added.
+//  - Stretch slots share whatever space is left between the two, the first ones get the extra
+//    pixel when it does not divide evenly.
+//  - Fill slots span the whole row behind the others, like a background.
+//
+// The last arrangement is cached. Arranging again with the same container and DPI does nothing,
+// otherwise only slots whose bounds actually moved are reported.
+class RowLayout {
+ public:
+  using Slot = uint32_t;
+
+  enum class Anchor { Left, Right, Stretch, Fill };
+
+  explicit RowLayout(int32_t height) : height_{height} {}
+
+  Slot Add(Anchor anchor, int32_t width = 0) {
+    auto slot = static_cast<Slot>(slots_.size());
+    slots_.push_back(SlotInfo{anchor, width, Rect{}});
+    Invalidate();
+    return slot;
+  }
+
+  void Clear() {
+    slots_.clear();
+    Invalidate();
+  }
+
+  // Forgets the cached arrangement, the next Arrange reports every slot.
+  void Invalidate() { arranged_ = false; }
+
+  const Rect& Bounds(Slot slot) const { return slots_[slot].bounds; }
+
+  // Calls `on_changed(Slot, const Rect&)` for every slot whose bounds differ from the previous
+  // arrangement. Returns the number of slots reported.
+  template <typename Callable>
+  size_t Arrange(const Rect& container, uint32_t dpi, Callable&& on_changed) {
+    if (arranged_ && container == container_ && dpi == dpi_) {
+      return 0;
+    }
+
+    bool report_all = !arranged_;
+    arranged_ = true;
+    container_ = container;
+    dpi_ = dpi;
+
+    auto top = container.top;
+    auto bottom = container.top + Scale(height_, dpi);
+
+    auto left = container.left;
+    auto right = container.right;
+    size_t stretch_count = 0;
+    for (const auto& slot : slots_) {
+      if (slot.anchor == Anchor::Left) {
+        left += Scale(slot.width, dpi);
+      } else if (slot.anchor == Anchor::Right) {
+        right -= Scale(slot.width, dpi);
+      } else if (slot.anchor == Anchor::Stretch) {
+        ++stretch_count;
+      }
+    }
+
+    auto remaining = std::max(0, right - left);
+    auto stretch_width = stretch_count ? remaining / static_cast<int32_t>(stretch_count) : 0;
+    auto stretch_extra = stretch_count ? remaining % static_cast<int32_t>(stretch_count) : 0;
+
+    auto left_edge = container.left;
+    auto right_edge = container.right;
+    auto stretch_edge = left;
+
+    size_t changed = 0;
+    for (Slot i = 0; i < slots_.size(); ++i) {
+      auto& slot = slots_[i];
+      Rect bounds{0, top, 0, bottom};
+      switch (slot.anchor) {
+        case Anchor::Left:
+          bounds.left = left_edge;
+          bounds.right = left_edge += Scale(slot.width, dpi);
+          break;
+        case Anchor::Right:
+          bounds.right = right_edge;
+          bounds.left = right_edge -= Scale(slot.width, dpi);
+          break;
+        case Anchor::Stretch:
+          bounds.left = stretch_edge;
+          bounds.right = stretch_edge += stretch_width + (stretch_extra-- > 0 ? 1 : 0);
+          break;
+        case Anchor::Fill:
+          bounds.left = container.left;
+          bounds.right = container.right;
+          break;
+      }
+
+      if (report_all || bounds != slot.bounds) {
+        slot.bounds = bounds;
+        on_changed(i, slot.bounds);
+        ++changed;
+      }
+    }
+    return changed;
+  }
+
+ private:
+  struct SlotInfo {
+    Anchor anchor;
+    int32_t width;
+    Rect bounds;
+  };
+
+  // Same rounding as ::MulDiv(value, dpi, 96) for the non-negative values we deal with.
+  static int32_t Scale(int32_t value, uint32_t dpi) {
+    return static_cast<int32_t>((static_cast<int64_t>(value) * dpi + 48) / 96);
+  }
+
+  int32_t height_;
+  std::vector<SlotInfo> slots_;
+
+  bool arranged_ = false;
+  Rect container_{};
+  uint32_t dpi_ = 0;
+};
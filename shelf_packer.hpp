@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "geometry.hpp"
+
+// Packs rectangles into a fixed-size page as rows ("shelves"). A rectangle goes into the
+// lowest shelf that is tall enough, reusing space freed by Remove before growing the shelf, and
+// a new shelf is opened below the others when none fits. Good enough for lots of same-sized
+// items like glyphs, which is what it is for.
+class ShelfPacker {
+ public:
+  ShelfPacker(int32_t width, int32_t height) : width_{width}, height_{height} {}
+
+  std::optional<Rect> Insert(int32_t width, int32_t height) {
+    if (width <= 0 || height <= 0 || width > width_ || height > height_) {
+      return std::nullopt;
+    }
+
+    Shelf* best = nullptr;
+    for (auto& shelf : shelves_) {
+      if (shelf.height >= height && (!best || shelf.height < best->height) &&
+          shelf.CanFit(width, width_)) {
+        best = &shelf;
+      }
+    }
+
+    if (!best) {
+      auto top = shelves_.empty() ? 0 : shelves_.back().top + shelves_.back().height;
+      if (top + height > height_) {
+        return std::nullopt;
+      }
+      shelves_.push_back(Shelf{top, height, 0, {}});
+      best = &shelves_.back();
+    }
+
+    auto left = best->Allocate(width);
+    used_area_ += width * height;
+    return Rect{left, best->top, left + width, best->top + height};
+  }
+
+  void Remove(const Rect& rect) {
+    auto shelf = std::find_if(
+        shelves_.begin(), shelves_.end(), [&](const Shelf& s) { return s.top == rect.top; });
+    if (shelf == shelves_.end()) {
+      return;
+    }
+
+    shelf->Free(rect.left, rect.Width());
+    used_area_ -= rect.Width() * rect.Height();
+
+    while (!shelves_.empty() && shelves_.back().cursor == 0) {
+      shelves_.pop_back();
+    }
+  }
+
+  bool Empty() const { return used_area_ == 0; }
+
+  // Fraction of the page covered by live rectangles.
+  double Occupancy() const {
+    return static_cast<double>(used_area_) / (static_cast<double>(width_) * height_);
+  }
+
+ private:
+  struct Span {
+    int32_t left;
+    int32_t width;
+  };
+
+  struct Shelf {
+    int32_t top;
+    int32_t height;
+    int32_t cursor = 0;
+    std::vector<Span> free;  // Sorted by left, never touching `cursor`.
+
+    bool CanFit(int32_t width, int32_t page_width) const {
+      return cursor + width <= page_width ||
+             std::any_of(free.begin(), free.end(), [=](const Span& s) { return s.width >= width; });
+    }
+
+    int32_t Allocate(int32_t width) {
+      auto span =
+          std::find_if(free.begin(), free.end(), [=](const Span& s) { return s.width >= width; });
+      if (span != free.end()) {
+        auto left = span->left;
+        span->left += width;
+        span->width -= width;
+        if (span->width == 0) {
+          free.erase(span);
+        }
+        return left;
+      }
+
+      auto left = cursor;
+      cursor += width;
+      return left;
+    }
+
+    void Free(int32_t left, int32_t width) {
+      auto it = std::lower_bound(
+          free.begin(), free.end(), left, [](const Span& s, int32_t x) { return s.left < x; });
+      it = free.insert(it, Span{left, width});
+
+      if (auto next = it + 1; next != free.end() && it->left + it->width == next->left) {
+        it->width += next->width;
+        free.erase(next);
+      }
+      if (it != free.begin()) {
+        if (auto prev = it - 1; prev->left + prev->width == it->left) {
+          prev->width += it->width;
+          it = free.erase(it) - 1;
+        }
+      }
+
+      // Give the trailing span back to the cursor so the shelf can grow past it again.
+      if (it->left + it->width == cursor) {
+        cursor = it->left;
+        free.erase(it);
+      }
+    }
+  };
+
+  int32_t width_;
+  int32_t height_;
+  int64_t used_area_ = 0;
+  std::vector<Shelf> shelves_;
+};
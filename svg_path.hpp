@@ -0,0 +1,503 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Parser and flattener for SVG path data (the `d` attribute), limited to what our glyphs use:
+// M, L, H, V, C, S, A and Z in both absolute and relative form. Curves and arcs are flattened
+// into polylines. Everything is constexpr and writes into fixed-size storage, so glyphs can be
+// parsed at compile time and never allocate.
+namespace svg {
+
+struct Vec2 {
+  float x;
+  float y;
+};
+
+// Closed polygons, one per subpath. Contour i spans points
+// [i == 0 ? 0 : contour_ends[i - 1], contour_ends[i]).
+template <size_t MaxPoints, size_t MaxContours>
+struct FlattenedPath {
+  Vec2 points[MaxPoints]{};
+  size_t point_count = 0;
+  size_t contour_ends[MaxContours]{};
+  size_t contour_count = 0;
+  bool ok = true;  // False if the data was malformed or did not fit.
+
+  template <typename Callable>
+  void ForEachContour(Callable&& callable) const {
+    size_t begin = 0;
+    for (size_t i = 0; i < contour_count; ++i) {
+      callable(points + begin, contour_ends[i] - begin);
+      begin = contour_ends[i];
+    }
+  }
+};
+
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double Abs(double x) {
+  return x < 0 ? -x : x;
+}
+
+constexpr double Sqrt(double x) {
+  if (x <= 0) {
+    return 0;
+  }
+  double guess = x < 1 ? 1 : x;
+  for (int i = 0; i < 64; ++i) {
+    double next = 0.5 * (guess + x / guess);
+    if (next == guess) {
+      break;
+    }
+    guess = next;
+  }
+  return guess;
+}
+
+// Reduces to [-pi, pi] before the series, plenty accurate for flattening.
+constexpr double Sin(double x) {
+  while (x > kPi) {
+    x -= 2 * kPi;
+  }
+  while (x < -kPi) {
+    x += 2 * kPi;
+  }
+  double term = x;
+  double sum = x;
+  for (int n = 1; n < 12; ++n) {
+    term *= -x * x / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double Cos(double x) {
+  return Sin(x + kPi / 2);
+}
+
+constexpr double Atan(double x) {
+  // atan(x) = 2 * atan(x / (1 + sqrt(1 + x^2))) until |x| is small enough for the series.
+  double factor = 1;
+  while (Abs(x) > 0.1) {
+    x = x / (1 + Sqrt(1 + x * x));
+    factor *= 2;
+  }
+  double term = x;
+  double sum = x;
+  for (int n = 1; n < 10; ++n) {
+    term *= -x * x;
+    sum += term / (2 * n + 1);
+  }
+  return sum * factor;
+}
+
+constexpr double Atan2(double y, double x) {
+  if (x > 0) {
+    return Atan(y / x);
+  }
+  if (x < 0) {
+    return y >= 0 ? Atan(y / x) + kPi : Atan(y / x) - kPi;
+  }
+  return y > 0 ? kPi / 2 : (y < 0 ? -kPi / 2 : 0);
+}
+
+// Six segments per quarter turn.
+constexpr int SegmentsForAngle(double radians) {
+  return static_cast<int>(Abs(radians) / (kPi / 12)) + 1;
+}
+
+constexpr int kCubicSegments = 8;
+
+class Reader {
+ public:
+  constexpr explicit Reader(const char* data) : p_{data} {}
+
+  constexpr void SkipSeparators() {
+    while (*p_ == ' ' || *p_ == ',' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r') {
+      ++p_;
+    }
+  }
+
+  constexpr bool AtEnd() {
+    SkipSeparators();
+    return *p_ == '\0';
+  }
+
+  constexpr bool AtNumber() {
+    SkipSeparators();
+    return *p_ == '-' || *p_ == '+' || *p_ == '.' || IsDigit(*p_);
+  }
+
+  constexpr char ReadCommand() { return *p_++; }
+
+  constexpr bool ReadNumber(double& value) {
+    if (!AtNumber()) {
+      return false;
+    }
+
+    double sign = 1;
+    if (*p_ == '-' || *p_ == '+') {
+      sign = *p_ == '-' ? -1 : 1;
+      ++p_;
+    }
+
+    bool any_digits = false;
+    double result = 0;
+    while (IsDigit(*p_)) {
+      result = result * 10 + (*p_++ - '0');
+      any_digits = true;
+    }
+    if (*p_ == '.') {
+      ++p_;
+      double scale = 0.1;
+      while (IsDigit(*p_)) {
+        result += (*p_++ - '0') * scale;
+        scale *= 0.1;
+        any_digits = true;
+      }
+    }
+    if (!any_digits) {
+      return false;
+    }
+
+    if (*p_ == 'e' || *p_ == 'E') {
+      ++p_;
+      bool negative = *p_ == '-';
+      if (*p_ == '-' || *p_ == '+') {
+        ++p_;
+      }
+      int exponent = 0;
+      while (IsDigit(*p_)) {
+        exponent = exponent * 10 + (*p_++ - '0');
+      }
+      for (int i = 0; i < exponent; ++i) {
+        result = negative ? result / 10 : result * 10;
+      }
+    }
+
+    value = sign * result;
+    return true;
+  }
+
+  // Arc flags are a single digit and may run straight into the next number ("a1 1 0 001 1").
+  constexpr bool ReadFlag(bool& value) {
+    SkipSeparators();
+    if (*p_ != '0' && *p_ != '1') {
+      return false;
+    }
+    value = *p_++ == '1';
+    return true;
+  }
+
+ private:
+  static constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+  const char* p_;
+};
+
+template <size_t MaxPoints, size_t MaxContours>
+class Builder {
+ public:
+  using Path = FlattenedPath<MaxPoints, MaxContours>;
+
+  constexpr void MoveTo(double x, double y) {
+    EndContour();
+    current_x_ = start_x_ = x;
+    current_y_ = start_y_ = y;
+    AddPoint(x, y);
+    open_ = true;
+  }
+
+  constexpr void LineTo(double x, double y) {
+    EnsureOpen();
+    AddPoint(x, y);
+    current_x_ = x;
+    current_y_ = y;
+  }
+
+  constexpr void CubicTo(double x1, double y1, double x2, double y2, double x, double y) {
+    EnsureOpen();
+    double x0 = current_x_;
+    double y0 = current_y_;
+    for (int i = 1; i <= kCubicSegments; ++i) {
+      double t = static_cast<double>(i) / kCubicSegments;
+      double u = 1 - t;
+      double a = u * u * u;
+      double b = 3 * u * u * t;
+      double c = 3 * u * t * t;
+      double d = t * t * t;
+      AddPoint(a * x0 + b * x1 + c * x2 + d * x, a * y0 + b * y1 + c * y2 + d * y);
+    }
+    current_x_ = x;
+    current_y_ = y;
+  }
+
+  // Endpoint to center parameterization, SVG 1.1 appendix F.6.5.
+  constexpr void ArcTo(double rx,
+                       double ry,
+                       double rotation_degrees,
+                       bool large_arc,
+                       bool sweep,
+                       double x,
+                       double y) {
+    double x1 = current_x_;
+    double y1 = current_y_;
+    if (x1 == x && y1 == y) {
+      return;
+    }
+
+    rx = Abs(rx);
+    ry = Abs(ry);
+    if (rx == 0 || ry == 0) {
+      LineTo(x, y);
+      return;
+    }
+
+    double phi = rotation_degrees * kPi / 180;
+    double cos_phi = Cos(phi);
+    double sin_phi = Sin(phi);
+
+    double dx = (x1 - x) / 2;
+    double dy = (y1 - y) / 2;
+    double x1p = cos_phi * dx + sin_phi * dy;
+    double y1p = -sin_phi * dx + cos_phi * dy;
+
+    double lambda = (x1p * x1p) / (rx * rx) + (y1p * y1p) / (ry * ry);
+    if (lambda > 1) {
+      double root = Sqrt(lambda);
+      rx *= root;
+      ry *= root;
+    }
+
+    double numerator = rx * rx * ry * ry - rx * rx * y1p * y1p - ry * ry * x1p * x1p;
+    double denominator = rx * rx * y1p * y1p + ry * ry * x1p * x1p;
+    double coefficient = Sqrt(numerator > 0 ? numerator / denominator : 0);
+    if (large_arc == sweep) {
+      coefficient = -coefficient;
+    }
+    double cxp = coefficient * rx * y1p / ry;
+    double cyp = -coefficient * ry * x1p / rx;
+
+    double cx = cos_phi * cxp - sin_phi * cyp + (x1 + x) / 2;
+    double cy = sin_phi * cxp + cos_phi * cyp + (y1 + y) / 2;
+
+    double theta1 = Atan2((y1p - cyp) / ry, (x1p - cxp) / rx);
+    double theta2 = Atan2((-y1p - cyp) / ry, (-x1p - cxp) / rx);
+    double delta = theta2 - theta1;
+    if (sweep && delta < 0) {
+      delta += 2 * kPi;
+    } else if (!sweep && delta > 0) {
+      delta -= 2 * kPi;
+    }
+
+    EnsureOpen();
+    int segments = SegmentsForAngle(delta);
+    for (int i = 1; i < segments; ++i) {
+      double theta = theta1 + delta * i / segments;
+      double cos_theta = Cos(theta);
+      double sin_theta = Sin(theta);
+      AddPoint(cx + rx * cos_phi * cos_theta - ry * sin_phi * sin_theta,
+               cy + rx * sin_phi * cos_theta + ry * cos_phi * sin_theta);
+    }
+    AddPoint(x, y);
+    current_x_ = x;
+    current_y_ = y;
+  }
+
+  constexpr void Close() {
+    EndContour();
+    current_x_ = start_x_;
+    current_y_ = start_y_;
+  }
+
+  constexpr void Fail() { path_.ok = false; }
+
+  constexpr Path Finish() {
+    EndContour();
+    return path_;
+  }
+
+  constexpr double CurrentX() const { return current_x_; }
+  constexpr double CurrentY() const { return current_y_; }
+
+ private:
+  constexpr void AddPoint(double x, double y) {
+    if (path_.point_count == MaxPoints) {
+      path_.ok = false;
+      return;
+    }
+    path_.points[path_.point_count++] = Vec2{static_cast<float>(x), static_cast<float>(y)};
+  }
+
+  // Drawing after a Z starts a new subpath at the point the previous one closed at.
+  constexpr void EnsureOpen() {
+    if (!open_) {
+      MoveTo(current_x_, current_y_);
+    }
+  }
+
+  constexpr void EndContour() {
+    if (!open_) {
+      return;
+    }
+    open_ = false;
+
+    size_t begin = path_.contour_count == 0 ? 0 : path_.contour_ends[path_.contour_count - 1];
+    if (path_.point_count - begin < 3) {
+      // Nothing to fill.
+      path_.point_count = begin;
+      return;
+    }
+    if (path_.contour_count == MaxContours) {
+      path_.ok = false;
+      return;
+    }
+    path_.contour_ends[path_.contour_count++] = path_.point_count;
+  }
+
+  Path path_{};
+  bool open_ = false;
+  double start_x_ = 0;
+  double start_y_ = 0;
+  double current_x_ = 0;
+  double current_y_ = 0;
+};
+
+}  // namespace detail
+
+template <size_t MaxPoints, size_t MaxContours>
+constexpr FlattenedPath<MaxPoints, MaxContours> FlattenPath(const char* data) {
+  detail::Reader reader{data};
+  detail::Builder<MaxPoints, MaxContours> builder;
+
+  char command = 0;
+  double last_control_x = 0;
+  double last_control_y = 0;
+  bool last_was_cubic = false;
+
+  while (!reader.AtEnd()) {
+    if (!reader.AtNumber()) {
+      command = reader.ReadCommand();
+    } else if (command == 0 || command == 'Z' || command == 'z') {
+      builder.Fail();
+      break;
+    }
+
+    bool relative = command >= 'a' && command <= 'z';
+    double base_x = relative ? builder.CurrentX() : 0;
+    double base_y = relative ? builder.CurrentY() : 0;
+    double v[6] = {};
+    bool ok = true;
+    bool cubic = false;
+
+    switch (command) {
+      case 'M':
+      case 'm':
+        ok = reader.ReadNumber(v[0]) && reader.ReadNumber(v[1]);
+        if (ok) {
+          builder.MoveTo(base_x + v[0], base_y + v[1]);
+          // Further coordinate pairs are implicit line-tos.
+          command = relative ? 'l' : 'L';
+        }
+        break;
+
+      case 'L':
+      case 'l':
+        ok = reader.ReadNumber(v[0]) && reader.ReadNumber(v[1]);
+        if (ok) {
+          builder.LineTo(base_x + v[0], base_y + v[1]);
+        }
+        break;
+
+      case 'H':
+      case 'h':
+        ok = reader.ReadNumber(v[0]);
+        if (ok) {
+          builder.LineTo(base_x + v[0], builder.CurrentY());
+        }
+        break;
+
+      case 'V':
+      case 'v':
+        ok = reader.ReadNumber(v[0]);
+        if (ok) {
+          builder.LineTo(builder.CurrentX(), base_y + v[0]);
+        }
+        break;
+
+      case 'C':
+      case 'c':
+        for (auto& value : v) {
+          ok = ok && reader.ReadNumber(value);
+        }
+        if (ok) {
+          last_control_x = base_x + v[2];
+          last_control_y = base_y + v[3];
+          builder.CubicTo(base_x + v[0],
+                          base_y + v[1],
+                          last_control_x,
+                          last_control_y,
+                          base_x + v[4],
+                          base_y + v[5]);
+          cubic = true;
+        }
+        break;
+
+      case 'S':
+      case 's':
+        for (int i = 0; i < 4; ++i) {
+          ok = ok && reader.ReadNumber(v[i]);
+        }
+        if (ok) {
+          // The first control point reflects the previous curve's second one.
+          double x1 = builder.CurrentX();
+          double y1 = builder.CurrentY();
+          if (last_was_cubic) {
+            x1 = 2 * x1 - last_control_x;
+            y1 = 2 * y1 - last_control_y;
+          }
+          last_control_x = base_x + v[0];
+          last_control_y = base_y + v[1];
+          builder.CubicTo(
+              x1, y1, last_control_x, last_control_y, base_x + v[2], base_y + v[3]);
+          cubic = true;
+        }
+        break;
+
+      case 'A':
+      case 'a': {
+        bool large_arc = false;
+        bool sweep = false;
+        ok = reader.ReadNumber(v[0]) && reader.ReadNumber(v[1]) && reader.ReadNumber(v[2]) &&
+             reader.ReadFlag(large_arc) && reader.ReadFlag(sweep) && reader.ReadNumber(v[3]) &&
+             reader.ReadNumber(v[4]);
+        if (ok) {
+          builder.ArcTo(v[0], v[1], v[2], large_arc, sweep, base_x + v[3], base_y + v[4]);
+        }
+        break;
+      }
+
+      case 'Z':
+      case 'z':
+        builder.Close();
+        break;
+
+      default:
+        ok = false;
+        break;
+    }
+
+    if (!ok) {
+      builder.Fail();
+      break;
+    }
+    last_was_cubic = cubic;
+  }
+
+  return builder.Finish();
+}
+
+}  // namespace svg
@@ -1 +1,159 @@
 #pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "environment_settings.hpp"
+#include "inline_function.hpp"
+
+// The system menu commands we enable, disable or make the default, with the SC_* values spelled
+// out so this header does not need <windows.h>. WindowsProject1.cpp checks them against the real
+// ones.
+enum class SystemMenuCommand : uint16_t {
+  Size = 0xF000,
+  Move = 0xF010,
+  Minimize = 0xF020,
+  Maximize = 0xF030,
+  Close = 0xF060,
+  Restore = 0xF120
+};
+
+// The commands that are enabled or disabled depending on the window state, one bit each in
+// SystemMenuState::enabled.
+constexpr std::array<SystemMenuCommand, 5> kSystemMenuToggledCommands = {
+    SystemMenuCommand::Restore,
+    SystemMenuCommand::Size,
+    SystemMenuCommand::Move,
+    SystemMenuCommand::Minimize,
+    SystemMenuCommand::Maximize,
+};
+
+struct SystemMenuState {
+  uint8_t enabled;
+  SystemMenuCommand default_command;
+
+  constexpr bool Enabled(size_t index) const { return (enabled >> index) & 1; }
+
+  constexpr bool operator==(const SystemMenuState& other) const {
+    return enabled == other.enabled && default_command == other.default_command;
+  }
+  constexpr bool operator!=(const SystemMenuState& other) const { return !(*this == other); }
+};
+
+namespace detail {
+
+constexpr size_t SystemMenuStateIndex(bool maximized, bool minimized, bool from_caption) {
+  return (maximized ? 1u : 0u) | (minimized ? 2u : 0u) | (from_caption ? 4u : 0u);
+}
+
+// Every combination of (maximized, minimized, opened from the caption), worked out up front.
+constexpr std::array<SystemMenuState, 8> kSystemMenuStates = [] {
+  std::array<SystemMenuState, 8> states{};
+  for (size_t index = 0; index < states.size(); ++index) {
+    bool maximized = index & 1;
+    bool minimized = index & 2;
+    bool from_caption = index & 4;
+    bool restored = !maximized && !minimized;
+
+    // In kSystemMenuToggledCommands order.
+    bool enabled[] = {!restored, restored, restored, !minimized, !maximized};
+    uint8_t bits = 0;
+    for (size_t i = 0; i < kSystemMenuToggledCommands.size(); ++i) {
+      bits |= static_cast<uint8_t>(enabled[i] ? 1u << i : 0u);
+    }
+
+    // Double clicking the caption maximizes or restores, the system menu icon closes.
+    auto default_command = SystemMenuCommand::Close;
+    if (from_caption) {
+      default_command = maximized ? SystemMenuCommand::Restore : SystemMenuCommand::Maximize;
+    }
+    states[index] = SystemMenuState{bits, default_command};
+  }
+  return states;
+}();
+
+}  // namespace detail
+
+constexpr SystemMenuState GetSystemMenuState(bool maximized, bool minimized, bool from_caption) {
+  return detail::kSystemMenuStates[detail::SystemMenuStateIndex(
+      maximized, minimized, from_caption)];
+}
+
+static_assert(GetSystemMenuState(false, false, true).default_command ==
+                  SystemMenuCommand::Maximize,
+              "the caption of a restored window maximizes");
+static_assert(!GetSystemMenuState(false, false, false).Enabled(0) &&
+                  GetSystemMenuState(true, false, false).Enabled(0),
+              "Restore is only enabled for a maximized or minimized window");
+
+// How SystemMenu::Show has TrackPopupMenu lay out the menu, before it becomes TPM_* flags.
+struct SystemMenuPopupFlags {
+  bool layout_rtl;
+  bool right_button;
+  bool right_align;
+};
+
+// Reads the settings through the process-wide cache, so only the first menu opened after a
+// WM_SETTINGCHANGE looks them up.
+inline SystemMenuPopupFlags GetSystemMenuPopupFlags(EnvironmentSettings& settings,
+                                                    bool right_button) {
+  return SystemMenuPopupFlags{settings.IsRtl(), right_button, settings.MenuDropRightAligned()};
+}
+
+// Brings a menu to a SystemMenuState with as few calls as possible: only the items that differ
+// from the state applied last are touched, and nothing at all when the state is unchanged.
+//
+// The menu calls are callbacks, so this works on anything that stands in for a menu. When
+// something else changes the menu, call Forget and the next Apply sets every item again.
+class SystemMenuStateApplier {
+ public:
+  using EnableItem = InlineFunction<void(SystemMenuCommand command, bool enabled)>;
+  using SetDefaultItem = InlineFunction<void(SystemMenuCommand command)>;
+
+  struct Stats {
+    uint64_t applies = 0;
+    uint64_t calls = 0;
+  };
+
+  SystemMenuStateApplier(EnableItem enable_item, SetDefaultItem set_default_item)
+      : enable_item_{std::move(enable_item)}, set_default_item_{std::move(set_default_item)} {}
+
+  SystemMenuStateApplier(const SystemMenuStateApplier&) = delete;
+  SystemMenuStateApplier& operator=(const SystemMenuStateApplier&) = delete;
+
+  const Stats& GetStats() const { return stats_; }
+
+  void Apply(const SystemMenuState& state) {
+    ++stats_.applies;
+    if (applied_ == state) {
+      return;
+    }
+
+    // Unknown until every call went through, in case one of them throws.
+    auto previous = applied_;
+    applied_.reset();
+
+    if (!previous || previous->default_command != state.default_command) {
+      set_default_item_(state.default_command);
+      ++stats_.calls;
+    }
+    for (size_t i = 0; i < kSystemMenuToggledCommands.size(); ++i) {
+      if (!previous || previous->Enabled(i) != state.Enabled(i)) {
+        enable_item_(kSystemMenuToggledCommands[i], state.Enabled(i));
+        ++stats_.calls;
+      }
+    }
+    applied_ = state;
+  }
+
+  void Forget() { applied_.reset(); }
+
+ private:
+  EnableItem enable_item_;
+  SetDefaultItem set_default_item_;
+  std::optional<SystemMenuState> applied_;
+  Stats stats_;
+};
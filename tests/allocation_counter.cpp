@@ -0,0 +1,35 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocated_bytes{0};
+}  // namespace
+
+uint64_t test::AllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+uint64_t test::AllocatedBytes() {
+  return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (auto memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
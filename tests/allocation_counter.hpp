@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace test {
+
+// Number of calls to the global operator new so far. Only counts in executables that link
+// allocation_counter.cpp, which replaces it.
+uint64_t AllocationCount();
+
+// Bytes asked for by those calls so far, freed or not.
+uint64_t AllocatedBytes();
+
+}  // namespace test
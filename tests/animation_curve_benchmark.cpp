@@ -0,0 +1,81 @@
+#include <cmath>
+#include <cstdio>
+
+#include "animation_curve.hpp"
+#include "benchmark.hpp"
+
+namespace {
+
+template <typename Curve>
+void TimeEvaluate(const char* name, const Curve& curve) {
+  constexpr int kEvaluations = 10'000'000;
+  float sum = 0;
+  benchmark::Stopwatch stopwatch;
+  for (int i = 0; i < kEvaluations; ++i) {
+    sum += curve.Evaluate(static_cast<float>(i) / kEvaluations);
+  }
+  auto seconds = stopwatch.Seconds();
+  benchmark::Consume(static_cast<uint64_t>(sum));
+  std::printf("  %-22s %.1f ns per evaluation\n", name, seconds * 1e9 / kEvaluations);
+}
+
+// How far the compositor's linear interpolation between Count samples strays from the curve.
+template <size_t Count, typename Curve>
+float KeyFrameError(const Curve& curve) {
+  auto frames = SampleKeyFrames<Count>(curve);
+  float max_error = 0;
+  for (size_t i = 0; i + 1 < Count; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      auto fraction = j / 100.0f;
+      auto progress = frames[i].progress + (frames[i + 1].progress - frames[i].progress) * fraction;
+      auto lerp = frames[i].value + (frames[i + 1].value - frames[i].value) * fraction;
+      max_error = std::fmax(max_error, std::abs(curve.Evaluate(progress) - lerp));
+    }
+  }
+  return max_error;
+}
+
+template <typename Curve>
+void PrintKeyFrameErrors(const char* name, const Curve& curve) {
+  std::printf("  %-22s %.4f %.4f %.4f %.4f\n",
+              name,
+              KeyFrameError<4>(curve),
+              KeyFrameError<8>(curve),
+              KeyFrameError<16>(curve),
+              KeyFrameError<32>(curve));
+}
+
+}  // namespace
+
+// What a transition costs the UI thread to set up: evaluating the curves its key frames are
+// sampled from.
+BENCHMARK(AnimationCurveEvaluate) {
+  TimeEvaluate("linear", CubicBezier{0, 0, 1, 1});
+  TimeEvaluate("ease", CubicBezier{0.25, 0.1, 0.25, 1});
+  TimeEvaluate("fast out, slow in", CubicBezier::FastOutSlowIn());
+  TimeEvaluate("spring 0.4", Spring{0.4, 0.1});
+  TimeEvaluate("spring 1.0", Spring{1.0, 0.1});
+  TimeEvaluate("spring 2.0", Spring{2.0, 0.1});
+
+  constexpr int kSamplings = 1'000'000;
+  Spring spring{0.6, 0.1};
+  float sum = 0;
+  benchmark::Stopwatch stopwatch;
+  for (int i = 0; i < kSamplings; ++i) {
+    sum += SampleKeyFrames<16>(spring)[i % 16].value;
+  }
+  auto seconds = stopwatch.Seconds();
+  benchmark::Consume(static_cast<uint64_t>(sum));
+  std::printf("  16 key frames of a spring in %.0f ns\n", seconds * 1e9 / kSamplings);
+}
+
+// How many key frames a curve needs before the compositor's linear interpolation between them
+// is within a step of an 8-bit color channel, 0.0039, of the curve.
+BENCHMARK(AnimationCurveKeyFrameError) {
+  std::printf("  %-22s %6s %6s %6s %6s key frames\n", "", "4", "8", "16", "32");
+  PrintKeyFrameErrors("ease", CubicBezier{0.25, 0.1, 0.25, 1});
+  PrintKeyFrameErrors("fast out, slow in", CubicBezier::FastOutSlowIn());
+  PrintKeyFrameErrors("spring 0.4", Spring{0.4, 0.1});
+  PrintKeyFrameErrors("spring 0.7", Spring{0.7, 0.1});
+  PrintKeyFrameErrors("spring 1.0", Spring{1.0, 0.1});
+}
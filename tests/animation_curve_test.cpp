@@ -0,0 +1,112 @@
+#include <cmath>
+
+#include "animation_curve.hpp"
+#include "test.hpp"
+
+namespace {
+
+// How far a curve strays from (x(s), y(s)) taken straight from the bezier's definition.
+double MaxBezierError(double x1, double y1, double x2, double y2) {
+  CubicBezier curve{x1, y1, x2, y2};
+  double max_error = 0;
+  for (int i = 0; i <= 10'000; ++i) {
+    double s = i / 10'000.0;
+    double t = 1 - s;
+    double x = 3 * t * t * s * x1 + 3 * t * s * s * x2 + s * s * s;
+    double y = 3 * t * t * s * y1 + 3 * t * s * s * y2 + s * s * s;
+    max_error = std::fmax(max_error, std::abs(curve.Evaluate(static_cast<float>(x)) - y));
+  }
+  return max_error;
+}
+
+// The spring stepped through time with semi-implicit Euler, small enough steps to be exact to
+// well within the tolerances below.
+double MaxSpringError(double damping_ratio, double period) {
+  Spring spring{damping_ratio, period};
+  double omega = 2 * 3.14159265358979323846 / period;
+  constexpr double kStep = 1e-6;
+  double position = 0;
+  double velocity = 0;
+  double max_error = 0;
+  for (double time = 0; time < spring.Duration(); time += kStep) {
+    max_error = std::fmax(max_error, std::abs(spring.Position(time) - position));
+    velocity += (omega * omega * (1 - position) - 2 * damping_ratio * omega * velocity) * kStep;
+    position += velocity * kStep;
+  }
+  return max_error;
+}
+
+}  // namespace
+
+TEST(CubicBezierMatchesItsDefinition) {
+  CHECK(MaxBezierError(0, 0, 1, 1) < 1e-6);
+  CHECK(MaxBezierError(0.25, 0.1, 0.25, 1) < 1e-6);
+  CHECK(MaxBezierError(0.42, 0, 0.58, 1) < 1e-6);
+  // x is flat at the start, where Newton's method gives up and bisection takes over.
+  CHECK(MaxBezierError(0, 0, 0, 1) < 1e-6);
+  // Steep in the middle.
+  CHECK(MaxBezierError(0.7, 0, 0.3, 1) < 1e-6);
+  // Overshoots below 0 and above 1.
+  CHECK(MaxBezierError(0.3, -0.5, 0.7, 1.5) < 1e-6);
+}
+
+TEST(CubicBezierEndsAndKnownValues) {
+  CubicBezier linear{0, 0, 1, 1};
+  CHECK(linear.Evaluate(0.3f) == 0.3f);
+
+  // CSS "ease" at its midpoint, as browsers compute it.
+  CubicBezier ease{0.25, 0.1, 0.25, 1};
+  CHECK(std::abs(ease.Evaluate(0.5f) - 0.8024034f) < 1e-6);
+
+  auto fast_out = CubicBezier::FastOutSlowIn();
+  CHECK(fast_out.Evaluate(-1) == 0);
+  CHECK(fast_out.Evaluate(0) == 0);
+  CHECK(fast_out.Evaluate(1) == 1);
+  CHECK(fast_out.Evaluate(2) == 1);
+  CHECK(fast_out.Evaluate(0.1f) > 0.4f);
+}
+
+TEST(SpringMatchesASimulation) {
+  CHECK(MaxSpringError(0.3, 0.2) < 1e-4);
+  CHECK(MaxSpringError(1.0, 0.2) < 1e-4);
+  CHECK(MaxSpringError(2.5, 0.2) < 1e-4);
+}
+
+TEST(SpringSettlesAtItsDuration) {
+  for (double damping_ratio : {0.2, 0.6, 1.0, 1.5, 4.0}) {
+    Spring spring{damping_ratio, 0.1};
+    CHECK(spring.Duration() > 0);
+    CHECK(spring.Evaluate(0) == 0);
+    CHECK(spring.Evaluate(1) == 1);
+    CHECK(std::abs(spring.Position(spring.Duration()) - 1) <= Spring::kSettleTolerance + 1e-9);
+  }
+
+  // Overshoots below critical damping, creeps up to 1 from below at and above it.
+  Spring bouncy{0.3, 0.1};
+  Spring critical{1.0, 0.1};
+  Spring sluggish{3.0, 0.1};
+  float bouncy_max = 0;
+  float previous_critical = 0;
+  float previous_sluggish = 0;
+  bool monotonic = true;
+  for (int i = 0; i <= 1000; ++i) {
+    float progress = i / 1000.0f;
+    bouncy_max = std::fmax(bouncy_max, bouncy.Evaluate(progress));
+    monotonic = monotonic && critical.Evaluate(progress) >= previous_critical &&
+                sluggish.Evaluate(progress) >= previous_sluggish;
+    previous_critical = critical.Evaluate(progress);
+    previous_sluggish = sluggish.Evaluate(progress);
+  }
+  CHECK(bouncy_max > 1.3f);
+  CHECK(monotonic);
+
+  // Stiffer damping takes longer to get there.
+  CHECK(sluggish.Duration() > critical.Duration());
+}
+
+TEST(SampleKeyFramesSpansTheCurve) {
+  auto frames = SampleKeyFrames<5>(CubicBezier{0, 0, 1, 1});
+  CHECK(frames[0].progress == 0 && frames[0].value == 0);
+  CHECK(frames[2].progress == 0.5f && std::abs(frames[2].value - 0.5f) < 1e-6);
+  CHECK(frames[4].progress == 1 && frames[4].value == 1);
+}
@@ -0,0 +1,118 @@
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "arena.hpp"
+#include "benchmark.hpp"
+#include "inline_function.hpp"
+
+namespace {
+
+constexpr int kTitlebars = 10'000;
+
+// Roughly the shape of one titlebar: five elements, each with a background and up to two glyph
+// renderers, and a callback that makes the glyph brush.
+constexpr int kElements = 5;
+constexpr int kRenderersPerElement = 3;
+
+struct Renderer {
+  virtual ~Renderer() = default;
+  virtual uint64_t Draw() const = 0;
+};
+
+// Before: every renderer and element is its own heap block, factories are std::function.
+struct HeapRenderer final : Renderer {
+  explicit HeapRenderer(std::function<uint64_t()> factory) : factory{std::move(factory)} {}
+  uint64_t Draw() const override { return factory(); }
+
+  std::function<uint64_t()> factory;
+};
+
+struct HeapElement {
+  std::vector<std::unique_ptr<Renderer>> renderers;
+};
+
+// After: everything comes from the window's arena, factories are stored inline.
+struct ArenaRenderer final : Renderer {
+  explicit ArenaRenderer(InlineFunction<uint64_t()> factory) : factory{std::move(factory)} {}
+  uint64_t Draw() const override { return factory(); }
+
+  InlineFunction<uint64_t()> factory;
+};
+
+struct ArenaElement {
+  Renderer* renderers[kRenderersPerElement];
+};
+
+// `build` returns what it drew and adds the chunks its arena took straight from malloc to
+// `chunks`, which the allocation counter does not see.
+template <typename Build>
+void Run(const char* name, Build&& build) {
+  uint64_t drawn = 0;
+  uint64_t chunks = 0;
+  auto allocations = test::AllocationCount();
+  benchmark::Stopwatch stopwatch;
+  for (int i = 0; i < kTitlebars; ++i) {
+    drawn += build(i, chunks);
+  }
+  auto seconds = stopwatch.Seconds();
+  allocations = test::AllocationCount() - allocations + chunks;
+  benchmark::Consume(drawn);
+  std::printf("  %s: %.0f ns and %.1f heap allocations per titlebar created and destroyed\n",
+              name,
+              seconds * 1e9 / kTitlebars,
+              static_cast<double>(allocations) / kTitlebars);
+}
+
+}  // namespace
+
+BENCHMARK(ArenaTitlebars) {
+  // Captures a pointer and a size, like the glyph brush factories.
+  uint64_t glyph[2] = {1, 2};
+
+  Run("unique_ptr and std::function", [&](int i, uint64_t&) {
+    std::vector<std::unique_ptr<HeapElement>> elements;
+    for (int e = 0; e < kElements; ++e) {
+      auto element = std::make_unique<HeapElement>();
+      for (int r = 0; r < kRenderersPerElement; ++r) {
+        // Big enough captures that std::function has to allocate, like the hstring it held.
+        uint64_t extra[3] = {static_cast<uint64_t>(i), static_cast<uint64_t>(e), 0};
+        element->renderers.push_back(std::make_unique<HeapRenderer>(
+            [&glyph, extra]() { return glyph[0] + extra[0] + extra[1]; }));
+      }
+      elements.push_back(std::move(element));
+    }
+    uint64_t drawn = 0;
+    for (const auto& element : elements) {
+      for (const auto& renderer : element->renderers) {
+        drawn += renderer->Draw();
+      }
+    }
+    return drawn;
+  });
+
+  // One arena per titlebar, as each Window has, so the chunk allocation is counted every time.
+  Run("arena and InlineFunction", [&](int i, uint64_t& chunks) {
+    Arena arena;
+    ArenaElement* elements[kElements];
+    for (int e = 0; e < kElements; ++e) {
+      auto& element = arena.Make<ArenaElement>();
+      for (auto& renderer : element.renderers) {
+        auto key = static_cast<uint64_t>(i + e);
+        renderer = &arena.Make<ArenaRenderer>([&glyph, key]() { return glyph[0] + key; });
+      }
+      elements[e] = &element;
+    }
+    uint64_t drawn = 0;
+    for (auto element : elements) {
+      for (auto renderer : element->renderers) {
+        drawn += renderer->Draw();
+      }
+    }
+    chunks += arena.GetStats().chunk_allocations;
+    return drawn;
+  });
+}
@@ -0,0 +1,142 @@
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "arena.hpp"
+#include "inline_function.hpp"
+#include "test.hpp"
+
+namespace {
+
+// Appends its id to `log` when destroyed.
+struct Logged {
+  Logged(std::vector<int>& log, int id) : log{log}, id{id} {}
+  ~Logged() { log.push_back(id); }
+
+  std::vector<int>& log;
+  int id;
+};
+
+struct Throwing {
+  explicit Throwing(bool& destroyed) : destroyed{destroyed} { throw std::runtime_error{"no"}; }
+  ~Throwing() { destroyed = true; }
+
+  bool& destroyed;
+};
+
+struct alignas(16) Aligned {
+  uint8_t bytes[24];
+};
+
+}  // namespace
+
+TEST(ArenaDestroysNewestFirst) {
+  std::vector<int> log;
+  {
+    Arena arena;
+    for (int i = 0; i < 3; ++i) {
+      arena.Make<Logged>(log, i);
+    }
+    arena.Reset();
+    CHECK((log == std::vector<int>{2, 1, 0}));
+
+    arena.Make<Logged>(log, 3);
+    arena.Make<Logged>(log, 4);
+  }
+  CHECK((log == std::vector<int>{2, 1, 0, 4, 3}));
+}
+
+TEST(ArenaReusesChunksAfterReset) {
+  Arena arena{1024};
+  for (int i = 0; i < 100; ++i) {
+    arena.Make<Aligned>();
+  }
+  auto stats = arena.GetStats();
+  CHECK(stats.objects == 100);
+  CHECK(stats.chunk_allocations > 1);
+
+  // Same objects again: the chunks are already there, the heap is not touched.
+  arena.Reset();
+  CHECK(arena.GetStats().objects == 0);
+  CHECK(arena.GetStats().bytes == 0);
+  auto allocations = test::AllocationCount();
+  for (int i = 0; i < 100; ++i) {
+    auto& object = arena.Make<Aligned>();
+    CHECK(reinterpret_cast<uintptr_t>(&object) % alignof(Aligned) == 0);
+  }
+  CHECK(arena.GetStats().chunk_allocations == stats.chunk_allocations);
+  CHECK(arena.GetStats().bytes == stats.bytes);
+  CHECK(test::AllocationCount() == allocations);
+}
+
+TEST(ArenaGivesLargeObjectsAChunkOfTheirOwn) {
+  Arena arena{256};
+  auto& large = arena.Make<std::array<uint8_t, 1000>>();
+  large.fill(1);
+  arena.Make<int>(5);
+  CHECK(arena.GetStats().chunk_allocations == 2);
+  CHECK(large[999] == 1);
+}
+
+TEST(ArenaDoesNotDestroyWhatDidNotConstruct) {
+  Arena arena;
+  bool destroyed = false;
+  bool threw = false;
+  try {
+    arena.Make<Throwing>(destroyed);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+  CHECK(arena.GetStats().objects == 0);
+  arena.Reset();
+  CHECK(!destroyed);
+}
+
+TEST(InlineFunctionCallsAndMoves) {
+  int calls = 0;
+  InlineFunction<int(int)> add{[&calls](int x) {
+    ++calls;
+    return x + 1;
+  }};
+  CHECK(add);
+  CHECK(add(1) == 2);
+
+  auto moved = std::move(add);
+  CHECK(!add);
+  CHECK(moved(2) == 3);
+  CHECK(calls == 2);
+
+  InlineFunction<int(int)> empty = nullptr;
+  CHECK(!empty);
+  empty = std::move(moved);
+  CHECK(empty(3) == 4);
+}
+
+TEST(InlineFunctionDestroysItsCallableOnce) {
+  auto shared = std::make_shared<int>(0);
+  {
+    InlineFunction<void(), sizeof(std::shared_ptr<int>)> function{[shared]() { ++*shared; }};
+    CHECK(shared.use_count() == 2);
+    auto moved = std::move(function);
+    moved();
+    CHECK(shared.use_count() == 2);
+    moved = nullptr;
+    CHECK(shared.use_count() == 1);
+  }
+  CHECK(*shared == 1);
+  CHECK(shared.use_count() == 1);
+}
+
+TEST(InlineFunctionDoesNotAllocate) {
+  auto allocations = test::AllocationCount();
+  std::string text = "short";
+  InlineFunction<size_t()> function{[&text]() { return text.size(); }};
+  auto moved = std::move(function);
+  CHECK(moved() == 5);
+  CHECK(test::AllocationCount() == allocations);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Benchmarks live next to the tests but are a separate executable, they take a while and their
+// numbers are for reading rather than checking. BENCHMARK registers a function, which times its
+// loops with Stopwatch and prints what it measured.
+namespace benchmark {
+
+struct Case {
+  const char* name;
+  void (*run)();
+};
+
+inline std::vector<Case>& Cases() {
+  static std::vector<Case> cases;
+  return cases;
+}
+
+struct Registrar {
+  Registrar(const char* name, void (*run)()) { Cases().push_back(Case{name, run}); }
+};
+
+class Stopwatch {
+ public:
+  double Seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+};
+
+// Keeps the optimizer from dropping a computation whose result is otherwise unused.
+inline volatile uint64_t sink;
+inline void Consume(uint64_t value) {
+  sink = value;
+}
+
+}  // namespace benchmark
+
+#define BENCHMARK(name)                                                       \
+  static void name##Benchmark();                                              \
+  static const benchmark::Registrar name##Registrar{#name, &name##Benchmark}; \
+  static void name##Benchmark()
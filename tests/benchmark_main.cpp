@@ -0,0 +1,16 @@
+#include <cstdio>
+#include <cstring>
+
+#include "benchmark.hpp"
+
+// Runs every benchmark, or only those whose name contains argv[1].
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : "";
+  for (const auto& benchmark_case : benchmark::Cases()) {
+    if (std::strstr(benchmark_case.name, filter)) {
+      std::printf("%s\n", benchmark_case.name);
+      benchmark_case.run();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include <cstdint>
+#include <string>
+
+#include "composition_recorder.hpp"
+#include "fake_compositor.hpp"
+#include "test.hpp"
+
+namespace {
+
+const CompositionRecorder::PropertyStats& StatsOf(const CompositionRecorder& recorder,
+                                                  CompositionProperty property) {
+  return recorder.GetStats().properties[static_cast<size_t>(property)];
+}
+
+}  // namespace
+
+TEST(CompositionRecorderSkipsRepeatedValues) {
+  CompositionRecorder recorder;
+  FakeCompositor compositor;
+  auto visual = compositor.CreateObject();
+  FakeBrush brush_a;
+  FakeBrush brush_b;
+
+  SetOffset(recorder, visual, FakeFloat3{1, 2, 0});
+  SetOffset(recorder, visual, FakeFloat3{1, 2, 0});
+  SetOffset(recorder, visual, FakeFloat3{3, 2, 0});
+  SetBrush(recorder, visual, &brush_a);
+  SetBrush(recorder, visual, &brush_a);
+  SetBrush(recorder, visual, &brush_a);
+  SetBrush(recorder, visual, &brush_b);
+  SetIsVisible(recorder, visual, false);
+
+  CHECK(visual.Object().offset.x == 3);
+  CHECK(visual.Object().brush == &brush_b);
+  CHECK(!visual.Object().is_visible);
+  CHECK(visual.Object().Writes() == 5);
+
+  CHECK(StatsOf(recorder, CompositionProperty::Offset).issued == 2);
+  CHECK(StatsOf(recorder, CompositionProperty::Offset).skipped == 1);
+  CHECK(StatsOf(recorder, CompositionProperty::Brush).issued == 2);
+  CHECK(StatsOf(recorder, CompositionProperty::Brush).skipped == 2);
+  CHECK(StatsOf(recorder, CompositionProperty::IsVisible).issued == 1);
+  CHECK(StatsOf(recorder, CompositionProperty::IsVisible).skipped == 0);
+  CHECK(recorder.GetStats().Issued() == compositor.Writes());
+  CHECK(recorder.GetStats().Skipped() == 3);
+}
+
+TEST(CompositionRecorderKeepsObjectsApart) {
+  CompositionRecorder recorder;
+  FakeCompositor compositor;
+  auto a = compositor.CreateObject();
+  auto b = compositor.CreateObject();
+
+  SetOffset(recorder, a, FakeFloat3{1, 1, 0});
+  SetOffset(recorder, b, FakeFloat3{1, 1, 0});
+  SetIsVisible(recorder, a, true);
+
+  CHECK(a.Object().Writes() == 2);
+  CHECK(b.Object().Writes() == 1);
+  CHECK(recorder.GetStats().Skipped() == 0);
+}
+
+TEST(CompositionRecorderSharesValuesBetweenHandles) {
+  CompositionRecorder recorder;
+  FakeCompositor compositor;
+  auto properties = compositor.CreateObject();
+  auto same_properties = properties;
+
+  SetStateProperty(recorder, properties, 1.0f);
+  SetStateProperty(recorder, same_properties, 1.0f);
+  SetStateProperty(recorder, same_properties, 2.0f);
+
+  CHECK(properties.Object().state == 2.0f);
+  CHECK(properties.Object().Writes(CompositionProperty::State) == 2);
+  CHECK(StatsOf(recorder, CompositionProperty::State).skipped == 1);
+}
+
+TEST(CompositionRecorderIssuesEverythingAfterForgetValues) {
+  CompositionRecorder recorder;
+  FakeCompositor compositor;
+  auto visual = compositor.CreateObject();
+
+  SetOffset(recorder, visual, FakeFloat3{1, 1, 0});
+  SetOffset(recorder, visual, FakeFloat3{1, 1, 0});
+  recorder.ForgetValues();
+  SetOffset(recorder, visual, FakeFloat3{1, 1, 0});
+
+  CHECK(visual.Object().Writes() == 2);
+  CHECK(StatsOf(recorder, CompositionProperty::Offset).issued == 2);
+  CHECK(StatsOf(recorder, CompositionProperty::Offset).skipped == 1);
+}
+
+TEST(CompositionRecorderCountsWritesPerFrame) {
+  CompositionRecorder recorder;
+  FakeCompositor compositor;
+  auto visual = compositor.CreateObject();
+
+  SetOffset(recorder, visual, FakeFloat3{1, 0, 0});
+  SetIsVisible(recorder, visual, false);
+  recorder.EndFrame();
+  SetOffset(recorder, visual, FakeFloat3{2, 0, 0});
+  SetOffset(recorder, visual, FakeFloat3{2, 0, 0});
+  recorder.EndFrame();
+  recorder.EndFrame();
+
+  CHECK(recorder.GetStats().frames == 3);
+  CHECK(recorder.GetStats().max_writes_per_frame == 2);
+}
+
+TEST(CompositionRecorderNamesEveryProperty) {
+  CHECK(std::string{CompositionPropertyName(CompositionProperty::Offset)} == "Offset");
+  CHECK(std::string{CompositionPropertyName(CompositionProperty::IsVisible)} == "IsVisible");
+  CHECK(std::string{CompositionPropertyName(CompositionProperty::State)} == "State");
+  CHECK(std::string{CompositionPropertyName(CompositionProperty::Count)} == "?");
+}
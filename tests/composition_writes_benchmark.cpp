@@ -0,0 +1,134 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "benchmark.hpp"
+#include "composition_recorder.hpp"
+#include "fake_compositor.hpp"
+#include "fake_window.hpp"
+#include "mouse_event.hpp"
+
+namespace {
+
+// The same Set* calls as SpriteRenderer::Update: the glyph cache hands out one brush per scale,
+// sized to its cell.
+class GlyphSprite {
+ public:
+  GlyphSprite(FakeCompositor& compositor, CompositionRecorder& recorder)
+      : recorder_{recorder}, visual_{compositor.CreateObject()} {}
+
+  void SetRasterizationScale(float scale) {
+    auto index = static_cast<size_t>(scale * 4) % kBrushes.size();
+    SetBrush(recorder_, visual_, &kBrushes[index]);
+    auto cell = 16 * scale + 2;
+    SetSize(recorder_, visual_, FakeFloat2{cell, cell});
+  }
+
+  const FakeHandle& Visual() const { return visual_; }
+
+ private:
+  static inline const std::array<FakeBrush, 16> kBrushes{};
+
+  CompositionRecorder& recorder_;
+  FakeHandle visual_;
+};
+
+// The same Set* calls as ButtonRenderer<2>::SetActiveGlyph, which the maximize button gets with
+// every layout.
+class TwoGlyphButton {
+ public:
+  TwoGlyphButton(FakeCompositor& compositor, CompositionRecorder& recorder)
+      : recorder_{recorder}, glyphs_{GlyphSprite{compositor, recorder}, {compositor, recorder}} {}
+
+  void SetActiveGlyph(size_t index) {
+    for (size_t i = 0; i < glyphs_.size(); ++i) {
+      SetIsVisible(recorder_, glyphs_[i].Visual(), i == index);
+    }
+  }
+
+  void SetRasterizationScale(float scale) {
+    for (auto& glyph : glyphs_) {
+      glyph.SetRasterizationScale(scale);
+    }
+  }
+
+ private:
+  CompositionRecorder& recorder_;
+  std::array<GlyphSprite, 2> glyphs_;
+};
+
+void PrintWrites(const CompositionRecorder& recorder, uint64_t frames) {
+  const auto& stats = recorder.GetStats();
+  for (size_t i = 0; i < stats.properties.size(); ++i) {
+    const auto& property = stats.properties[i];
+    std::printf("    %-9s %8llu issued %8llu skipped\n",
+                CompositionPropertyName(static_cast<CompositionProperty>(i)),
+                static_cast<unsigned long long>(property.issued),
+                static_cast<unsigned long long>(property.skipped));
+  }
+  std::printf("    %.2f writes issued per frame, at most %llu, %.1f%% skipped\n",
+              static_cast<double>(stats.Issued()) / frames,
+              static_cast<unsigned long long>(stats.max_writes_per_frame),
+              100.0 * stats.Skipped() / (stats.Issued() + stats.Skipped()));
+}
+
+}  // namespace
+
+// The composition writes of a session with one window: a drag resize out and back, the mouse
+// over the caption, and a move to a monitor at another scale and back. Every frame lays the
+// caption out and sets the maximize glyph like Window::RequestLayout, and one frame is one
+// recorder EndFrame.
+BENCHMARK(CompositionWritesPerFrame) {
+  constexpr int kSessions = 1000;
+
+  FakeCompositor compositor;
+  CompositionRecorder recorder;
+  FakeWindow window{compositor, recorder};
+  TwoGlyphButton maximize{compositor, recorder};
+  auto& model = window.Model();
+
+  uint64_t frames = 0;
+  uint32_t dpi = 96;
+  auto layout = [&](int32_t width) {
+    model.Layout(Rect{0, 0, width, 500}, dpi);
+    maximize.SetActiveGlyph(1);
+    recorder.EndFrame();
+    ++frames;
+  };
+
+  benchmark::Stopwatch stopwatch;
+  for (int session = 0; session < kSessions; ++session) {
+    for (int32_t width = 700; width < 1000; width += 3) {
+      layout(width);
+    }
+    for (int32_t width = 1000; width > 700; width -= 3) {
+      layout(width);
+    }
+
+    for (int32_t x = 0; x < 700; x += 4) {
+      Point point{x, 20};
+      model.StateMachine().Dispatch(
+          model.FindElement(point),
+          MouseEvent{MouseEventKind::Move, MouseButton::Left, point, true});
+      recorder.EndFrame();
+      ++frames;
+    }
+    model.StateMachine().Dispatch(
+        nullptr, MouseEvent{MouseEventKind::Leave, MouseButton::Left, {}, true});
+
+    for (uint32_t new_dpi : {144u, 96u}) {
+      dpi = new_dpi;
+      maximize.SetRasterizationScale(dpi / 96.0f);
+      layout(700);
+    }
+  }
+  auto seconds = stopwatch.Seconds();
+
+  const auto& stats = recorder.GetStats();
+  std::printf("  %llu frames, %.1f ns per write made or skipped\n",
+              static_cast<unsigned long long>(frames),
+              seconds * 1e9 / (stats.Issued() + stats.Skipped()));
+  PrintWrites(recorder, frames);
+  benchmark::Consume(compositor.Writes());
+}
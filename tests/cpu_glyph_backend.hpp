@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "caption_glyphs.hpp"
+#include "geometry.hpp"
+#include "glyph_rasterizer.hpp"
+
+// A GlyphAtlasCache backend that keeps its pages in memory, so the cache can be tested and
+// benchmarked without a compositor. Pages are premultiplied B8G8R8A8 and glyphs are drawn black,
+// like the app's.
+struct CpuGlyphBackend {
+  struct Page {
+    std::shared_ptr<std::vector<uint8_t>> pixels;
+    int32_t size;
+  };
+
+  // Holds on to its page like a surface brush does, so it stays good after the cache drops it.
+  struct Glyph {
+    std::shared_ptr<const std::vector<uint8_t>> page;
+    int32_t page_size;
+    Rect cell;
+  };
+
+  Page CreatePage(int32_t size) {
+    ++pages_created;
+    return Page{std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size) * size * 4), size};
+  }
+
+  Glyph DrawGlyph(
+      Page& page, const Rect& cell, const Rect& glyph_rect, const GlyphPath& glyph, float scale) {
+    ++glyphs_drawn;
+    GlyphRasterizer rasterizer{glyph_rect.Width(), glyph_rect.Height()};
+    rasterizer.AddPath(glyph, scale);
+    coverage_.resize(static_cast<size_t>(glyph_rect.Width()) * glyph_rect.Height());
+    auto stride = static_cast<size_t>(page.size) * 4;
+    auto* origin = page.pixels->data() + glyph_rect.top * stride + glyph_rect.left * 4;
+    rasterizer.ResolveBgra(0, 0, 0, coverage_.data(), origin, stride);
+    return Glyph{page.pixels, page.size, cell};
+  }
+
+  size_t pages_created = 0;
+  size_t glyphs_drawn = 0;
+
+ private:
+  std::vector<uint8_t> coverage_;
+};
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "effect_graph.hpp"
+#include "golden.hpp"
+#include "test.hpp"
+
+namespace {
+
+constexpr int32_t kSize = 32;
+
+// Premultiplied B8G8R8A8, `kSize` pixels square.
+struct Bitmap {
+  std::vector<uint8_t> pixels = std::vector<uint8_t>(4 * kSize * kSize);
+
+  void Set(int32_t x, int32_t y, float b, float g, float r, float a) {
+    uint8_t* p = &pixels[4 * (y * kSize + x)];
+    p[0] = static_cast<uint8_t>(std::lround(b * a * 255));
+    p[1] = static_cast<uint8_t>(std::lround(g * a * 255));
+    p[2] = static_cast<uint8_t>(std::lround(r * a * 255));
+    p[3] = static_cast<uint8_t>(std::lround(a * 255));
+  }
+};
+
+// The background runs from red to blue left to right and fades out towards the bottom, the
+// foreground runs from yellow to dark green top to bottom and fades out towards the left. Every
+// mode then gets both colors across their range, and all four ways the two can overlap.
+Bitmap MakeBackground() {
+  Bitmap bitmap;
+  for (int32_t y = 0; y < kSize; ++y) {
+    for (int32_t x = 0; x < kSize; ++x) {
+      float t = x / (kSize - 1.0f);
+      float alpha = y < kSize / 2 ? 1.0f : 1.0f - (y - kSize / 2) / (kSize / 2.0f);
+      bitmap.Set(x, y, t, 0.25f, 1.0f - t, alpha);
+    }
+  }
+  return bitmap;
+}
+
+Bitmap MakeForeground() {
+  Bitmap bitmap;
+  for (int32_t y = 0; y < kSize; ++y) {
+    for (int32_t x = 0; x < kSize; ++x) {
+      float t = y / (kSize - 1.0f);
+      float alpha = x < kSize / 4 ? 0.0f : std::min(1.0f, (x - kSize / 4) / (kSize / 2.0f));
+      bitmap.Set(x, y, 0.1f, 1.0f - 0.6f * t, 1.0f - t, alpha);
+    }
+  }
+  return bitmap;
+}
+
+std::vector<uint8_t> Evaluate(const EffectGraph& graph, EffectGraph::NodeId output) {
+  std::vector<uint8_t> pixels(4 * kSize * kSize);
+  graph.Evaluate(output, kSize, kSize, pixels.data(), 4 * kSize);
+  return pixels;
+}
+
+// "blend_color_burn" for ColorBurn.
+std::string GoldenName(BlendMode mode) {
+  std::string name = "blend";
+  for (const char* c = BlendModeName(mode); *c; ++c) {
+    if (std::isupper(static_cast<unsigned char>(*c))) {
+      name += '_';
+    }
+    name += static_cast<char>(std::tolower(static_cast<unsigned char>(*c)));
+  }
+  return name;
+}
+
+// PAM has no BGRA tuple type, so the golden files are RGBA.
+golden::Image ToGolden(std::vector<uint8_t> pixels) {
+  for (size_t i = 0; i < pixels.size(); i += 4) {
+    std::swap(pixels[i], pixels[i + 2]);
+  }
+  return golden::Image{kSize, kSize, 4, std::move(pixels)};
+}
+
+#if defined(EFFECT_GRAPH_SSE2)
+effect_graph::Pixel RandomPixel(std::mt19937& random) {
+  std::uniform_real_distribution<float> channel{0.0f, 1.0f};
+  // Fully transparent and fully opaque pixels are common in practice and have their own paths.
+  float alpha = 0.0f;
+  switch (random() % 4) {
+    case 0:
+      alpha = 0.0f;
+      break;
+    case 1:
+      alpha = 1.0f;
+      break;
+    default:
+      alpha = channel(random);
+      break;
+  }
+  return {channel(random) * alpha, channel(random) * alpha, channel(random) * alpha, alpha};
+}
+#endif
+
+}  // namespace
+
+TEST(EffectGraphBlendGoldenImages) {
+  auto background = MakeBackground();
+  auto foreground = MakeForeground();
+  for (size_t i = 0; i < static_cast<size_t>(BlendMode::Count); ++i) {
+    auto mode = static_cast<BlendMode>(i);
+    EffectGraph graph;
+    auto b = graph.Image(background.pixels.data(), kSize, kSize, 4 * kSize);
+    auto s = graph.Image(foreground.pixels.data(), kSize, kSize, 4 * kSize);
+    auto name = GoldenName(mode);
+    auto pixels = Evaluate(graph, graph.Blend(mode, b, s));
+    // One level of slack for compilers that round the float math differently.
+    CHECK(golden::Matches(name.c_str(), ToGolden(std::move(pixels)), 1));
+  }
+}
+
+TEST(EffectGraphBlendsOpaqueColorsByTheSpec) {
+  using effect_graph::BlendPixel;
+  using effect_graph::Pixel;
+  const Pixel b{0.5f, 0.25f, 1.0f, 1.0f};
+  const Pixel s{0.5f, 0.5f, 0.0f, 1.0f};
+
+  auto multiply = BlendPixel(BlendMode::Multiply, b, s);
+  CHECK(multiply.b == 0.25f && multiply.g == 0.125f && multiply.r == 0.0f && multiply.a == 1.0f);
+  auto screen = BlendPixel(BlendMode::Screen, b, s);
+  CHECK(screen.b == 0.75f && screen.g == 0.625f && screen.r == 1.0f);
+  auto difference = BlendPixel(BlendMode::Difference, b, s);
+  CHECK(difference.b == 0.0f && difference.g == 0.25f && difference.r == 1.0f);
+
+  // Over a transparent background the foreground is drawn as it is, whatever the mode.
+  for (size_t i = 0; i < static_cast<size_t>(BlendMode::Count); ++i) {
+    auto over_nothing = BlendPixel(static_cast<BlendMode>(i), Pixel{}, s);
+    CHECK(over_nothing.b == s.b && over_nothing.g == s.g && over_nothing.r == s.r &&
+          over_nothing.a == s.a);
+  }
+}
+
+TEST(EffectGraphSse2MatchesScalar) {
+#if defined(EFFECT_GRAPH_SSE2)
+  constexpr size_t kCount = 4096;
+  std::mt19937 random{1};
+  std::vector<effect_graph::Pixel> background(kCount);
+  std::vector<effect_graph::Pixel> foreground(kCount);
+  for (size_t i = 0; i < kCount; ++i) {
+    background[i] = RandomPixel(random);
+    foreground[i] = RandomPixel(random);
+  }
+
+  size_t vectorized_modes = 0;
+  for (size_t m = 0; m < static_cast<size_t>(BlendMode::Count); ++m) {
+    auto mode = static_cast<BlendMode>(m);
+    std::vector<effect_graph::Pixel> scalar(kCount);
+    std::vector<effect_graph::Pixel> sse2(kCount);
+    effect_graph::BlendRowScalar(mode, background.data(), foreground.data(), scalar.data(), kCount);
+    auto done =
+        effect_graph::BlendRowSse2(mode, background.data(), foreground.data(), sse2.data(), kCount);
+    CHECK(done == 0 || done == kCount);
+    if (done == 0) {
+      continue;
+    }
+    ++vectorized_modes;
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < kCount; ++i) {
+      max_error = std::max({max_error, std::abs(scalar[i].b - sse2[i].b),
+                            std::abs(scalar[i].g - sse2[i].g), std::abs(scalar[i].r - sse2[i].r),
+                            std::abs(scalar[i].a - sse2[i].a)});
+    }
+    if (max_error > 1e-5f) {
+      std::fprintf(stderr, "%s: off by %g\n", BlendModeName(mode), max_error);
+    }
+    CHECK(max_error <= 1e-5f);
+  }
+  // Multiply, Screen, Darken, Lighten, LinearBurn, LinearDodge, Difference, Exclusion, Subtract.
+  CHECK(vectorized_modes == 9);
+#endif
+}
+
+TEST(EffectGraphFoldedMatchesUnfolded) {
+  // Opaque colors come out of ColorSource as exactly what an image of them holds, so the same
+  // graph over images gives what folding should give.
+  constexpr uint8_t kBackground[] = {200, 40, 90, 255};
+  constexpr uint8_t kForeground[] = {30, 170, 250, 255};
+  std::vector<uint8_t> background_image;
+  std::vector<uint8_t> foreground_image;
+  for (int32_t i = 0; i < kSize * kSize; ++i) {
+    background_image.insert(background_image.end(), std::begin(kBackground), std::end(kBackground));
+    foreground_image.insert(foreground_image.end(), std::begin(kForeground), std::end(kForeground));
+  }
+
+  for (size_t i = 0; i < static_cast<size_t>(BlendMode::Count); ++i) {
+    auto mode = static_cast<BlendMode>(i);
+    if (mode == BlendMode::Dissolve) {
+      continue;
+    }
+    auto build = [&](EffectGraph& graph, EffectGraph::NodeId b, EffectGraph::NodeId s) {
+      return graph.Opacity(graph.Blend(mode, graph.Opacity(b, 0.8f), graph.Opacity(s, 0.6f)), 0.9f);
+    };
+
+    EffectGraph folded;
+    auto folded_output = build(folded,
+                               folded.ColorSource(200, 40, 90, 255),
+                               folded.ColorSource(30, 170, 250, 255));
+    EffectGraph unfolded;
+    auto unfolded_output = build(unfolded,
+                                 unfolded.Image(background_image.data(), kSize, kSize, 4 * kSize),
+                                 unfolded.Image(foreground_image.data(), kSize, kSize, 4 * kSize));
+    CHECK(folded.GetStats().folded > 0);
+    CHECK(unfolded.GetStats().folded == 0);
+
+    auto expected = Evaluate(unfolded, unfolded_output);
+    auto actual = Evaluate(folded, folded_output);
+    int max_error = 0;
+    for (size_t p = 0; p < actual.size(); ++p) {
+      max_error = std::max(max_error, std::abs(actual[p] - expected[p]));
+    }
+    if (max_error > 1) {
+      std::fprintf(stderr, "%s: off by %d\n", BlendModeName(mode), max_error);
+    }
+    // The folded blend is scalar, the unfolded one may be SSE2.
+    CHECK(max_error <= 1);
+  }
+}
+
+TEST(EffectGraphSharedNodesMatchCopies) {
+  auto background = MakeBackground();
+  auto foreground = MakeForeground();
+
+  // The faded background is used three times, by two blends and one of them twice.
+  EffectGraph shared;
+  auto b = shared.Image(background.pixels.data(), kSize, kSize, 4 * kSize);
+  auto s = shared.Image(foreground.pixels.data(), kSize, kSize, 4 * kSize);
+  auto faded = shared.Opacity(b, 0.7f);
+  auto shared_output = shared.Blend(BlendMode::Screen,
+                                    shared.Blend(BlendMode::Overlay, faded, faded),
+                                    shared.Blend(BlendMode::Hue, faded, s));
+
+  EffectGraph copies;
+  b = copies.Image(background.pixels.data(), kSize, kSize, 4 * kSize);
+  s = copies.Image(foreground.pixels.data(), kSize, kSize, 4 * kSize);
+  auto copies_output = copies.Blend(
+      BlendMode::Screen,
+      copies.Blend(BlendMode::Overlay, copies.Opacity(b, 0.7f), copies.Opacity(b, 0.7f)),
+      copies.Blend(BlendMode::Hue, copies.Opacity(b, 0.7f), s));
+
+  CHECK(Evaluate(shared, shared_output) == Evaluate(copies, copies_output));
+}
@@ -0,0 +1,37 @@
+#include "environment_settings.hpp"
+#include "test.hpp"
+
+TEST(EnvironmentSettingsFetchesOnceUntilInvalidated) {
+  int rtl_fetches = 0;
+  int alignment_fetches = 0;
+  bool rtl = true;
+  EnvironmentSettings settings{[&]() {
+                                 ++rtl_fetches;
+                                 return rtl;
+                               },
+                               [&]() {
+                                 ++alignment_fetches;
+                                 return false;
+                               }};
+
+  CHECK(settings.IsRtl());
+  CHECK(settings.IsRtl());
+  CHECK(rtl_fetches == 1);
+  CHECK(alignment_fetches == 0);
+
+  // A change is only seen after the broadcast.
+  rtl = false;
+  CHECK(settings.IsRtl());
+  settings.Invalidate();
+  settings.Invalidate();
+  CHECK(!settings.IsRtl());
+  CHECK(!settings.MenuDropRightAligned());
+  CHECK(!settings.MenuDropRightAligned());
+  CHECK(rtl_fetches == 2);
+  CHECK(alignment_fetches == 1);
+
+  const auto& stats = settings.GetStats();
+  CHECK(stats.lookups == 6);
+  CHECK(stats.fetches == 3);
+  CHECK(stats.invalidations == 2);
+}
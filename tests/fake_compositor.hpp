@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "composition_recorder.hpp"
+
+struct FakeFloat2 {
+  float x;
+  float y;
+};
+
+struct FakeFloat3 {
+  float x;
+  float y;
+  float z;
+};
+
+// Brushes are only told apart, the Set* helpers hand them around by address.
+struct FakeBrush {};
+
+// What a composition object holds, and how many writes reached each of its properties.
+struct FakeCompositionObject {
+  FakeFloat3 offset{};
+  FakeFloat2 size{};
+  bool is_visible = true;
+  const FakeBrush* brush = nullptr;
+  float state = 0.0f;
+  std::array<uint64_t, static_cast<size_t>(CompositionProperty::Count)> writes{};
+
+  uint64_t Writes(CompositionProperty property) const {
+    return writes[static_cast<size_t>(property)];
+  }
+
+  uint64_t Writes() const {
+    uint64_t sum = 0;
+    for (auto count : writes) {
+      sum += count;
+    }
+    return sum;
+  }
+};
+
+// A handle to a FakeCompositionObject, with the setters of a WinRT visual and property set that
+// the Set* helpers call. Like the WinRT projections, copies refer to the same object.
+class FakeHandle {
+ public:
+  explicit FakeHandle(FakeCompositionObject& object) : object_{&object} {}
+
+  void Offset(const FakeFloat3& offset) const {
+    object_->offset = offset;
+    Count(CompositionProperty::Offset);
+  }
+
+  void Size(const FakeFloat2& size) const {
+    object_->size = size;
+    Count(CompositionProperty::Size);
+  }
+
+  void IsVisible(bool visible) const {
+    object_->is_visible = visible;
+    Count(CompositionProperty::IsVisible);
+  }
+
+  void Brush(const FakeBrush* brush) const {
+    object_->brush = brush;
+    Count(CompositionProperty::Brush);
+  }
+
+  // Only "State" is ever inserted.
+  void InsertScalar(const wchar_t*, float value) const {
+    object_->state = value;
+    Count(CompositionProperty::State);
+  }
+
+  FakeCompositionObject& Object() const { return *object_; }
+
+ private:
+  void Count(CompositionProperty property) const {
+    ++object_->writes[static_cast<size_t>(property)];
+  }
+
+  FakeCompositionObject* object_;
+};
+
+template <>
+struct CompositionObjectKey<FakeHandle> {
+  static const void* Get(const FakeHandle& handle) { return &handle.Object(); }
+};
+
+// Creates the objects behind FakeHandles and keeps them for as long as it lives, like a
+// compositor that never collects anything.
+class FakeCompositor {
+ public:
+  FakeHandle CreateObject() { return FakeHandle{objects_.emplace_back()}; }
+
+  size_t Objects() const { return objects_.size(); }
+
+  // Writes that reached an object, the ones the recorder skipped are not among them.
+  uint64_t Writes(CompositionProperty property) const {
+    uint64_t sum = 0;
+    for (const auto& object : objects_) {
+      sum += object.Writes(property);
+    }
+    return sum;
+  }
+
+  uint64_t Writes() const {
+    uint64_t sum = 0;
+    for (const auto& object : objects_) {
+      sum += object.Writes();
+    }
+    return sum;
+  }
+
+ private:
+  std::deque<FakeCompositionObject> objects_;
+};
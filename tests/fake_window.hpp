@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+
+#include "composition_recorder.hpp"
+#include "element_set.hpp"
+#include "fake_compositor.hpp"
+#include "geometry.hpp"
+#include "hit_test_code.hpp"
+#include "mouse_event.hpp"
+#include "mouse_state_machine.hpp"
+#include "system_menu.hpp"
+#include "window_model.hpp"
+
+// Stands in for an Element, writing to a FakeCompositor object through the same Set* helpers.
+class FakeElement : public ElementSetMember {
+ public:
+  FakeElement(HitTestCode hit_test, CompositionRecorder& recorder, FakeHandle visual)
+      : hit_test_{hit_test}, recorder_{recorder}, visual_{visual} {}
+
+  using ElementSetMember::Bounds;
+  // Offset and size, like Element::Bounds.
+  void Bounds(const Rect& bounds) {
+    if (!SetBounds(bounds)) {
+      return;
+    }
+    SetOffset(recorder_,
+              visual_,
+              FakeFloat3{static_cast<float>(bounds.left), static_cast<float>(bounds.top), 0.0f});
+    SetSize(recorder_,
+            visual_,
+            FakeFloat2{static_cast<float>(bounds.Width()), static_cast<float>(bounds.Height())});
+  }
+
+  void SetDpi(uint32_t dpi) { dpi_ = dpi; }
+
+  // 0, 1 and 2, the values BackgroundRenderer animates its State to.
+  void MouseState(RendererState state) {
+    SetStateProperty(recorder_, visual_, static_cast<float>(state));
+  }
+
+  void MouseDown(MouseButton, const Point&) {}
+  void MouseUp(MouseButton, const Point&) {}
+  void MouseClick(MouseButton, const Point&) { ++clicks_; }
+  void MouseDoubleClick(MouseButton, const Point&) {}
+  void MouseLeave() {}
+
+  HitTestCode HitTest() const { return hit_test_; }
+  uint32_t Dpi() const { return dpi_; }
+  const FakeCompositionObject& Visual() const { return visual_.Object(); }
+  uint64_t Clicks() const { return clicks_; }
+
+ private:
+  HitTestCode hit_test_;
+  CompositionRecorder& recorder_;
+  FakeHandle visual_;
+  uint32_t dpi_ = 0;
+  uint64_t clicks_ = 0;
+};
+
+// A WindowModel set up the way Window::CreateElements sets up the real one, with FakeElements
+// in its arena and the drawing states applied right away instead of with the next frame. Like
+// the app, every window writes through one recorder, which forgets its values when a window goes.
+class FakeWindow {
+ public:
+  static constexpr int32_t kCaptionHeight = 47;
+  static constexpr int32_t kButtonWidth = 44;
+
+  struct Stats {
+    uint64_t leave_arms = 0;
+    uint64_t menu_calls = 0;
+  };
+
+  FakeWindow(FakeCompositor& compositor, CompositionRecorder& recorder) : recorder_{recorder} {
+    auto& arena = model_.GetArena();
+    auto make = [&](HitTestCode hit_test) {
+      return &arena.Make<FakeElement>(hit_test, recorder, compositor.CreateObject());
+    };
+    caption_ = make(HitTestCode::Caption);
+    system_menu_ = make(HitTestCode::SystemMenu);
+    minimize_ = make(HitTestCode::MinimizeButton);
+    maximize_ = make(HitTestCode::MaximizeButton);
+    close_ = make(HitTestCode::CloseButton);
+    model_.SetElements({*caption_, *system_menu_, *minimize_, *maximize_, *close_});
+
+    using Anchor = RowLayout::Anchor;
+    model_.AddToCaptionLayout(*caption_, Anchor::Fill);
+    model_.AddToCaptionLayout(*system_menu_, Anchor::Left, kButtonWidth);
+    model_.AddToCaptionLayout(*close_, Anchor::Right, kButtonWidth);
+    model_.AddToCaptionLayout(*maximize_, Anchor::Right, kButtonWidth);
+    model_.AddToCaptionLayout(*minimize_, Anchor::Right, kButtonWidth);
+  }
+
+  ~FakeWindow() { recorder_.ForgetValues(); }
+
+  FakeWindow(const FakeWindow&) = delete;
+  FakeWindow& operator=(const FakeWindow&) = delete;
+
+  WindowModel<FakeElement>& Model() { return model_; }
+  const Stats& GetStats() const { return stats_; }
+
+  FakeElement& Caption() { return *caption_; }
+  FakeElement& Minimize() { return *minimize_; }
+  FakeElement& Close() { return *close_; }
+
+ private:
+  CompositionRecorder& recorder_;
+  Stats stats_;
+  WindowModel<FakeElement> model_{
+      kCaptionHeight,
+      [](FakeElement& element, RendererState state) { element.MouseState(state); },
+      [this](bool) { ++stats_.leave_arms; },
+      [this](SystemMenuCommand, bool) { ++stats_.menu_calls; },
+      [this](SystemMenuCommand) { ++stats_.menu_calls; }};
+  FakeElement* caption_ = nullptr;
+  FakeElement* system_menu_ = nullptr;
+  FakeElement* minimize_ = nullptr;
+  FakeElement* maximize_ = nullptr;
+  FakeElement* close_ = nullptr;
+};
@@ -0,0 +1,149 @@
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frame_scheduler.hpp"
+#include "test.hpp"
+
+namespace {
+
+// Stands in for the DispatcherQueue: posted flushes wait until the test runs the next tick.
+struct FakeQueue {
+  FrameScheduler scheduler{[this](std::function<void()> flush) {
+    if (closed) {
+      return false;
+    }
+    posted.push_back(flush);
+    return true;
+  }};
+  // Set to refuse posts, like a DispatcherQueue that is shutting down.
+  bool closed = false;
+  std::vector<std::function<void()>> posted;
+
+  void Tick() {
+    auto callbacks = std::move(posted);
+    posted.clear();
+    for (auto& callback : callbacks) {
+      callback();
+    }
+  }
+};
+
+}  // namespace
+
+TEST(FrameSchedulerCoalescesByKey) {
+  FakeQueue queue;
+  int size_key = 0;
+  int state_key = 0;
+  std::string log;
+  uint32_t coalesced = 0;
+
+  for (int width = 1; width <= 5; ++width) {
+    queue.scheduler.Request(&size_key, [&, width]() {
+      log += "size" + std::to_string(width) + " ";
+      coalesced = queue.scheduler.CoalescedCount(&size_key);
+    });
+  }
+  queue.scheduler.Request(&state_key, [&]() { log += "state "; });
+
+  // One post for the whole frame, nothing runs before the tick.
+  CHECK(queue.posted.size() == 1);
+  CHECK(queue.scheduler.Pending());
+  CHECK(log.empty());
+
+  queue.Tick();
+  CHECK(log == "size5 state ");
+  CHECK(coalesced == 4);
+  CHECK(!queue.scheduler.Pending());
+
+  const auto& stats = queue.scheduler.GetStats();
+  CHECK(stats.requested == 6);
+  CHECK(stats.coalesced == 4);
+  CHECK(stats.flushes == 1);
+}
+
+TEST(FrameSchedulerCancel) {
+  FakeQueue queue;
+  int key = 0;
+  bool ran = false;
+  queue.scheduler.Request(&key, [&]() { ran = true; });
+  queue.scheduler.Cancel(&key);
+  queue.Tick();
+  CHECK(!ran);
+}
+
+TEST(FrameSchedulerCancelDuringFlush) {
+  // An update that destroys another owner cancels its update from inside the flush.
+  FakeQueue queue;
+  int first = 0;
+  int second = 0;
+  bool second_ran = false;
+  queue.scheduler.Request(&first, [&]() { queue.scheduler.Cancel(&second); });
+  queue.scheduler.Request(&second, [&]() { second_ran = true; });
+  queue.Tick();
+  CHECK(!second_ran);
+}
+
+TEST(FrameSchedulerRequestsDuringFlushGoToTheNextFrame) {
+  FakeQueue queue;
+  int key = 0;
+  int runs = 0;
+  std::function<void()> update = [&]() {
+    if (++runs < 3) {
+      queue.scheduler.Request(&key, update);
+    }
+  };
+  queue.scheduler.Request(&key, update);
+
+  for (int frame = 1; frame <= 3; ++frame) {
+    queue.Tick();
+    CHECK(runs == frame);
+  }
+  CHECK(queue.posted.empty());
+  CHECK(queue.scheduler.GetStats().flushes == 3);
+}
+
+TEST(FrameSchedulerPostsAgainAfterAFailedPost) {
+  FakeQueue queue;
+  int first = 0;
+  int second = 0;
+  std::string log;
+
+  queue.closed = true;
+  queue.scheduler.Request(&first, [&]() { log += "first "; });
+  CHECK(queue.posted.empty());
+  CHECK(!queue.scheduler.Pending());
+
+  // The update that could not be posted is still there and goes with the next frame.
+  queue.closed = false;
+  queue.scheduler.Request(&second, [&]() { log += "second "; });
+  CHECK(queue.posted.size() == 1);
+  queue.Tick();
+  CHECK(log == "first second ");
+}
+
+TEST(FrameSchedulerDropsTheRestOfAFrameThatThrew) {
+  FakeQueue queue;
+  int first = 0;
+  int second = 0;
+  int next = 0;
+  std::string log;
+
+  queue.scheduler.Request(&first, [&]() { throw std::runtime_error{"update failed"}; });
+  queue.scheduler.Request(&second, [&]() { log += "second "; });
+  bool threw = false;
+  try {
+    queue.Tick();
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+
+  // Nothing of the failed frame runs again.
+  queue.scheduler.Request(&next, [&]() { log += "next "; });
+  queue.Tick();
+  CHECK(log == "next ");
+  CHECK(queue.scheduler.CoalescedCount(&second) == 0);
+}
@@ -0,0 +1,102 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "caption_glyphs.hpp"
+#include "cpu_glyph_backend.hpp"
+#include "glyph_cache.hpp"
+
+namespace {
+
+using Cache = GlyphAtlasCache<CpuGlyphBackend>;
+
+struct Request {
+  const GlyphPath* glyph;
+  float scale;
+};
+
+// Windows spread over monitors at the usual scales, a few of them in the middle of a drag to a
+// monitor at another scale. Most requests are for the common scales.
+std::vector<Request> MakeRequests(size_t count) {
+  const GlyphPath* glyphs[] = {&MaximizeGlyph, &RestoreGlyph, &MinimizeGlyph, &CloseGlyph};
+  const float scales[] = {1.0f, 1.5f, 1.25f, 2.0f, 1.75f, 2.5f, 3.0f, 3.5f, 4.0f};
+
+  std::mt19937 random{1};
+  std::geometric_distribution<size_t> scale_index{0.45};
+  std::vector<Request> requests;
+  requests.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto scale = scales[std::min(scale_index(random), std::size(scales) - 1)];
+    requests.push_back(Request{glyphs[random() % std::size(glyphs)], scale});
+  }
+  return requests;
+}
+
+}  // namespace
+
+BENCHMARK(GlyphCacheHitRate) {
+  constexpr size_t kRequests = 1'000'000;
+  auto requests = MakeRequests(kRequests);
+
+  // 4 MiB is what the app uses. At 256 KiB only one page fits, and every page change evicts.
+  for (size_t max_kib : {256, 512, 4096}) {
+    Cache cache{max_kib * 1024, 256};
+    benchmark::Stopwatch stopwatch;
+    uint64_t checksum = 0;
+    for (const auto& request : requests) {
+      checksum += cache.Get(*request.glyph, request.scale).cell.left;
+    }
+    auto seconds = stopwatch.Seconds();
+    benchmark::Consume(checksum);
+
+    const auto& stats = cache.GetStats();
+    std::printf(
+        "  %5zu KiB cap: %.3f%% hits, %zu misses, %zu pages evicted, %zu pages (%zu KiB), "
+        "%.1f%% occupied, %.1f ns per Get\n",
+        max_kib,
+        100.0 * stats.hits / kRequests,
+        stats.misses,
+        stats.evicted_pages,
+        cache.Pages(),
+        cache.Bytes() / 1024,
+        cache.Occupancy() * 100,
+        seconds * 1e9 / kRequests);
+  }
+}
+
+BENCHMARK(GlyphCacheVersusRasterizingEveryTime) {
+  constexpr size_t kRequests = 100'000;
+  auto requests = MakeRequests(kRequests);
+
+  Cache cache{4 * 1024 * 1024, 256};
+  benchmark::Stopwatch cached_stopwatch;
+  uint64_t checksum = 0;
+  for (const auto& request : requests) {
+    checksum += cache.Get(*request.glyph, request.scale).cell.left;
+  }
+  auto cached_seconds = cached_stopwatch.Seconds();
+
+  // What every element drawing its own glyph would cost, one page per glyph.
+  CpuGlyphBackend backend;
+  benchmark::Stopwatch uncached_stopwatch;
+  for (const auto& request : requests) {
+    auto cell_size = Cache::CellSize(request.scale);
+    auto page = backend.CreatePage(cell_size);
+    auto glyph_rect = Rect{1, 1, cell_size - 1, cell_size - 1};
+    checksum += backend.DrawGlyph(page, {0, 0, cell_size, cell_size}, glyph_rect, *request.glyph,
+                                  request.scale)
+                    .cell.right;
+  }
+  auto uncached_seconds = uncached_stopwatch.Seconds();
+  benchmark::Consume(checksum);
+
+  std::printf("  cached: %.1f ns per glyph, %zu rasterized\n",
+              cached_seconds * 1e9 / kRequests,
+              cache.GetBackend().glyphs_drawn);
+  std::printf("  uncached: %.1f ns per glyph, %zu rasterized\n",
+              uncached_seconds * 1e9 / kRequests,
+              backend.glyphs_drawn);
+}
@@ -0,0 +1,152 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "caption_glyphs.hpp"
+#include "cpu_glyph_backend.hpp"
+#include "glyph_cache.hpp"
+#include "test.hpp"
+
+namespace {
+
+using Cache = GlyphAtlasCache<CpuGlyphBackend>;
+
+// At 3x a glyph cell is 50 pixels, so every 64 pixel page holds exactly one.
+constexpr int32_t kSmallPage = 64;
+constexpr float kOnePerPage = 3.0f;
+constexpr size_t kSmallPageBytes = kSmallPage * kSmallPage * 4;
+
+uint8_t Alpha(const CpuGlyphBackend::Glyph& glyph, int32_t x, int32_t y) {
+  return (*glyph.page)[(static_cast<size_t>(y) * glyph.page_size + x) * 4 + 3];
+}
+
+bool AnyCoverage(const CpuGlyphBackend::Glyph& glyph) {
+  for (int32_t y = glyph.cell.top; y < glyph.cell.bottom; ++y) {
+    for (int32_t x = glyph.cell.left; x < glyph.cell.right; ++x) {
+      if (Alpha(glyph, x, y)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(GlyphCacheCountsHitsAndMisses) {
+  Cache cache{1024 * 1024, 256};
+
+  auto maximize = cache.Get(MaximizeGlyph, 1.0f);
+  cache.Get(CloseGlyph, 1.0f);
+  auto again = cache.Get(MaximizeGlyph, 1.0f);
+  cache.Get(MaximizeGlyph, 1.5f);
+  cache.Get(CloseGlyph, 1.0f);
+
+  CHECK(cache.GetStats().hits == 2);
+  CHECK(cache.GetStats().misses == 3);
+  CHECK(cache.GetBackend().glyphs_drawn == 3);
+  CHECK(again.cell == maximize.cell);
+  CHECK(again.page == maximize.page);
+
+  // All three cells fit on one page.
+  CHECK(cache.Pages() == 1);
+  CHECK(cache.Glyphs() == 3);
+  CHECK(cache.Bytes() == 256 * 256 * 4);
+}
+
+TEST(GlyphCacheEvictsTheLeastRecentlyUsedPage) {
+  Cache cache{3 * kSmallPageBytes, kSmallPage};
+
+  cache.Get(MaximizeGlyph, kOnePerPage);
+  auto restore = cache.Get(RestoreGlyph, kOnePerPage);
+  cache.Get(MinimizeGlyph, kOnePerPage);
+  CHECK(cache.Pages() == 3);
+  CHECK(cache.GetStats().evicted_pages == 0);
+
+  // Maximize was used last, so Restore's page is the one that goes.
+  cache.Get(MaximizeGlyph, kOnePerPage);
+  cache.Get(CloseGlyph, kOnePerPage);
+  CHECK(cache.Pages() == 3);
+  CHECK(cache.GetStats().evicted_pages == 1);
+
+  auto misses = cache.GetStats().misses;
+  cache.Get(MaximizeGlyph, kOnePerPage);
+  cache.Get(MinimizeGlyph, kOnePerPage);
+  cache.Get(CloseGlyph, kOnePerPage);
+  CHECK(cache.GetStats().misses == misses);
+  cache.Get(RestoreGlyph, kOnePerPage);
+  CHECK(cache.GetStats().misses == misses + 1);
+
+  // What was handed out before the eviction still holds the glyph.
+  CHECK(AnyCoverage(restore));
+}
+
+TEST(GlyphCacheStaysUnderTheByteCap) {
+  constexpr size_t kMaxBytes = 4 * kSmallPageBytes;
+  Cache cache{kMaxBytes, kSmallPage};
+
+  const GlyphPath* glyphs[] = {&MaximizeGlyph, &RestoreGlyph, &MinimizeGlyph, &CloseGlyph};
+  bool under_cap = true;
+  for (int round = 0; round < 3; ++round) {
+    for (float scale : {1.0f, 1.25f, 1.5f, 1.75f, 2.0f, 2.5f, 3.0f}) {
+      for (const auto* glyph : glyphs) {
+        cache.Get(*glyph, scale);
+        under_cap = under_cap && cache.Bytes() <= kMaxBytes;
+      }
+    }
+  }
+
+  CHECK(under_cap);
+  CHECK(cache.GetStats().evicted_pages > 0);
+  CHECK(cache.GetBackend().pages_created == cache.Pages() + cache.GetStats().evicted_pages);
+  CHECK(cache.GetStats().hits + cache.GetStats().misses == 3 * 7 * 4);
+}
+
+TEST(GlyphCacheKeepsAPageOverTheCap) {
+  // Smaller than any one page, but the page just drawn into is never dropped.
+  Cache cache{1024, kSmallPage};
+
+  cache.Get(MaximizeGlyph, 1.0f);
+  CHECK(cache.Pages() == 1);
+  CHECK(cache.Bytes() == kSmallPageBytes);
+
+  // Too big for a page, so it gets a page its own size.
+  auto large = cache.Get(CloseGlyph, 5.0f);
+  CHECK(cache.Pages() == 1);
+  CHECK(cache.GetStats().evicted_pages == 1);
+  CHECK(large.page_size == Cache::CellSize(5.0f));
+  CHECK(cache.Bytes() == static_cast<size_t>(large.page_size) * large.page_size * 4);
+}
+
+TEST(GlyphCacheLeavesThePaddingClear) {
+  Cache cache{1024 * 1024, 256};
+
+  for (float scale : {1.0f, 1.5f, 2.0f}) {
+    auto glyph = cache.Get(CloseGlyph, scale);
+    CHECK(glyph.cell.Width() == Cache::CellSize(scale));
+    CHECK(AnyCoverage(glyph));
+
+    bool padding_clear = true;
+    for (int32_t i = glyph.cell.left; i < glyph.cell.right; ++i) {
+      padding_clear = padding_clear && !Alpha(glyph, i, glyph.cell.top) &&
+                      !Alpha(glyph, i, glyph.cell.bottom - 1);
+    }
+    for (int32_t i = glyph.cell.top; i < glyph.cell.bottom; ++i) {
+      padding_clear = padding_clear && !Alpha(glyph, glyph.cell.left, i) &&
+                      !Alpha(glyph, glyph.cell.right - 1, i);
+    }
+    CHECK(padding_clear);
+  }
+}
+
+TEST(GlyphCacheStartsOverAfterClear) {
+  Cache cache{1024 * 1024, 256};
+
+  cache.Get(MaximizeGlyph, 1.0f);
+  cache.Clear();
+  CHECK(cache.Pages() == 0);
+  CHECK(cache.Bytes() == 0);
+  cache.Get(MaximizeGlyph, 1.0f);
+  CHECK(cache.GetStats().misses == 2);
+  CHECK(cache.GetBackend().pages_created == 2);
+}
@@ -0,0 +1,70 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "caption_glyphs.hpp"
+#include "glyph_rasterizer.hpp"
+
+BENCHMARK(GlyphRasterizerCaptionGlyphs) {
+  // What GlyphCache does on a miss: rasterize one glyph cell and resolve it to BGRA.
+  constexpr int kRounds = 20'000;
+  const GlyphPath* glyphs[] = {&MaximizeGlyph, &RestoreGlyph, &MinimizeGlyph, &CloseGlyph};
+
+  for (float scale : {1.0f, 1.5f, 2.0f, 3.0f}) {
+    auto size = static_cast<int32_t>(std::ceil(kGlyphViewBoxSize * scale));
+    std::vector<uint8_t> coverage(static_cast<size_t>(size) * size);
+    std::vector<uint8_t> pixels(coverage.size() * 4);
+    GlyphRasterizer rasterizer{size, size};
+
+    uint64_t checksum = 0;
+    benchmark::Stopwatch stopwatch;
+    for (int round = 0; round < kRounds; ++round) {
+      rasterizer.Clear();
+      rasterizer.AddPath(*glyphs[round % 4], scale);
+      rasterizer.ResolveBgra(0, 0, 0, coverage.data(), pixels.data(), size * 4u);
+      checksum += pixels[pixels.size() / 2 + 3];
+    }
+    auto seconds = stopwatch.Seconds();
+    benchmark::Consume(checksum);
+    std::printf("  %.1fx: %dx%d px, %.2f us per glyph, %.1f ns per pixel\n",
+                scale,
+                size,
+                size,
+                seconds * 1e6 / kRounds,
+                seconds * 1e9 / (static_cast<double>(kRounds) * size * size));
+  }
+}
+
+BENCHMARK(GlyphRasterizerResolve) {
+#if defined(GLYPH_RASTERIZER_SSE2)
+  constexpr int kRounds = 20'000;
+  constexpr float kScale = 3.0f;
+  auto size = static_cast<int32_t>(std::ceil(kGlyphViewBoxSize * kScale));
+  GlyphRasterizer rasterizer{size, size};
+  rasterizer.AddPath(CloseGlyph, kScale);
+  std::vector<uint8_t> coverage(static_cast<size_t>(size) * size);
+
+  benchmark::Stopwatch scalar_stopwatch;
+  for (int round = 0; round < kRounds; ++round) {
+    rasterizer.ResolveScalar(coverage.data());
+  }
+  auto scalar = scalar_stopwatch.Seconds();
+  benchmark::Consume(coverage[coverage.size() / 2]);
+
+  benchmark::Stopwatch sse2_stopwatch;
+  for (int round = 0; round < kRounds; ++round) {
+    rasterizer.ResolveSse2(coverage.data());
+  }
+  auto sse2 = sse2_stopwatch.Seconds();
+  benchmark::Consume(coverage[coverage.size() / 2]);
+
+  auto pixels = static_cast<double>(kRounds) * size * size;
+  std::printf("  3.0x: scalar %.2f ns per pixel, SSE2 %.2f ns per pixel\n",
+              scalar * 1e9 / pixels,
+              sse2 * 1e9 / pixels);
+#else
+  std::printf("  not built with SSE2\n");
+#endif
+}
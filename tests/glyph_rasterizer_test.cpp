@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "caption_glyphs.hpp"
+#include "glyph_rasterizer.hpp"
+#include "golden.hpp"
+#include "test.hpp"
+
+namespace {
+
+struct NamedGlyph {
+  const char* name;
+  const GlyphPath* path;
+};
+
+constexpr NamedGlyph kGlyphs[] = {{"maximize", &MaximizeGlyph},
+                                  {"restore", &RestoreGlyph},
+                                  {"minimize", &MinimizeGlyph},
+                                  {"close", &CloseGlyph}};
+
+// The scales the caption is drawn at on 96, 144, 192 and 288 DPI screens.
+constexpr float kScales[] = {1.0f, 1.5f, 2.0f, 3.0f};
+
+int32_t PixelSize(float scale) {
+  return static_cast<int32_t>(std::ceil(kGlyphViewBoxSize * scale));
+}
+
+std::vector<uint8_t> Resolve(const GlyphRasterizer& rasterizer) {
+  std::vector<uint8_t> coverage(static_cast<size_t>(rasterizer.Width()) * rasterizer.Height());
+  rasterizer.Resolve(coverage.data());
+  return coverage;
+}
+
+std::vector<uint8_t> Rasterize(const GlyphPath& path, float scale) {
+  auto size = PixelSize(scale);
+  GlyphRasterizer rasterizer{size, size};
+  rasterizer.AddPath(path, scale);
+  return Resolve(rasterizer);
+}
+
+// Nonzero winding number of `path` around (x, y), in viewBox units.
+int Winding(const GlyphPath& path, float x, float y) {
+  int winding = 0;
+  path.ForEachContour([&](const svg::Vec2* points, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      const auto& a = points[i];
+      const auto& b = points[(i + 1) % count];
+      if ((a.y <= y) != (b.y <= y)) {
+        float cross = (b.x - a.x) * (y - a.y) - (x - a.x) * (b.y - a.y);
+        if (a.y <= y && cross > 0) {
+          ++winding;
+        } else if (a.y > y && cross < 0) {
+          --winding;
+        }
+      }
+    }
+  });
+  return winding;
+}
+
+// Coverage by point sampling each pixel on a 16x16 grid, which is within 1/256 of the exact area
+// away from edges that run along the grid.
+std::vector<uint8_t> Supersample(const GlyphPath& path, float scale) {
+  constexpr int kSamples = 16;
+  auto size = PixelSize(scale);
+  std::vector<uint8_t> coverage(static_cast<size_t>(size) * size);
+  for (int32_t py = 0; py < size; ++py) {
+    for (int32_t px = 0; px < size; ++px) {
+      int inside = 0;
+      for (int sy = 0; sy < kSamples; ++sy) {
+        for (int sx = 0; sx < kSamples; ++sx) {
+          float x = (px + (sx + 0.5f) / kSamples) / scale;
+          float y = (py + (sy + 0.5f) / kSamples) / scale;
+          inside += Winding(path, x, y) != 0;
+        }
+      }
+      coverage[static_cast<size_t>(py) * size + px] =
+          static_cast<uint8_t>(std::lround(inside * 255.0f / (kSamples * kSamples)));
+    }
+  }
+  return coverage;
+}
+
+int MaxError(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+  int max_error = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    max_error = std::max(max_error, std::abs(a[i] - b[i]));
+  }
+  return max_error;
+}
+
+}  // namespace
+
+TEST(GlyphRasterizerSquareCoverage) {
+  // A 2x2 square offset by half a pixel covers a quarter of the corner pixels and half of the
+  // edge pixels, whichever way round it winds.
+  for (bool clockwise : {true, false}) {
+    GlyphRasterizer rasterizer{4, 4};
+    float x[] = {0.5f, 2.5f, 2.5f, 0.5f};
+    float y[] = {0.5f, 0.5f, 2.5f, 2.5f};
+    for (int i = 0; i < 4; ++i) {
+      int next = clockwise ? (i + 1) % 4 : (i + 3) % 4;
+      rasterizer.AddLine(x[i], y[i], x[next], y[next]);
+    }
+    std::vector<uint8_t> expected = {64, 128, 64, 0, 128, 255, 128, 0, 64, 128, 64, 0, 0, 0, 0, 0};
+    CHECK(Resolve(rasterizer) == expected);
+  }
+}
+
+TEST(GlyphRasterizerClipsToTheBuffer) {
+  // Everything outside the buffer is dropped, and nothing leaks into the next row. Five columns,
+  // so that Resolve also goes through the pixels left over after its four-wide loop.
+  GlyphRasterizer rasterizer{5, 4};
+  rasterizer.AddLine(-2, -2, 7, -2);
+  rasterizer.AddLine(7, -2, 7, 2);
+  rasterizer.AddLine(7, 2, -2, 2);
+  rasterizer.AddLine(-2, 2, -2, -2);
+  auto coverage = Resolve(rasterizer);
+  for (size_t i = 0; i < coverage.size(); ++i) {
+    CHECK(coverage[i] == (i < 10 ? 255 : 0));
+  }
+}
+
+TEST(GlyphRasterizerMatchesSupersampling) {
+  // The reference only approximates the area, worst where an edge runs just off a row of
+  // samples. The glyphs come out within 1 to 8 levels of it.
+  constexpr int kTolerance = 8;
+  for (const auto& glyph : kGlyphs) {
+    for (float scale : kScales) {
+      auto error = MaxError(Rasterize(*glyph.path, scale), Supersample(*glyph.path, scale));
+      if (error > kTolerance) {
+        std::fprintf(stderr, "%s at %.1fx: off by %d\n", glyph.name, scale, error);
+      }
+      CHECK(error <= kTolerance);
+    }
+  }
+}
+
+TEST(GlyphRasterizerGoldenImages) {
+  for (const auto& glyph : kGlyphs) {
+    for (float scale : kScales) {
+      auto name = std::string{"glyph_"} + glyph.name + "_" +
+                  std::to_string(static_cast<int>(scale * 100));
+      golden::Image image{PixelSize(scale), PixelSize(scale), 1, Rasterize(*glyph.path, scale)};
+      // One level of slack for compilers that round the float math differently.
+      CHECK(golden::Matches(name.c_str(), image, 1));
+    }
+  }
+}
+
+TEST(GlyphRasterizerSse2MatchesScalar) {
+#if defined(GLYPH_RASTERIZER_SSE2)
+  // The vector prefix sum adds in another order and rounds halves to even, so a value can come
+  // out one level apart.
+  for (const auto& glyph : kGlyphs) {
+    for (float scale : kScales) {
+      auto size = PixelSize(scale);
+      GlyphRasterizer rasterizer{size, size};
+      rasterizer.AddPath(*glyph.path, scale);
+      std::vector<uint8_t> scalar(static_cast<size_t>(size) * size);
+      std::vector<uint8_t> sse2(scalar.size());
+      rasterizer.ResolveScalar(scalar.data());
+      rasterizer.ResolveSse2(sse2.data());
+      CHECK(MaxError(scalar, sse2) <= 1);
+    }
+  }
+#endif
+}
+
+TEST(GlyphRasterizerResolveBgraPremultiplies) {
+  GlyphRasterizer rasterizer{4, 4};
+  float x[] = {0.5f, 2.5f, 2.5f, 0.5f};
+  float y[] = {0.5f, 0.5f, 2.5f, 2.5f};
+  for (int i = 0; i < 4; ++i) {
+    rasterizer.AddLine(x[i], y[i], x[(i + 1) % 4], y[(i + 1) % 4]);
+  }
+
+  // Rows are padded to 20 bytes, the padding is left alone.
+  constexpr size_t kStride = 20;
+  std::vector<uint8_t> coverage(16);
+  std::vector<uint8_t> pixels(kStride * 4, 0xAB);
+  rasterizer.ResolveBgra(200, 100, 50, coverage.data(), pixels.data(), kStride);
+
+  const uint8_t* center = &pixels[kStride + 4];
+  CHECK(center[0] == 200 && center[1] == 100 && center[2] == 50 && center[3] == 255);
+  const uint8_t* corner = &pixels[0];
+  CHECK(corner[0] == 50 && corner[1] == 25 && corner[2] == 13 && corner[3] == 64);
+  CHECK(pixels[16] == 0xAB && pixels[kStride * 4 - 1] == 0xAB);
+}
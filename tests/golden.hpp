@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Golden images: pixels a test produced are compared against a PAM file checked in under
+// tests/golden. Set UPDATE_GOLDEN=1 to write the files instead, after checking that the new
+// output is right. PAM keeps any number of 8-bit channels and opens in most image viewers.
+namespace golden {
+
+struct Image {
+  int32_t width = 0;
+  int32_t height = 0;
+  int32_t depth = 0;
+  std::vector<uint8_t> pixels;
+};
+
+inline std::string Path(const char* name) {
+  return std::string{GOLDEN_DIR} + "/" + name + ".pam";
+}
+
+inline bool Read(const char* name, Image& image) {
+  std::ifstream file{Path(name), std::ios::binary};
+  std::string line;
+  if (!std::getline(file, line) || line != "P7") {
+    return false;
+  }
+  while (std::getline(file, line) && line != "ENDHDR") {
+    std::istringstream fields{line};
+    std::string key;
+    fields >> key;
+    if (key == "WIDTH") {
+      fields >> image.width;
+    } else if (key == "HEIGHT") {
+      fields >> image.height;
+    } else if (key == "DEPTH") {
+      fields >> image.depth;
+    }
+  }
+  image.pixels.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+  return image.pixels.size() == static_cast<size_t>(image.width) * image.height * image.depth;
+}
+
+inline bool Write(const char* name, const Image& image) {
+  static constexpr const char* kTupleTypes[] = {"", "GRAYSCALE", "GRAYSCALE_ALPHA", "RGB",
+                                                "RGB_ALPHA"};
+  std::ofstream file{Path(name), std::ios::binary};
+  file << "P7\nWIDTH " << image.width << "\nHEIGHT " << image.height << "\nDEPTH " << image.depth
+       << "\nMAXVAL 255\nTUPLTYPE " << kTupleTypes[image.depth] << "\nENDHDR\n";
+  file.write(reinterpret_cast<const char*>(image.pixels.data()),
+             static_cast<std::streamsize>(image.pixels.size()));
+  return static_cast<bool>(file);
+}
+
+// Whether `image` matches the golden file `name` to within `tolerance` per channel. Reports the
+// largest difference when it does not.
+inline bool Matches(const char* name, const Image& image, int tolerance) {
+  const char* update = std::getenv("UPDATE_GOLDEN");
+  if (update && *update && *update != '0') {
+    return Write(name, image);
+  }
+
+  Image expected;
+  if (!Read(name, expected)) {
+    std::fprintf(stderr, "%s: missing or unreadable, run with UPDATE_GOLDEN=1\n",
+                 Path(name).c_str());
+    return false;
+  }
+  if (expected.width != image.width || expected.height != image.height ||
+      expected.depth != image.depth) {
+    std::fprintf(stderr, "%s: expected %dx%dx%d, got %dx%dx%d\n", name, expected.width,
+                 expected.height, expected.depth, image.width, image.height, image.depth);
+    return false;
+  }
+
+  int max_error = 0;
+  size_t worst = 0;
+  for (size_t i = 0; i < image.pixels.size(); ++i) {
+    int error = std::abs(image.pixels[i] - expected.pixels[i]);
+    if (error > max_error) {
+      max_error = error;
+      worst = i;
+    }
+  }
+  if (max_error > tolerance) {
+    auto pixel = worst / image.depth;
+    std::fprintf(stderr, "%s: off by %d at (%zu, %zu), channel %zu\n", name, max_error,
+                 pixel % image.width, pixel / image.width, worst % image.depth);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace golden
@@ -0,0 +1,111 @@
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "graphics_device_pool.hpp"
+#include "test.hpp"
+
+namespace {
+
+// Hands out numbered devices and remembers their device lost handlers, so a test can lose one.
+struct FakeGraphicsBackend {
+  using Compositor = int;
+
+  struct Size {
+    float width;
+    float height;
+  };
+
+  struct Surface {
+    int device;
+    Size size;
+  };
+
+  // The pool drops its devices from inside the handler, so Lose calls a copy.
+  struct Devices {
+    int id;
+    std::shared_ptr<std::function<void()>> device_lost;
+  };
+
+  Devices CreateDevices(const Compositor&, std::function<void()> device_lost) {
+    auto handler = std::make_shared<std::function<void()>>(std::move(device_lost));
+    handlers.push_back(handler);
+    return Devices{static_cast<int>(handlers.size()), handler};
+  }
+
+  Surface CreateDrawingSurface(Devices& devices, const Size& size) {
+    return Surface{devices.id, size};
+  }
+
+  // Returns false when the pool has already let go of that device.
+  bool Lose(int device) {
+    auto handler = handlers[device - 1].lock();
+    if (!handler) {
+      return false;
+    }
+    auto device_lost = *handler;
+    device_lost();
+    return true;
+  }
+
+  std::vector<std::weak_ptr<std::function<void()>>> handlers;
+};
+
+using Pool = GraphicsDevicePool<FakeGraphicsBackend>;
+
+}  // namespace
+
+TEST(GraphicsDevicePoolSharesOneDevice) {
+  Pool pool{[]() {}};
+  CHECK(pool.GetStats().devices_created == 0);
+
+  auto a = pool.CreateDrawingSurface(1, {16, 16});
+  auto b = pool.CreateDrawingSurface(1, {24, 24});
+  auto c = pool.CreateDrawingSurface(1, {32, 32});
+
+  CHECK(a.device == 1 && b.device == 1 && c.device == 1);
+  CHECK(c.size.width == 32);
+  CHECK(pool.GetDevices(1).id == 1);
+  CHECK(pool.GetStats().devices_created == 1);
+  CHECK(pool.GetStats().surfaces_created == 3);
+  CHECK(pool.Generation() == 0);
+}
+
+TEST(GraphicsDevicePoolRecreatesTheDeviceAfterItIsLost) {
+  int redraws = 0;
+  Pool pool{[&]() { ++redraws; }};
+
+  pool.CreateDrawingSurface(1, {16, 16});
+  CHECK(pool.GetBackend().Lose(1));
+  CHECK(redraws == 1);
+  CHECK(pool.Generation() == 1);
+  CHECK(pool.GetStats().devices_lost == 1);
+
+  // Nothing is created until something asks for it.
+  CHECK(pool.GetStats().devices_created == 1);
+  auto surface = pool.CreateDrawingSurface(1, {16, 16});
+  CHECK(surface.device == 2);
+  CHECK(pool.GetStats().devices_created == 2);
+  CHECK(pool.Generation() == 1);
+
+  // The lost device's handler went with it.
+  CHECK(!pool.GetBackend().Lose(1));
+  CHECK(redraws == 1);
+}
+
+TEST(GraphicsDevicePoolStartsOverForAnotherCompositor) {
+  int redraws = 0;
+  Pool pool{[&]() { ++redraws; }};
+
+  pool.CreateDrawingSurface(1, {16, 16});
+  auto surface = pool.CreateDrawingSurface(2, {16, 16});
+  CHECK(surface.device == 2);
+  CHECK(pool.Generation() == 1);
+  CHECK(pool.GetStats().devices_lost == 0);
+  CHECK(!pool.GetBackend().Lose(1));
+  CHECK(redraws == 0);
+
+  // Back to the first compositor is another change, not the old device again.
+  CHECK(pool.GetDevices(1).id == 3);
+  CHECK(pool.Generation() == 2);
+}
@@ -0,0 +1,65 @@
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "hit_test_index.hpp"
+
+namespace {
+
+constexpr int kPoints = 1'000'000;
+
+// A row of caption-sized elements, the shape a titlebar with many tabs and buttons has.
+std::vector<Rect> MakeRow(size_t count) {
+  std::vector<Rect> bounds;
+  for (size_t i = 0; i < count; ++i) {
+    auto left = static_cast<int32_t>(i) * 40;
+    bounds.push_back(Rect{left, 0, left + 44, 47});
+  }
+  return bounds;
+}
+
+}  // namespace
+
+BENCHMARK(HitTestIndexVersusLinearScan) {
+  for (size_t count : {10, 100, 1000, 10000}) {
+    auto bounds = MakeRow(count);
+    HitTestIndex index;
+    for (const auto& rect : bounds) {
+      index.Add(rect);
+    }
+
+    std::mt19937 random{1};
+    std::uniform_int_distribution<int32_t> x{0, bounds.back().right};
+    std::uniform_int_distribution<int32_t> y{0, 60};
+    std::vector<Point> points(kPoints);
+    for (auto& pt : points) {
+      pt = Point{x(random), y(random)};
+    }
+
+    benchmark::Stopwatch indexed;
+    size_t indexed_hits = 0;
+    for (const auto& pt : points) {
+      indexed_hits += index.FindTopmost(pt).has_value();
+    }
+    auto indexed_seconds = indexed.Seconds();
+
+    benchmark::Stopwatch linear;
+    size_t linear_hits = 0;
+    for (const auto& pt : points) {
+      for (auto slot = bounds.size(); slot-- > 0;) {
+        if (bounds[slot].Contains(pt)) {
+          ++linear_hits;
+          break;
+        }
+      }
+    }
+    auto linear_seconds = linear.Seconds();
+    benchmark::Consume(indexed_hits + linear_hits);
+
+    std::printf("  %5zu elements: index %7.1f ns/hit test, linear %9.1f ns/hit test\n",
+                count,
+                indexed_seconds * 1e9 / kPoints,
+                linear_seconds * 1e9 / kPoints);
+  }
+}
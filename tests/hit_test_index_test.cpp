@@ -0,0 +1,99 @@
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "hit_test_index.hpp"
+#include "test.hpp"
+
+namespace {
+
+// What ElementSet::FindAtClientPointTopDown did before the index: walk every slot from the top.
+std::optional<HitTestIndex::Slot> FindTopmostLinear(const std::vector<Rect>& bounds,
+                                                    const Point& pt) {
+  for (auto slot = bounds.size(); slot-- > 0;) {
+    if (bounds[slot].Contains(pt)) {
+      return static_cast<HitTestIndex::Slot>(slot);
+    }
+  }
+  return std::nullopt;
+}
+
+// Mostly small rects like caption buttons, some empty ones and some reaching past the origin.
+Rect RandomRect(std::mt19937& random) {
+  std::uniform_int_distribution<int32_t> position{-40, 600};
+  std::uniform_int_distribution<int32_t> size{0, 120};
+  auto left = position(random);
+  auto top = position(random) / 8;
+  return Rect{left, top, left + size(random), top + size(random) / 2};
+}
+
+bool MatchesLinearScan(const HitTestIndex& index,
+                       const std::vector<Rect>& bounds,
+                       std::mt19937& random) {
+  std::uniform_int_distribution<int32_t> x{-50, 750};
+  std::uniform_int_distribution<int32_t> y{-10, 150};
+  for (int i = 0; i < 2000; ++i) {
+    Point pt{x(random), y(random)};
+    if (index.FindTopmost(pt) != FindTopmostLinear(bounds, pt)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(HitTestIndexMatchesLinearScan) {
+  std::mt19937 random{1};
+  for (size_t count : {1, 10, 100, 1000}) {
+    HitTestIndex index;
+    std::vector<Rect> bounds;
+    for (size_t i = 0; i < count; ++i) {
+      bounds.push_back(RandomRect(random));
+      CHECK(index.Add(bounds.back()) == i);
+    }
+    CHECK(MatchesLinearScan(index, bounds, random));
+  }
+}
+
+TEST(HitTestIndexMatchesLinearScanAfterUpdates) {
+  std::mt19937 random{2};
+  HitTestIndex index;
+  std::vector<Rect> bounds;
+  for (int i = 0; i < 200; ++i) {
+    bounds.push_back(RandomRect(random));
+    index.Add(bounds.back());
+  }
+
+  std::uniform_int_distribution<HitTestIndex::Slot> slot{0, 199};
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 0; i < 50; ++i) {
+      auto moved = slot(random);
+      bounds[moved] = RandomRect(random);
+      index.Update(moved, bounds[moved]);
+    }
+    CHECK(MatchesLinearScan(index, bounds, random));
+  }
+}
+
+TEST(HitTestIndexEdges) {
+  HitTestIndex index;
+  index.Add(Rect{0, 0, 100, 40});
+  index.Add(Rect{60, 0, 100, 40});
+
+  // Right and bottom edges are exclusive, like ::PtInRect.
+  CHECK(index.FindTopmost({99, 39}) == 1u);
+  CHECK(index.FindTopmost({59, 0}) == 0u);
+  CHECK(!index.FindTopmost({100, 0}));
+  CHECK(!index.FindTopmost({0, 40}));
+  CHECK(!index.FindTopmost({-1, 0}));
+
+  // An emptied slot is gone from the index, and comes back when it gets bounds again.
+  index.Update(1, Rect{});
+  CHECK(index.FindTopmost({99, 39}) == 0u);
+  index.Update(1, Rect{60, 0, 100, 40});
+  CHECK(index.FindTopmost({99, 39}) == 1u);
+
+  index.Clear();
+  CHECK(!index.FindTopmost({10, 10}));
+}
@@ -0,0 +1,106 @@
+// Replays mouse messages through the portable input path at full speed and reports the
+// throughput and the allocations it cost.
+//
+//   input_replay                       replays a synthesized trace
+//   input_replay TRACE [X Y]           replays a trace written by the app, whose client area
+//                                      was at X,Y on the screen
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "benchmark.hpp"
+#include "input_replay.hpp"
+#include "trace_ring.hpp"
+
+namespace {
+
+constexpr int kMinRounds = 5;
+constexpr uint64_t kMinEvents = 10'000'000;
+
+bool LoadTrace(const char* path, std::vector<TraceRecord>& trace) {
+  TraceFileReader reader;
+  if (!reader.Open(path)) {
+    return false;
+  }
+  TraceRecord record;
+  while (reader.Next(record)) {
+    trace.push_back(record);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<TraceRecord> trace;
+  Point window_origin{0, 0};
+  if (argc > 1) {
+    if (!LoadTrace(argv[1], trace)) {
+      std::fprintf(stderr, "%s: not a trace file\n", argv[1]);
+      return 1;
+    }
+    if (argc > 3) {
+      window_origin = Point{std::atoi(argv[2]), std::atoi(argv[3])};
+    }
+  } else {
+    trace = SynthesizeMouseTrace(1000);
+  }
+  if (trace.empty()) {
+    std::fprintf(stderr, "the trace is empty\n");
+    return 1;
+  }
+
+  InputReplayer replayer{window_origin};
+
+  // One untimed round, so that the queues have grown to their working size before counting.
+  for (const auto& record : trace) {
+    replayer.Replay(record);
+  }
+
+  auto events_before = replayer.GetStats().events;
+  auto allocations_before = test::AllocationCount();
+  benchmark::Stopwatch stopwatch;
+  for (int round = 0;
+       round < kMinRounds || replayer.GetStats().events - events_before < kMinEvents;
+       ++round) {
+    for (const auto& record : trace) {
+      replayer.Replay(record);
+    }
+  }
+  auto seconds = stopwatch.Seconds();
+  auto events = replayer.GetStats().events - events_before;
+  auto allocations = test::AllocationCount() - allocations_before;
+
+  std::printf("%zu messages in the trace, %llu events replayed\n",
+              trace.size(),
+              static_cast<unsigned long long>(events));
+  if (events) {
+    std::printf("%.1f million events/s, %.1f ns/event, %.3f allocations/event\n",
+                events / seconds / 1e6,
+                seconds * 1e9 / events,
+                static_cast<double>(allocations) / events);
+  }
+  std::printf("%llu renderer state updates, %llu leave tracking arms, %llu stale leaves\n",
+              static_cast<unsigned long long>(replayer.StateMachine().GetStats().state_updates),
+              static_cast<unsigned long long>(replayer.LeaveTracker().GetStats().arms),
+              static_cast<unsigned long long>(replayer.GetStats().stale_leaves));
+
+  const auto& recorder = replayer.Recorder().GetStats();
+  auto writes = recorder.Issued() + recorder.Skipped();
+  std::printf("%llu composition writes issued, %llu skipped (%.1f%%), at most %llu per frame\n",
+              static_cast<unsigned long long>(recorder.Issued()),
+              static_cast<unsigned long long>(recorder.Skipped()),
+              writes ? 100.0 * recorder.Skipped() / writes : 0.0,
+              static_cast<unsigned long long>(recorder.max_writes_per_frame));
+  for (size_t i = 0; i < recorder.properties.size(); ++i) {
+    const auto& property = recorder.properties[i];
+    if (property.issued || property.skipped) {
+      std::printf("  %-9s %llu issued, %llu skipped\n",
+                  CompositionPropertyName(static_cast<CompositionProperty>(i)),
+                  static_cast<unsigned long long>(property.issued),
+                  static_cast<unsigned long long>(property.skipped));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "composition_recorder.hpp"
+#include "element_set.hpp"
+#include "frame_scheduler.hpp"
+#include "hit_test_code.hpp"
+#include "mouse_event.hpp"
+#include "mouse_leave_tracker.hpp"
+#include "mouse_state_machine.hpp"
+#include "row_layout.hpp"
+#include "trace_ring.hpp"
+
+// Stands in for an Element and counts what the state machine does to it.
+struct ReplayElement : ElementSetMember {
+  explicit ReplayElement(HitTestCode hit_test) : hit_test{hit_test} {}
+
+  void Bounds(const Rect& bounds) { SetBounds(bounds); }
+
+  void MouseDown(MouseButton, const Point&) { ++downs; }
+  void MouseUp(MouseButton, const Point&) { ++ups; }
+  void MouseClick(MouseButton, const Point&) { ++clicks; }
+  void MouseDoubleClick(MouseButton, const Point&) { ++double_clicks; }
+  void MouseLeave() { ++leaves; }
+
+  // Like a renderer's SetState, through the recorder when there is one.
+  void SetState(RendererState new_state) {
+    if (!recorder) {
+      state = new_state;
+      return;
+    }
+    recorder->Write(this, CompositionProperty::State, new_state, [&]() { state = new_state; });
+  }
+
+  HitTestCode hit_test;
+  CompositionRecorder* recorder = nullptr;
+  RendererState state = RendererState::Normal;
+  uint64_t downs = 0;
+  uint64_t ups = 0;
+  uint64_t clicks = 0;
+  uint64_t double_clicks = 0;
+  uint64_t leaves = 0;
+};
+
+// Stands in for the window's mouse visual, the brushes are told apart by address only.
+struct ReplayMouseVisual {
+  static inline const int kBrush = 0;
+  static inline const int kDownBrush = 0;
+
+  Point offset{0, 0};
+  const void* brush = nullptr;
+};
+
+// Feeds recorded mouse messages down the same path Window::HandleMouseMessage takes: the element
+// lookup, the leave tracker and the state machine, with the drawing states applied through a
+// FrameScheduler that is flushed after every message. The elements are laid out like the
+// caption of a 700 DIP window at 96 DPI.
+//
+// The composition writes the window makes, the element states and the mouse visual's brush and
+// offset, go through a CompositionRecorder, which counts how many of them it skips.
+class InputReplayer {
+ public:
+  static constexpr int32_t kWidth = 700;
+  static constexpr int32_t kCaptionHeight = 47;
+  static constexpr int32_t kButtonWidth = 44;
+
+  struct Stats {
+    uint64_t messages = 0;
+    uint64_t events = 0;
+    uint64_t stale_leaves = 0;
+  };
+
+  // Non-client messages carry screen coordinates, `window_origin` is where the client area was
+  // on the screen when the trace was recorded.
+  explicit InputReplayer(Point window_origin = {0, 0}) : window_origin_{window_origin} {
+    auto& caption = elements_[0];
+    auto& system_menu = elements_[1];
+    auto& minimize = elements_[2];
+    auto& maximize = elements_[3];
+    auto& close = elements_[4];
+    element_set_.Reset({caption, system_menu, minimize, maximize, close});
+    for (auto& element : elements_) {
+      element.recorder = &recorder_;
+    }
+
+    RowLayout layout{kCaptionHeight};
+    layout.Add(RowLayout::Anchor::Fill);
+    layout.Add(RowLayout::Anchor::Left, kButtonWidth);
+    layout.Add(RowLayout::Anchor::Right, kButtonWidth);
+    layout.Add(RowLayout::Anchor::Right, kButtonWidth);
+    layout.Add(RowLayout::Anchor::Right, kButtonWidth);
+    ReplayElement* slots[] = {&caption, &system_menu, &close, &maximize, &minimize};
+    layout.Arrange(Rect{0, 0, kWidth, 500}, 96, [&](RowLayout::Slot slot, const Rect& bounds) {
+      slots[slot]->Bounds(bounds);
+    });
+  }
+
+  InputReplayer(const InputReplayer&) = delete;
+  InputReplayer& operator=(const InputReplayer&) = delete;
+
+  void Replay(const TraceRecord& record) {
+    ++stats_.messages;
+    auto message = record.message;
+    Point point{static_cast<int16_t>(record.lparam & 0xFFFF),
+                static_cast<int16_t>((record.lparam >> 16) & 0xFFFF)};
+
+    if (auto event = MouseEventFromMessage(message, point)) {
+      ++stats_.events;
+      if (event->non_client) {
+        event->point.x -= window_origin_.x;
+        event->point.y -= window_origin_.y;
+      }
+
+      if (event->kind == MouseEventKind::Leave) {
+        if (leave_tracker_.Left(event->non_client)) {
+          Dispatch(nullptr, *event);
+        } else {
+          ++stats_.stale_leaves;
+        }
+      } else {
+        Dispatch(element_set_.FindAtClientPointTopDown(event->point), *event);
+      }
+      if (event->kind == MouseEventKind::Move) {
+        leave_tracker_.Moved(event->non_client);
+      }
+    }
+
+    if (flush_) {
+      auto flush = std::move(flush_);
+      flush_ = nullptr;
+      flush();
+      recorder_.EndFrame();
+    }
+  }
+
+  const Stats& GetStats() const { return stats_; }
+  const std::array<ReplayElement, 5>& Elements() const { return elements_; }
+  const MouseStateMachine<ReplayElement>& StateMachine() const { return state_machine_; }
+  const MouseLeaveTracker& LeaveTracker() const { return leave_tracker_; }
+  const CompositionRecorder& Recorder() const { return recorder_; }
+  const ReplayMouseVisual& MouseVisual() const { return mouse_visual_; }
+
+ private:
+  // The same writes as Window::DispatchMouseEvent.
+  void Dispatch(ReplayElement* element, const MouseEvent& event) {
+    state_machine_.Dispatch(element, event);
+    switch (event.kind) {
+      case MouseEventKind::Move:
+        SetBrush(&ReplayMouseVisual::kBrush);
+        recorder_.Write(&mouse_visual_, CompositionProperty::Offset, event.point,
+                        [&]() { mouse_visual_.offset = event.point; });
+        break;
+      case MouseEventKind::Leave:
+        SetBrush(nullptr);
+        break;
+      case MouseEventKind::Down:
+        SetBrush(&ReplayMouseVisual::kDownBrush);
+        break;
+      case MouseEventKind::Up:
+        SetBrush(&ReplayMouseVisual::kBrush);
+        break;
+      case MouseEventKind::DoubleClick:
+        break;
+    }
+  }
+
+  void SetBrush(const void* brush) {
+    recorder_.Write(&mouse_visual_, CompositionProperty::Brush, brush,
+                    [&]() { mouse_visual_.brush = brush; });
+  }
+
+  Point window_origin_;
+  std::array<ReplayElement, 5> elements_ = {ReplayElement{HitTestCode::Caption},
+                                            ReplayElement{HitTestCode::SystemMenu},
+                                            ReplayElement{HitTestCode::MinimizeButton},
+                                            ReplayElement{HitTestCode::MaximizeButton},
+                                            ReplayElement{HitTestCode::CloseButton}};
+  ElementSet<ReplayElement> element_set_;
+
+  std::function<void()> flush_;
+  FrameScheduler frame_scheduler_{[this](std::function<void()> flush) {
+    flush_ = std::move(flush);
+    return true;
+  }};
+  MouseStateMachine<ReplayElement> state_machine_{
+      [this](ReplayElement& element, RendererState state) {
+        frame_scheduler_.Request(&element, [&element, state]() { element.SetState(state); });
+      }};
+  MouseLeaveTracker leave_tracker_{[](bool) {}};
+  CompositionRecorder recorder_;
+  ReplayMouseVisual mouse_visual_;
+
+  Stats stats_;
+};
+
+// What a user sweeping over the caption of an InputReplayer looks like in non-client messages:
+// moves in from the left, with a click on the caption or one of the buttons here and there, and
+// a leave at the end of every sweep. Timestamps are 8 kHz apart.
+inline std::vector<TraceRecord> SynthesizeMouseTrace(size_t sweeps, uint32_t seed = 1) {
+  using namespace mouse_message;
+  constexpr uint32_t kNcLButtonDown = kLButtonDown - kNcToClientOffset;
+  constexpr uint32_t kNcLButtonUp = kLButtonUp - kNcToClientOffset;
+
+  std::mt19937 random{seed};
+  std::uniform_int_distribution<int32_t> y{0, InputReplayer::kCaptionHeight - 1};
+  std::uniform_int_distribution<int32_t> click{0, 63};
+
+  std::vector<TraceRecord> trace;
+  uint64_t timestamp = 0;
+  auto push = [&](uint32_t message, int32_t x, int32_t y) {
+    auto lparam = static_cast<int64_t>((static_cast<uint32_t>(y) & 0xFFFF) << 16 |
+                                       (static_cast<uint32_t>(x) & 0xFFFF));
+    trace.push_back(TraceRecord{timestamp, message, TraceRecord::kNoHitTest, 0, lparam, 0, 0});
+    timestamp += 125'000;
+  };
+
+  for (size_t sweep = 0; sweep < sweeps; ++sweep) {
+    auto row = y(random);
+    for (int32_t x = 0; x < InputReplayer::kWidth; x += 3) {
+      push(kNcMouseMove, x, row);
+      if (click(random) == 0) {
+        push(kNcLButtonDown, x, row);
+        push(kNcLButtonUp, x, row);
+      }
+    }
+    push(kNcMouseLeave, 0, 0);
+  }
+  return trace;
+}
@@ -0,0 +1,63 @@
+#include <cstdint>
+
+#include "input_replay.hpp"
+#include "test.hpp"
+
+namespace {
+
+const CompositionRecorder::PropertyStats& StatsOf(const InputReplayer& replayer,
+                                                  CompositionProperty property) {
+  return replayer.Recorder().GetStats().properties[static_cast<size_t>(property)];
+}
+
+}  // namespace
+
+TEST(InputReplaySkipsRepeatedMouseVisualWrites) {
+  constexpr size_t kSweeps = 20;
+  auto trace = SynthesizeMouseTrace(kSweeps);
+
+  uint64_t moves = 0;
+  uint64_t clicks = 0;
+  for (const auto& record : trace) {
+    moves += record.message == mouse_message::kNcMouseMove;
+    clicks += record.message == mouse_message::kLButtonDown - mouse_message::kNcToClientOffset;
+  }
+
+  InputReplayer replayer;
+  for (const auto& record : trace) {
+    replayer.Replay(record);
+  }
+  CHECK(replayer.GetStats().stale_leaves == 0);
+  CHECK(replayer.MouseVisual().brush == nullptr);
+
+  // The brush changes on every press and release, and when a sweep enters and leaves.
+  const auto& brush = StatsOf(replayer, CompositionProperty::Brush);
+  CHECK(brush.issued == 2 * clicks + 2 * kSweeps);
+  CHECK(brush.issued + brush.skipped == moves + 2 * clicks + kSweeps);
+
+  // Every move goes somewhere new.
+  const auto& offset = StatsOf(replayer, CompositionProperty::Offset);
+  CHECK(offset.issued == moves);
+  CHECK(offset.skipped == 0);
+
+  const auto& state = StatsOf(replayer, CompositionProperty::State);
+  CHECK(state.issued > 0);
+  CHECK(state.issued + state.skipped <= replayer.StateMachine().GetStats().state_updates);
+
+  // Most of what the mouse visual is told is the brush it already has.
+  CHECK(replayer.Recorder().GetStats().Skipped() > moves / 2);
+}
+
+TEST(InputReplayIssuesTheSameBrushChangesOnEveryPass) {
+  auto trace = SynthesizeMouseTrace(5);
+  InputReplayer replayer;
+  for (const auto& record : trace) {
+    replayer.Replay(record);
+  }
+  auto brush_issued = StatsOf(replayer, CompositionProperty::Brush).issued;
+  for (const auto& record : trace) {
+    replayer.Replay(record);
+  }
+  // The second pass starts from the brush the first one left, so it issues the same changes.
+  CHECK(StatsOf(replayer, CompositionProperty::Brush).issued == 2 * brush_issued);
+}
@@ -0,0 +1,18 @@
+#include <cstdio>
+#include <cstring>
+
+#include "test.hpp"
+
+// Runs every test, or only those whose name contains argv[1].
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : "";
+  for (const auto& test_case : test::Cases()) {
+    if (!std::strstr(test_case.name, filter)) {
+      continue;
+    }
+    auto failures = test::Failures();
+    test_case.run();
+    std::printf("%s %s\n", test::Failures() == failures ? "PASS" : "FAIL", test_case.name);
+  }
+  return test::Failures() == 0 ? 0 : 1;
+}
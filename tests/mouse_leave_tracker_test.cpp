@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <vector>
+
+#include "mouse_leave_tracker.hpp"
+#include "test.hpp"
+
+TEST(MouseLeaveTrackerArmsOncePerEnter) {
+  std::vector<bool> arms;
+  MouseLeaveTracker tracker{[&](bool non_client) { arms.push_back(non_client); }};
+
+  for (int i = 0; i < 10; ++i) {
+    tracker.Moved(false);
+  }
+  CHECK(arms == std::vector<bool>{false});
+
+  CHECK(tracker.Left(false));
+  tracker.Moved(false);
+  tracker.Moved(false);
+  CHECK((arms == std::vector<bool>{false, false}));
+
+  CHECK(tracker.GetStats().moves == 12);
+  CHECK(tracker.GetStats().arms == 2);
+  CHECK(tracker.GetStats().stale_leaves == 0);
+}
+
+TEST(MouseLeaveTrackerRearmsWhenTheAreaChanges) {
+  std::vector<bool> arms;
+  MouseLeaveTracker tracker{[&](bool non_client) { arms.push_back(non_client); }};
+
+  tracker.Moved(true);
+  tracker.Moved(true);
+  tracker.Moved(false);
+  tracker.Moved(false);
+  tracker.Moved(true);
+
+  CHECK((arms == std::vector<bool>{true, false, true}));
+  CHECK(tracker.GetStats().arms == 3);
+}
+
+TEST(MouseLeaveTrackerDropsStaleLeaves) {
+  uint64_t arms = 0;
+  MouseLeaveTracker tracker{[&](bool) { ++arms; }};
+
+  // Moving from the caption into the client area re-arms for the client area. The leave that
+  // Windows then sends for the non-client area is stale, the mouse is still over the window.
+  tracker.Moved(true);
+  tracker.Moved(false);
+  CHECK(!tracker.Left(true));
+  CHECK(tracker.GetStats().stale_leaves == 1);
+
+  // The tracking for the client area is still armed, so its leave goes through once.
+  CHECK(tracker.Left(false));
+  CHECK(!tracker.Left(false));
+  CHECK(tracker.GetStats().stale_leaves == 2);
+
+  // A leave before any move is stale too.
+  MouseLeaveTracker fresh{[](bool) {}};
+  CHECK(!fresh.Left(false));
+  CHECK(!fresh.Left(true));
+
+  CHECK(arms == 2);
+  CHECK(tracker.GetStats().arms == 2);
+}
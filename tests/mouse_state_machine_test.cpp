@@ -0,0 +1,138 @@
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "input_replay.hpp"
+#include "mouse_state_machine.hpp"
+#include "test.hpp"
+
+namespace {
+
+struct FakeElement {
+  void MouseDown(MouseButton, const Point&) { ++downs; }
+  void MouseUp(MouseButton, const Point&) { ++ups; }
+  void MouseClick(MouseButton, const Point&) { ++clicks; }
+  void MouseDoubleClick(MouseButton, const Point&) { ++double_clicks; }
+  void MouseLeave() { ++leaves; }
+
+  RendererState state = RendererState::Normal;
+  int downs = 0;
+  int ups = 0;
+  int clicks = 0;
+  int double_clicks = 0;
+  int leaves = 0;
+};
+
+MouseStateMachine<FakeElement> MakeStateMachine() {
+  return MouseStateMachine<FakeElement>{
+      [](FakeElement& element, RendererState state) { element.state = state; }};
+}
+
+MouseEvent Event(MouseEventKind kind, MouseButton button = MouseButton::Left) {
+  return MouseEvent{kind, button, Point{0, 0}, true};
+}
+
+}  // namespace
+
+TEST(MouseStateMachineClicksOnlyWhereTheButtonWentDown) {
+  FakeElement a;
+  FakeElement b;
+  auto state_machine = MakeStateMachine();
+
+  state_machine.Dispatch(&a, Event(MouseEventKind::Move));
+  CHECK(a.state == RendererState::MouseOver);
+  state_machine.Dispatch(&a, Event(MouseEventKind::Down));
+  CHECK(a.state == RendererState::MouseDown);
+  state_machine.Dispatch(&b, Event(MouseEventKind::Up));
+  CHECK(a.clicks == 0 && b.clicks == 0 && b.ups == 1);
+  CHECK(a.state == RendererState::Normal && b.state == RendererState::MouseOver);
+  CHECK(a.leaves == 1);
+
+  state_machine.Dispatch(&b, Event(MouseEventKind::Down, MouseButton::Right));
+  state_machine.Dispatch(&b, Event(MouseEventKind::Up, MouseButton::Left));
+  CHECK(b.clicks == 0);
+
+  state_machine.Dispatch(&b, Event(MouseEventKind::Down, MouseButton::Right));
+  state_machine.Dispatch(&b, Event(MouseEventKind::Up, MouseButton::Right));
+  CHECK(b.clicks == 1);
+
+  state_machine.Dispatch(&b, Event(MouseEventKind::DoubleClick));
+  CHECK(b.double_clicks == 1);
+
+  state_machine.Dispatch(nullptr, Event(MouseEventKind::Leave));
+  CHECK(b.state == RendererState::Normal && b.leaves == 1);
+}
+
+TEST(MouseStateMachinePressedElementStaysPressedUnderTheMouse) {
+  FakeElement a;
+  FakeElement b;
+  auto state_machine = MakeStateMachine();
+
+  state_machine.Dispatch(&a, Event(MouseEventKind::Down));
+  state_machine.Dispatch(&b, Event(MouseEventKind::Move));
+  CHECK(a.state == RendererState::Normal && b.state == RendererState::MouseOver);
+  state_machine.Dispatch(&a, Event(MouseEventKind::Move));
+  CHECK(a.state == RendererState::MouseDown && b.state == RendererState::Normal);
+}
+
+TEST(InputReplayClicksTheElementsUnderTheMouse) {
+  InputReplayer replayer;
+  for (const auto& record : SynthesizeMouseTrace(50)) {
+    replayer.Replay(record);
+  }
+
+  uint64_t clicks = 0;
+  for (const auto& element : replayer.Elements()) {
+    // Every sweep ends with a leave, so nothing is left hovered or pressed.
+    CHECK(element.state == RendererState::Normal);
+    CHECK(element.downs == element.ups && element.ups == element.clicks);
+    clicks += element.clicks;
+  }
+  CHECK(clicks > 0);
+  CHECK(replayer.Elements()[0].clicks > 0);
+  CHECK(replayer.GetStats().stale_leaves == 0);
+  CHECK(replayer.GetStats().events == replayer.GetStats().messages);
+}
+
+TEST(InputReplayDoesNotAllocatePerEvent) {
+  InputReplayer replayer;
+  auto trace = SynthesizeMouseTrace(20);
+
+  // The first pass grows the scheduler's queues to their working size.
+  for (const auto& record : trace) {
+    replayer.Replay(record);
+  }
+  auto allocations = test::AllocationCount();
+  for (const auto& record : trace) {
+    replayer.Replay(record);
+  }
+  CHECK(test::AllocationCount() == allocations);
+}
+
+TEST(MouseStateMachineUpdatesAtMostTwoElementsPerEvent) {
+  std::vector<FakeElement> elements(1000);
+  auto state_machine = MakeStateMachine();
+
+  uint64_t max_updates = 0;
+  auto dispatch = [&](FakeElement* element, MouseEventKind kind) {
+    auto before = state_machine.GetStats().state_updates;
+    state_machine.Dispatch(element, Event(kind));
+    auto updates = state_machine.GetStats().state_updates - before;
+    max_updates = updates > max_updates ? updates : max_updates;
+    return updates;
+  };
+
+  // Sweeping over every element costs the same per move however many elements there are.
+  for (auto& element : elements) {
+    dispatch(&element, MouseEventKind::Move);
+    CHECK(dispatch(&element, MouseEventKind::Move) == 0);
+  }
+  CHECK(max_updates == 2);
+  CHECK(state_machine.GetStats().state_updates == 2 * elements.size() - 1);
+
+  CHECK(dispatch(&elements[5], MouseEventKind::Down) == 2);
+  CHECK(dispatch(&elements[5], MouseEventKind::Up) == 1);
+  CHECK(dispatch(nullptr, MouseEventKind::Leave) == 1);
+  CHECK(dispatch(nullptr, MouseEventKind::Leave) == 0);
+  CHECK(max_updates == 2);
+  CHECK(state_machine.GetStats().events == 2 * elements.size() + 4);
+}
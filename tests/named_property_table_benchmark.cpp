@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+
+#include "benchmark.hpp"
+#include "named_property_table.hpp"
+
+namespace {
+
+struct Entry {
+  const wchar_t* Name;
+  int index;
+};
+
+constexpr Entry kEntries[] = {
+    {L"BlurAmount", 0}, {L"Optimization", 1}, {L"BorderMode", 2}, {L"Mode", 3},
+    {L"Color", 4},      {L"Opacity", 5},      {L"Amount", 6},     {L"Brightness", 7}};
+
+constexpr NamedPropertyTable kTable{kEntries};
+
+// What GetNamedPropertyMappingImpl did before the table.
+const Entry* FindLinear(const wchar_t* name) {
+  for (const auto& entry : kEntries) {
+    if (named_property::EqualsIgnoreCase(entry.Name, name)) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// Names as the compositor passes them, in whatever case the app wrote them, and some misses.
+const wchar_t* const kLookups[] = {L"Opacity", L"blurAmount", L"BRIGHTNESS", L"Mode",
+                                   L"Color",   L"Amount",     L"Unknown",    L"Saturation"};
+
+template <typename Find>
+void Time(const char* name, Find find) {
+  constexpr int kRounds = 5'000'000;
+  uint64_t found = 0;
+  benchmark::Stopwatch stopwatch;
+  for (int round = 0; round < kRounds; ++round) {
+    for (const auto* lookup : kLookups) {
+      found += find(lookup) != nullptr;
+    }
+  }
+  auto seconds = stopwatch.Seconds();
+  benchmark::Consume(found);
+  std::printf("  %s: %.2f ns per lookup\n",
+              name,
+              seconds * 1e9 / (static_cast<double>(kRounds) * std::size(kLookups)));
+}
+
+}  // namespace
+
+BENCHMARK(NamedPropertyTableLookup) {
+  Time("linear scan", [](const wchar_t* name) { return FindLinear(name); });
+  Time("hash table", [](const wchar_t* name) { return kTable.Find(name); });
+}
@@ -0,0 +1,67 @@
+#include <iterator>
+#include <string>
+
+#include "named_property_table.hpp"
+#include "test.hpp"
+
+namespace {
+
+struct Entry {
+  const wchar_t* Name;
+  int index;
+};
+
+// Property names from a few of the Win2D effects, about as many as the biggest one has.
+constexpr Entry kEntries[] = {
+    {L"BlurAmount", 0},   {L"Optimization", 1}, {L"BorderMode", 2},   {L"Mode", 3},
+    {L"Color", 4},        {L"Opacity", 5},      {L"Amount", 6},       {L"Brightness", 7},
+    {L"Contrast", 8},     {L"Saturation", 9},   {L"Angle", 10},       {L"Sharpness", 11},
+    {L"Threshold", 12},   {L"Exposure", 13},    {L"Temperature", 14}, {L"Tint", 15},
+    {L"ClampOutput", 16}, {L"AlphaMode", 17},   {L"Source", 18},      {L"Foreground", 19},
+    {L"Background", 20},  {L"Matrix", 21},      {L"Radius", 22},      {L"Offset", 23}};
+
+constexpr NamedPropertyTable kTable{kEntries};
+
+std::wstring ToUpper(const wchar_t* name) {
+  std::wstring upper = name;
+  for (auto& c : upper) {
+    if (c >= L'a' && c <= L'z') {
+      c = static_cast<wchar_t>(c - L'a' + L'A');
+    }
+  }
+  return upper;
+}
+
+}  // namespace
+
+TEST(NamedPropertyTableFindsEveryName) {
+  for (const auto& entry : kEntries) {
+    const auto* found = kTable.Find(entry.Name);
+    CHECK(found == &entry);
+    CHECK(kTable.Find(ToUpper(entry.Name).c_str()) == &entry);
+  }
+  CHECK(kTable.Find(L"blurAMOUNT") == &kEntries[0]);
+}
+
+TEST(NamedPropertyTableMissesUnknownNames) {
+  // Prefixes, extensions and near misses of names in the table, and names that are not.
+  const wchar_t* kMisses[] = {L"",         L"Blur",      L"BlurAmounts", L"Mod",
+                              L"Modes",    L"Colour",    L"Opacity ",    L" Opacity",
+                              L"Opacity_", L"Brightnes", L"Tinted",      L"Radiu",
+                              L"Offset2",  L"Width",     L"Height",      L"Saturation\u00C9"};
+  for (const auto* name : kMisses) {
+    CHECK(kTable.Find(name) == nullptr);
+  }
+
+  // Only ASCII letters are folded.
+  CHECK(!named_property::EqualsIgnoreCase(L"\u00E9", L"\u00C9"));
+}
+
+TEST(NamedPropertyTableGivesEveryNameASlot) {
+  static_assert(decltype(kTable)::kSlots == 64, "twice the entries, rounded up to a power of two");
+  for (size_t i = 0; i < std::size(kEntries); ++i) {
+    for (size_t j = i + 1; j < std::size(kEntries); ++j) {
+      CHECK(kTable.Find(kEntries[i].Name) != kTable.Find(kEntries[j].Name));
+    }
+  }
+}
@@ -0,0 +1,127 @@
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "benchmark.hpp"
+
+// The state fan-out of a caption button, background plus two glyphs, with the compositor calls
+// replaced by a counter. WindowsProject1.cpp needs WinRT, so the two shapes are rebuilt here:
+// the linked list of virtual children that ContainerRenderer was, and the tuple that
+// StaticContainerRenderer is.
+namespace {
+
+enum class State { Normal, MouseOver, MouseDown };
+
+class Renderer {
+ public:
+  virtual ~Renderer() = default;
+  virtual void SetState(State) {}
+
+  Renderer* next_sibling = nullptr;
+};
+
+class Background final : public Renderer {
+ public:
+  void SetState(State state) final { color_writes += state != State::Normal; }
+
+  uint64_t color_writes = 0;
+};
+
+class Sprite final : public Renderer {
+ public:
+  void SetState(State state) final { visible_writes += state == State::MouseDown; }
+
+  uint64_t visible_writes = 0;
+};
+
+class VirtualContainer final : public Renderer {
+ public:
+  void Add(Renderer& renderer) {
+    (last_ ? last_->next_sibling : first_) = &renderer;
+    last_ = &renderer;
+  }
+
+  void SetState(State state) final {
+    for (auto renderer = first_; renderer; renderer = renderer->next_sibling) {
+      std::invoke(&Renderer::SetState, renderer, state);
+    }
+  }
+
+ private:
+  Renderer* first_ = nullptr;
+  Renderer* last_ = nullptr;
+};
+
+template <typename... Children>
+class StaticContainer final : public Renderer {
+ public:
+  void SetState(State state) final {
+    std::apply([state](auto&... children) { (children.SetState(state), ...); }, children_);
+  }
+
+  template <size_t Index>
+  auto& Get() {
+    return std::get<Index>(children_);
+  }
+
+ private:
+  std::tuple<Children...> children_;
+};
+
+constexpr int kButtons = 3;
+constexpr int kUpdates = 100'000'000;
+
+template <typename Buttons, typename Count>
+void Run(const char* name, Buttons& buttons, Count&& count) {
+  benchmark::Stopwatch stopwatch;
+  for (int i = 0; i < kUpdates; ++i) {
+    buttons[i % kButtons]->SetState(static_cast<State>(i % 3));
+  }
+  auto seconds = stopwatch.Seconds();
+  benchmark::Consume(count());
+  std::printf("  %s: %.2f ns per button state change\n", name, seconds * 1e9 / kUpdates);
+}
+
+}  // namespace
+
+BENCHMARK(RendererStateFanOut) {
+  // Heap-allocated children linked through the base class, as the arena laid them out.
+  std::vector<std::unique_ptr<Renderer>> children;
+  VirtualContainer virtual_buttons[kButtons];
+  Renderer* virtual_roots[kButtons];
+  for (int b = 0; b < kButtons; ++b) {
+    children.push_back(std::make_unique<Background>());
+    children.push_back(std::make_unique<Sprite>());
+    children.push_back(std::make_unique<Sprite>());
+    for (auto i = children.size() - 3; i < children.size(); ++i) {
+      virtual_buttons[b].Add(*children[i]);
+    }
+    virtual_roots[b] = &virtual_buttons[b];
+  }
+  Run("virtual children", virtual_roots, [&]() {
+    uint64_t writes = 0;
+    for (const auto& child : children) {
+      if (auto background = dynamic_cast<Background*>(child.get())) {
+        writes += background->color_writes;
+      }
+    }
+    return writes;
+  });
+
+  // The button itself is still reached through one virtual call, like Element does.
+  StaticContainer<Background, Sprite, Sprite> static_buttons[kButtons];
+  Renderer* static_roots[kButtons];
+  for (int b = 0; b < kButtons; ++b) {
+    static_roots[b] = &static_buttons[b];
+  }
+  Run("static children", static_roots, [&]() {
+    uint64_t writes = 0;
+    for (auto& button : static_buttons) {
+      writes += button.Get<0>().color_writes + button.Get<1>().visible_writes;
+    }
+    return writes;
+  });
+}
@@ -0,0 +1,36 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "benchmark.hpp"
+#include "row_layout.hpp"
+
+// A live resize: the user drags the window edge for ten seconds and every 240 Hz frame arranges
+// the caption row at a new width. Reports what a frame costs and how many bounds it writes.
+BENCHMARK(RowLayoutLiveResize) {
+  constexpr int kFrames = 240 * 10;
+  constexpr int kRepeats = 1'000;
+
+  RowLayout layout{47};
+  layout.Add(RowLayout::Anchor::Fill);
+  layout.Add(RowLayout::Anchor::Left, 44);
+  layout.Add(RowLayout::Anchor::Right, 44);
+  layout.Add(RowLayout::Anchor::Right, 44);
+  layout.Add(RowLayout::Anchor::Right, 44);
+
+  uint64_t writes = 0;
+  benchmark::Stopwatch stopwatch;
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    for (int frame = 0; frame < kFrames; ++frame) {
+      // Back and forth between 800 and 1600 pixels, two pixels a frame.
+      auto width = 800 + (frame * 2) % 800;
+      writes += layout.Arrange(Rect{0, 0, width, 900}, 144, [](RowLayout::Slot, const Rect&) {});
+    }
+  }
+  auto seconds = stopwatch.Seconds();
+  benchmark::Consume(writes);
+
+  auto frames = static_cast<double>(kFrames) * kRepeats;
+  std::printf("  %.1f ns per frame, %.2f of 5 bounds written per frame\n",
+              seconds * 1e9 / frames,
+              writes / frames);
+}
@@ -0,0 +1,120 @@
+#include <cstdint>
+#include <vector>
+
+#include "row_layout.hpp"
+#include "test.hpp"
+
+namespace {
+
+constexpr int32_t kCaptionHeight = 47;
+constexpr int32_t kButtonWidth = 44;
+
+// ::MulDiv for the non-negative values a layout sees, rounding halves up.
+int32_t MulDiv(int32_t value, uint32_t dpi) {
+  return static_cast<int32_t>((static_cast<int64_t>(value) * dpi + 48) / 96);
+}
+
+// The caption, system menu, close, maximize and minimize rects, as the hand-written
+// LayoutElements computed them before RowLayout.
+std::vector<Rect> BaselineLayout(const Rect& client, uint32_t dpi) {
+  int32_t button_height = MulDiv(kCaptionHeight, dpi);
+  int32_t button_width = MulDiv(kButtonWidth, dpi);
+
+  Rect top = client;
+  top.bottom = button_height;
+
+  Rect icon = top;
+  icon.right = top.left + button_width;
+
+  Rect close = top;
+  close.left = top.right - button_width;
+
+  Rect maximize = top;
+  maximize.left = close.left - button_width;
+  maximize.right = close.left;
+
+  Rect minimize = top;
+  minimize.left = maximize.left - button_width;
+  minimize.right = maximize.left;
+
+  return {top, icon, close, maximize, minimize};
+}
+
+// The caption layout the window sets up, in the same order as BaselineLayout.
+RowLayout CaptionLayout() {
+  RowLayout layout{kCaptionHeight};
+  layout.Add(RowLayout::Anchor::Fill);
+  layout.Add(RowLayout::Anchor::Left, kButtonWidth);
+  layout.Add(RowLayout::Anchor::Right, kButtonWidth);
+  layout.Add(RowLayout::Anchor::Right, kButtonWidth);
+  layout.Add(RowLayout::Anchor::Right, kButtonWidth);
+  return layout;
+}
+
+std::vector<RowLayout::Slot> Arrange(RowLayout& layout, const Rect& container, uint32_t dpi) {
+  std::vector<RowLayout::Slot> changed;
+  auto count = layout.Arrange(
+      container, dpi, [&](RowLayout::Slot slot, const Rect&) { changed.push_back(slot); });
+  CHECK(count == changed.size());
+  return changed;
+}
+
+}  // namespace
+
+TEST(RowLayoutMatchesTheBaseline) {
+  for (uint32_t dpi : {96u, 120u, 144u, 192u}) {
+    for (int32_t width : {0, 100, 500, 1280, 1921}) {
+      auto layout = CaptionLayout();
+      Rect client{0, 0, width, 800};
+      CHECK(Arrange(layout, client, dpi).size() == 5);
+
+      auto expected = BaselineLayout(client, dpi);
+      for (RowLayout::Slot slot = 0; slot < expected.size(); ++slot) {
+        CHECK(layout.Bounds(slot) == expected[slot]);
+      }
+    }
+  }
+}
+
+TEST(RowLayoutArrangingAgainReportsNothing) {
+  auto layout = CaptionLayout();
+  Rect client{0, 0, 1280, 800};
+  CHECK(Arrange(layout, client, 144).size() == 5);
+  CHECK(Arrange(layout, client, 144).empty());
+
+  // Only the row counts, the height of the client area does not move anything.
+  CHECK(Arrange(layout, Rect{0, 0, 1280, 600}, 144).empty());
+}
+
+TEST(RowLayoutReportsOnlyMovedSlots) {
+  auto layout = CaptionLayout();
+  Arrange(layout, Rect{0, 0, 1280, 800}, 96);
+
+  // Wider: the background and the right-anchored buttons move, the system menu stays.
+  CHECK((Arrange(layout, Rect{0, 0, 1300, 800}, 96) == std::vector<RowLayout::Slot>{0, 2, 3, 4}));
+
+  // A new DPI resizes everything.
+  CHECK(Arrange(layout, Rect{0, 0, 1300, 800}, 144).size() == 5);
+
+  // Invalidate reports everything again, even though nothing moved.
+  layout.Invalidate();
+  CHECK(Arrange(layout, Rect{0, 0, 1300, 800}, 144).size() == 5);
+}
+
+TEST(RowLayoutSharesStretchSpace) {
+  RowLayout layout{10};
+  layout.Add(RowLayout::Anchor::Left, 10);
+  auto first = layout.Add(RowLayout::Anchor::Stretch);
+  auto second = layout.Add(RowLayout::Anchor::Stretch);
+  layout.Add(RowLayout::Anchor::Right, 10);
+
+  // 81 pixels between the fixed slots, the first stretch slot gets the odd one.
+  Arrange(layout, Rect{0, 0, 101, 50}, 96);
+  CHECK((layout.Bounds(first) == Rect{10, 0, 51, 10}));
+  CHECK((layout.Bounds(second) == Rect{51, 0, 91, 10}));
+
+  // Narrower than the fixed slots: stretch slots collapse rather than go negative.
+  Arrange(layout, Rect{0, 0, 15, 50}, 96);
+  CHECK(layout.Bounds(first).Width() == 0);
+  CHECK(layout.Bounds(second).Width() == 0);
+}
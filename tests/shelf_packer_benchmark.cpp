@@ -0,0 +1,53 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "shelf_packer.hpp"
+
+BENCHMARK(ShelfPackerDensity) {
+  // Square glyph cells as GlyphCache makes them: 16 DIPs at the scale plus a pixel of padding.
+  for (float scale : {1.0f, 1.5f, 2.0f, 3.0f}) {
+    auto cell = static_cast<int32_t>(std::ceil(16 * scale)) + 2;
+    ShelfPacker packer{256, 256};
+    size_t cells = 0;
+    while (packer.Insert(cell, cell)) {
+      ++cells;
+    }
+    std::printf("  %.1fx: %zu cells of %dpx per 256px page, %.1f%% occupied\n",
+                scale,
+                cells,
+                cell,
+                packer.Occupancy() * 100);
+  }
+}
+
+BENCHMARK(ShelfPackerInsertRemove) {
+  constexpr int kOperations = 10'000'000;
+  std::mt19937 random{1};
+  std::uniform_int_distribution<int32_t> cell{18, 52};
+
+  ShelfPacker packer{1024, 1024};
+  std::vector<Rect> live;
+  size_t failed = 0;
+  benchmark::Stopwatch stopwatch;
+  for (int i = 0; i < kOperations; ++i) {
+    // Keeps the page about half full, evicting the oldest cell once it is.
+    if (live.size() < 500) {
+      auto size = cell(random);
+      if (auto rect = packer.Insert(size, size)) {
+        live.push_back(*rect);
+      } else {
+        ++failed;
+      }
+    } else {
+      packer.Remove(live.front());
+      live.erase(live.begin());
+    }
+  }
+  auto seconds = stopwatch.Seconds();
+  benchmark::Consume(failed);
+  std::printf("  %.1f ns per insert or remove, %zu inserts did not fit\n",
+              seconds * 1e9 / kOperations,
+              failed);
+}
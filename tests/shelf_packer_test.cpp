@@ -0,0 +1,97 @@
+#include <random>
+#include <vector>
+
+#include "shelf_packer.hpp"
+#include "test.hpp"
+
+namespace {
+
+bool Overlap(const Rect& a, const Rect& b) {
+  return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+bool NoneOverlap(const std::vector<Rect>& rects) {
+  for (size_t i = 0; i < rects.size(); ++i) {
+    for (size_t j = i + 1; j < rects.size(); ++j) {
+      if (Overlap(rects[i], rects[j])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool InsidePage(const std::vector<Rect>& rects, int32_t size) {
+  for (const auto& rect : rects) {
+    if (rect.left < 0 || rect.top < 0 || rect.right > size || rect.bottom > size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t Area(const std::vector<Rect>& rects) {
+  int64_t area = 0;
+  for (const auto& rect : rects) {
+    area += static_cast<int64_t>(rect.Width()) * rect.Height();
+  }
+  return area;
+}
+
+}  // namespace
+
+TEST(ShelfPackerRectsDoNotOverlap) {
+  constexpr int32_t kSize = 256;
+  std::mt19937 random{1};
+  // Glyph cells at a handful of scales, plus the odd bigger one.
+  std::uniform_int_distribution<int32_t> cell{10, 52};
+  std::uniform_int_distribution<int> action{0, 2};
+
+  ShelfPacker packer{kSize, kSize};
+  std::vector<Rect> live;
+  for (int i = 0; i < 5000; ++i) {
+    if (action(random) != 0 || live.empty()) {
+      auto width = cell(random);
+      auto height = cell(random);
+      if (auto rect = packer.Insert(width, height)) {
+        CHECK(rect->Width() == width && rect->Height() == height);
+        live.push_back(*rect);
+      }
+    } else {
+      std::uniform_int_distribution<size_t> pick{0, live.size() - 1};
+      auto index = pick(random);
+      packer.Remove(live[index]);
+      live.erase(live.begin() + static_cast<ptrdiff_t>(index));
+    }
+
+    if (i % 50 == 0) {
+      CHECK(NoneOverlap(live));
+      CHECK(InsidePage(live, kSize));
+      CHECK(packer.Occupancy() == static_cast<double>(Area(live)) / (kSize * kSize));
+    }
+  }
+  CHECK(NoneOverlap(live));
+
+  for (const auto& rect : live) {
+    packer.Remove(rect);
+  }
+  CHECK(packer.Empty());
+}
+
+TEST(ShelfPackerReusesFreedSpace) {
+  ShelfPacker packer{100, 40};
+  auto a = packer.Insert(40, 20);
+  auto b = packer.Insert(40, 20);
+  auto c = packer.Insert(40, 20);
+  CHECK(a && b && c);
+  CHECK(c->top == 20);
+  CHECK(packer.Insert(40, 20));
+  CHECK(!packer.Insert(40, 20));
+
+  packer.Remove(*a);
+  auto d = packer.Insert(30, 20);
+  CHECK(d && d->left == a->left && d->top == a->top);
+
+  CHECK(!packer.Insert(0, 10));
+  CHECK(!packer.Insert(101, 10));
+}
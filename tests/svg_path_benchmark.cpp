@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "caption_glyphs.hpp"
+#include "svg_path.hpp"
+
+namespace {
+
+// What a runtime parser usually looks like: strtod for the numbers, std::sin and std::cos for
+// the arcs, and a vector per contour. It stands in for the parsing the glyphs no longer do.
+class ReferenceParser {
+ public:
+  using Contours = std::vector<std::vector<svg::Vec2>>;
+
+  static Contours Parse(const char* data) {
+    ReferenceParser parser{data};
+    parser.Run();
+    return std::move(parser.contours_);
+  }
+
+ private:
+  static constexpr int kSegments = 8;
+  static constexpr double kPi = 3.14159265358979323846;
+
+  explicit ReferenceParser(const char* data) : data_{data} {}
+
+  void SkipSeparators() {
+    while (std::isspace(static_cast<unsigned char>(*data_)) || *data_ == ',') {
+      ++data_;
+    }
+  }
+
+  bool AtNumber() {
+    SkipSeparators();
+    return std::isdigit(static_cast<unsigned char>(*data_)) || *data_ == '-' || *data_ == '+' ||
+           *data_ == '.';
+  }
+
+  double Number() {
+    SkipSeparators();
+    char* end;
+    double value = std::strtod(data_, &end);
+    data_ = end;
+    return value;
+  }
+
+  bool Flag() {
+    SkipSeparators();
+    return *data_++ == '1';
+  }
+
+  void Point(double x, double y) {
+    if (contours_.empty()) {
+      contours_.emplace_back();
+    }
+    contours_.back().push_back(svg::Vec2{static_cast<float>(x), static_cast<float>(y)});
+    x_ = x;
+    y_ = y;
+  }
+
+  void Cubic(double x1, double y1, double x2, double y2, double x, double y) {
+    double x0 = x_;
+    double y0 = y_;
+    for (int i = 1; i <= kSegments; ++i) {
+      double t = static_cast<double>(i) / kSegments;
+      double u = 1 - t;
+      Point(u * u * u * x0 + 3 * u * u * t * x1 + 3 * u * t * t * x2 + t * t * t * x,
+            u * u * u * y0 + 3 * u * u * t * y1 + 3 * u * t * t * y2 + t * t * t * y);
+    }
+    control_x_ = x2;
+    control_y_ = y2;
+  }
+
+  // Arcs here are never rotated, which keeps the center parameterization short.
+  void Arc(double rx, double ry, bool large_arc, bool sweep, double x, double y) {
+    double dx = (x_ - x) / 2;
+    double dy = (y_ - y) / 2;
+    double lambda = dx * dx / (rx * rx) + dy * dy / (ry * ry);
+    if (lambda > 1) {
+      rx *= std::sqrt(lambda);
+      ry *= std::sqrt(lambda);
+    }
+    double numerator = rx * rx * ry * ry - rx * rx * dy * dy - ry * ry * dx * dx;
+    double coefficient =
+        std::sqrt(std::max(0.0, numerator / (rx * rx * dy * dy + ry * ry * dx * dx)));
+    if (large_arc == sweep) {
+      coefficient = -coefficient;
+    }
+    double cx = coefficient * rx * dy / ry + (x_ + x) / 2;
+    double cy = -coefficient * ry * dx / rx + (y_ + y) / 2;
+    double theta1 = std::atan2((y_ - cy) / ry, (x_ - cx) / rx);
+    double delta = std::atan2((y - cy) / ry, (x - cx) / rx) - theta1;
+    if (sweep && delta < 0) {
+      delta += 2 * kPi;
+    } else if (!sweep && delta > 0) {
+      delta -= 2 * kPi;
+    }
+    for (int i = 1; i < kSegments; ++i) {
+      double theta = theta1 + delta * i / kSegments;
+      Point(cx + rx * std::cos(theta), cy + ry * std::sin(theta));
+    }
+    Point(x, y);
+  }
+
+  void Run() {
+    char command = 0;
+    while (true) {
+      SkipSeparators();
+      if (!*data_) {
+        return;
+      }
+      if (!AtNumber()) {
+        command = *data_++;
+      }
+      bool relative = std::islower(static_cast<unsigned char>(command));
+      double bx = relative ? x_ : 0;
+      double by = relative ? y_ : 0;
+      switch (std::toupper(static_cast<unsigned char>(command))) {
+        case 'M': {
+          double x = bx + Number();
+          double y = by + Number();
+          contours_.emplace_back();
+          start_x_ = x;
+          start_y_ = y;
+          Point(x, y);
+          command = relative ? 'l' : 'L';
+          break;
+        }
+        case 'L': {
+          double x = bx + Number();
+          Point(x, by + Number());
+          break;
+        }
+        case 'H':
+          Point(bx + Number(), y_);
+          break;
+        case 'V':
+          Point(x_, by + Number());
+          break;
+        case 'C': {
+          double v[6];
+          for (auto& value : v) {
+            value = Number();
+          }
+          Cubic(bx + v[0], by + v[1], bx + v[2], by + v[3], bx + v[4], by + v[5]);
+          break;
+        }
+        case 'S': {
+          double v[4];
+          for (auto& value : v) {
+            value = Number();
+          }
+          Cubic(2 * x_ - control_x_, 2 * y_ - control_y_, bx + v[0], by + v[1], bx + v[2],
+                by + v[3]);
+          break;
+        }
+        case 'A': {
+          double rx = Number();
+          double ry = Number();
+          Number();  // Rotation, always 0.
+          bool large_arc = Flag();
+          bool sweep = Flag();
+          double x = bx + Number();
+          Arc(rx, ry, large_arc, sweep, x, by + Number());
+          break;
+        }
+        case 'Z':
+          x_ = start_x_;
+          y_ = start_y_;
+          break;
+        default:
+          return;
+      }
+    }
+  }
+
+  const char* data_;
+  Contours contours_;
+  double x_ = 0;
+  double y_ = 0;
+  double start_x_ = 0;
+  double start_y_ = 0;
+  double control_x_ = 0;
+  double control_y_ = 0;
+};
+
+constexpr const char* kGlyphData[] = {
+    kMaximizeGlyphData, kRestoreGlyphData, kMinimizeGlyphData, kCloseGlyphData};
+
+}  // namespace
+
+// The app parses nothing at runtime, the glyphs are flattened at compile time. This measures what
+// FlattenPath would cost if it did run, next to the reference.
+BENCHMARK(SvgPathParseAndFlatten) {
+  constexpr int kRounds = 200'000;
+  constexpr auto kGlyphs = sizeof(kGlyphData) / sizeof(kGlyphData[0]);
+
+  uint64_t points = 0;
+  benchmark::Stopwatch flatten_stopwatch;
+  for (int i = 0; i < kRounds; ++i) {
+    for (const char* data : kGlyphData) {
+      points += ParseGlyph(data).point_count;
+    }
+  }
+  auto flatten_seconds = flatten_stopwatch.Seconds();
+  benchmark::Consume(points);
+
+  uint64_t reference_points = 0;
+  benchmark::Stopwatch reference_stopwatch;
+  for (int i = 0; i < kRounds; ++i) {
+    for (const char* data : kGlyphData) {
+      for (const auto& contour : ReferenceParser::Parse(data)) {
+        reference_points += contour.size();
+      }
+    }
+  }
+  auto reference_seconds = reference_stopwatch.Seconds();
+  benchmark::Consume(reference_points);
+
+  std::printf("  FlattenPath: %.0f ns per glyph, %.1fM glyphs/s, %zu points per round\n",
+              flatten_seconds * 1e9 / (kRounds * kGlyphs),
+              kRounds * kGlyphs / flatten_seconds / 1e6,
+              static_cast<size_t>(points / kRounds));
+  std::printf("  reference:   %.0f ns per glyph, %.1fM glyphs/s, %zu points per round\n",
+              reference_seconds * 1e9 / (kRounds * kGlyphs),
+              kRounds * kGlyphs / reference_seconds / 1e6,
+              static_cast<size_t>(reference_points / kRounds));
+  std::printf("  baked in at compile time: 0 ns per glyph at runtime\n");
+}
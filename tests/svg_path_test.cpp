@@ -0,0 +1,117 @@
+#include <cmath>
+
+#include "caption_glyphs.hpp"
+#include "svg_path.hpp"
+#include "test.hpp"
+
+namespace {
+
+using Path = svg::FlattenedPath<64, 4>;
+
+Path Flatten(const char* data) {
+  return svg::FlattenPath<64, 4>(data);
+}
+
+bool Near(const svg::Vec2& point, float x, float y) {
+  return std::abs(point.x - x) < 1e-4f && std::abs(point.y - y) < 1e-4f;
+}
+
+bool SamePoints(const Path& a, const Path& b) {
+  if (a.point_count != b.point_count || a.contour_count != b.contour_count) {
+    return false;
+  }
+  for (size_t i = 0; i < a.point_count; ++i) {
+    if (!Near(a.points[i], b.points[i].x, b.points[i].y)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(SvgPathLines) {
+  auto path = Flatten("M0 0H10V10H0Z");
+  CHECK(path.ok);
+  CHECK(path.contour_count == 1);
+  CHECK(path.point_count == 4);
+  CHECK(Near(path.points[0], 0, 0));
+  CHECK(Near(path.points[1], 10, 0));
+  CHECK(Near(path.points[2], 10, 10));
+  CHECK(Near(path.points[3], 0, 10));
+}
+
+TEST(SvgPathRelativeMatchesAbsolute) {
+  CHECK(SamePoints(Flatten("M1 2h10v10h-10z"), Flatten("M1 2H11V12H1Z")));
+  CHECK(SamePoints(Flatten("m1 2l3 4 -1 2z"), Flatten("M1 2L4 6L3 8Z")));
+  CHECK(SamePoints(Flatten("M1 1c1 0 2 1 2 2s1 2 2 2z"), Flatten("M1 1C2 1 3 2 3 3S4 5 5 5Z")));
+  CHECK(SamePoints(Flatten("M2 2a3 3 0 0 1 3 3z"), Flatten("M2 2A3 3 0 0 1 5 5Z")));
+}
+
+TEST(SvgPathImplicitLineTo) {
+  CHECK(SamePoints(Flatten("M0 0 10 0 10 10z"), Flatten("M0 0L10 0L10 10Z")));
+  CHECK(SamePoints(Flatten("m1 1 9 0 0 9z"), Flatten("M1 1L10 1L10 10Z")));
+}
+
+TEST(SvgPathCubicEndsOnItsEndPoint) {
+  auto path = Flatten("M0 0C0 10 10 10 10 0Z");
+  CHECK(path.ok);
+  CHECK(path.point_count > 3);
+  CHECK(Near(path.points[path.point_count - 1], 10, 0));
+  // The curve stays inside the hull of its control points.
+  for (size_t i = 0; i < path.point_count; ++i) {
+    CHECK(path.points[i].x >= 0 && path.points[i].x <= 10);
+    CHECK(path.points[i].y >= 0 && path.points[i].y <= 10);
+  }
+}
+
+TEST(SvgPathArcPointsLieOnTheCircle) {
+  // A quarter circle of radius 10 from (0, 0) to (10, 10), clockwise, centered on (10, 0).
+  auto path = Flatten("M0 0A10 10 0 0 0 10 10L10 0Z");
+  CHECK(path.ok);
+  CHECK(path.point_count > 4);
+  CHECK(Near(path.points[path.point_count - 2], 10, 10));
+  for (size_t i = 0; i + 1 < path.point_count; ++i) {
+    auto dx = path.points[i].x - 10;
+    auto dy = path.points[i].y;
+    CHECK(std::abs(std::sqrt(dx * dx + dy * dy) - 10) < 1e-3f);
+  }
+}
+
+TEST(SvgPathScaledUpArc) {
+  // Radii too small to reach the end point are scaled up until they do, into a half circle.
+  auto path = Flatten("M0 0A1 1 0 0 1 10 0Z");
+  CHECK(path.ok);
+  for (size_t i = 0; i < path.point_count; ++i) {
+    auto dx = path.points[i].x - 5;
+    auto dy = path.points[i].y;
+    CHECK(std::abs(std::sqrt(dx * dx + dy * dy) - 5) < 1e-3f);
+  }
+}
+
+TEST(SvgPathMalformed) {
+  CHECK(!Flatten("M0 0 L").ok);
+  CHECK(!Flatten("0 0").ok);
+  CHECK(!Flatten("M0 0L1 1Z 2 2").ok);
+  CHECK(!Flatten("M0 0Q1 1 2 2").ok);
+}
+
+TEST(SvgPathOverflow) {
+  // Each half circle adds 13 points, more than 64 in all.
+  CHECK(!Flatten("M0 0A5 5 0 0 1 10 0A5 5 0 0 1 0 0A5 5 0 0 1 10 0A5 5 0 0 1 0 0"
+                 "A5 5 0 0 1 10 0A5 5 0 0 1 0 0Z")
+             .ok);
+  CHECK(!Flatten("M0 0H1V1Z M2 0H3V1Z M4 0H5V1Z M6 0H7V1Z M8 0H9V1Z").ok);
+}
+
+TEST(SvgPathCaptionGlyphsStayInTheViewBox) {
+  for (const GlyphPath* glyph : {&MaximizeGlyph, &RestoreGlyph, &MinimizeGlyph, &CloseGlyph}) {
+    CHECK(glyph->ok);
+    CHECK(glyph->contour_count > 0);
+    for (size_t i = 0; i < glyph->point_count; ++i) {
+      const auto& point = glyph->points[i];
+      CHECK(point.x >= 0 && point.x <= kGlyphViewBoxSize);
+      CHECK(point.y >= 0 && point.y <= kGlyphViewBoxSize);
+    }
+  }
+}
@@ -0,0 +1,105 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "benchmark.hpp"
+#include "environment_settings.hpp"
+#include "system_menu.hpp"
+
+namespace {
+
+// Does what IsRTL in WindowsProject1.cpp does, with tables in place of the locale database:
+// turns the UI language into a locale name in a LOCALE_NAME_MAX_LENGTH string, then looks up
+// the reading layout by that name.
+struct FakeLocale {
+  uint16_t lang_id;
+  const wchar_t* name;
+  bool rtl;
+};
+
+constexpr FakeLocale kLocales[] = {
+    {0x0409, L"en-US", false}, {0x0809, L"en-GB", false}, {0x0407, L"de-DE", false},
+    {0x040C, L"fr-FR", false}, {0x0410, L"it-IT", false}, {0x0C0A, L"es-ES", false},
+    {0x0411, L"ja-JP", false}, {0x0412, L"ko-KR", false}, {0x0804, L"zh-CN", false},
+    {0x0419, L"ru-RU", false}, {0x040D, L"he-IL", true},  {0x0401, L"ar-SA", true},
+};
+
+std::wstring FakeLocaleNameFromLangId(uint16_t lang_id) {
+  constexpr size_t kLocaleNameMaxLength = 85;
+  std::wstring result(kLocaleNameMaxLength, L'\0');
+  for (const auto& locale : kLocales) {
+    if (locale.lang_id == lang_id) {
+      auto length = std::wcslen(locale.name);
+      std::wmemcpy(result.data(), locale.name, length);
+      result.resize(length);
+      return result;
+    }
+  }
+  result.clear();
+  return result;
+}
+
+bool FakeIsRtl(uint16_t lang_id) {
+  auto name = FakeLocaleNameFromLangId(lang_id);
+  for (const auto& locale : kLocales) {
+    if (name == locale.name) {
+      return locale.rtl;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+// The part of opening the system menu that happens before TrackPopupMenu: working out its flags
+// and bringing the items up to date. Uncached is how every open went before EnvironmentSettings,
+// which is the same as invalidating the cache before each one; cached is every open after the
+// first. Only the lookups themselves are faked, so the difference between the two is a lower
+// bound on what the real GetUserDefaultUILanguage and GetLocaleInfoEx calls save.
+BENCHMARK(SystemMenuOpen) {
+  constexpr int kOpens = 1'000'000;
+
+  volatile uint16_t lang_id = 0x040D;
+  volatile bool menu_drop_right_aligned = false;
+  EnvironmentSettings settings{[&]() { return FakeIsRtl(lang_id); },
+                               [&]() { return menu_drop_right_aligned; }};
+  uint64_t menu_calls = 0;
+  SystemMenuStateApplier applier{[&](SystemMenuCommand, bool) { ++menu_calls; },
+                                 [&](SystemMenuCommand) { ++menu_calls; }};
+
+  for (bool cached : {false, true}) {
+    uint64_t flags = 0;
+    benchmark::Stopwatch flags_stopwatch;
+    for (int i = 0; i < kOpens; ++i) {
+      if (!cached) {
+        settings.Invalidate();
+      }
+      auto popup = GetSystemMenuPopupFlags(settings, i & 1);
+      flags += popup.layout_rtl + popup.right_button + popup.right_align;
+    }
+    auto flags_seconds = flags_stopwatch.Seconds();
+
+    benchmark::Stopwatch open_stopwatch;
+    for (int i = 0; i < kOpens; ++i) {
+      if (!cached) {
+        settings.Invalidate();
+      }
+      auto popup = GetSystemMenuPopupFlags(settings, i & 1);
+      flags += popup.layout_rtl + popup.right_button + popup.right_align;
+      // Alternately from the caption and the icon of a restored window.
+      applier.Apply(GetSystemMenuState(false, false, i & 2));
+    }
+    auto open_seconds = open_stopwatch.Seconds();
+    benchmark::Consume(flags + menu_calls);
+
+    std::printf("  %-9s flags %.1f ns, flags and menu items %.1f ns per open\n",
+                cached ? "cached:" : "uncached:",
+                flags_seconds * 1e9 / kOpens,
+                open_seconds * 1e9 / kOpens);
+  }
+  const auto& stats = settings.GetStats();
+  std::printf("  %llu lookups, %llu fetches\n",
+              static_cast<unsigned long long>(stats.lookups),
+              static_cast<unsigned long long>(stats.fetches));
+}
@@ -0,0 +1,188 @@
+#include <cstdint>
+#include <stdexcept>
+
+#include "system_menu.hpp"
+#include "test.hpp"
+
+namespace {
+
+// Stands in for a menu: which items are enabled, which one is the default, and how many calls
+// it took to get there.
+struct FakeMenu {
+  bool Enabled(SystemMenuCommand command) const {
+    for (size_t i = 0; i < kSystemMenuToggledCommands.size(); ++i) {
+      if (kSystemMenuToggledCommands[i] == command) {
+        return (enabled >> i) & 1;
+      }
+    }
+    return false;
+  }
+
+  bool Matches(const SystemMenuState& state) const {
+    return enabled == state.enabled && default_command == state.default_command;
+  }
+
+  uint8_t enabled = 0;
+  SystemMenuCommand default_command = SystemMenuCommand::Close;
+  uint64_t calls = 0;
+};
+
+SystemMenuStateApplier MakeApplier(FakeMenu& menu) {
+  return SystemMenuStateApplier{
+      [&menu](SystemMenuCommand command, bool enabled) {
+        for (size_t i = 0; i < kSystemMenuToggledCommands.size(); ++i) {
+          if (kSystemMenuToggledCommands[i] == command) {
+            auto bit = static_cast<uint8_t>(1u << i);
+            menu.enabled = static_cast<uint8_t>(enabled ? menu.enabled | bit : menu.enabled & ~bit);
+          }
+        }
+        ++menu.calls;
+      },
+      [&menu](SystemMenuCommand command) {
+        menu.default_command = command;
+        ++menu.calls;
+      }};
+}
+
+}  // namespace
+
+TEST(SystemMenuStateApplierSetsEveryItemFirst) {
+  FakeMenu menu;
+  auto applier = MakeApplier(menu);
+
+  auto restored = GetSystemMenuState(false, false, true);
+  applier.Apply(restored);
+  CHECK(menu.Matches(restored));
+  CHECK(menu.Enabled(SystemMenuCommand::Maximize));
+  CHECK(!menu.Enabled(SystemMenuCommand::Restore));
+  CHECK(menu.calls == 1 + kSystemMenuToggledCommands.size());
+  CHECK(applier.GetStats().calls == menu.calls);
+}
+
+TEST(SystemMenuStateApplierMakesNoCallsForTheSameState) {
+  FakeMenu menu;
+  auto applier = MakeApplier(menu);
+
+  auto state = GetSystemMenuState(true, false, false);
+  applier.Apply(state);
+  auto calls = menu.calls;
+  applier.Apply(state);
+  applier.Apply(state);
+
+  CHECK(menu.calls == calls);
+  CHECK(applier.GetStats().applies == 3);
+  CHECK(applier.GetStats().calls == calls);
+}
+
+TEST(SystemMenuStateApplierOnlyTouchesChangedItems) {
+  FakeMenu menu;
+  auto applier = MakeApplier(menu);
+
+  // Restored, then maximized: Restore, Size, Move and Maximize flip, the caption default
+  // changes from Maximize to Restore.
+  applier.Apply(GetSystemMenuState(false, false, true));
+  auto calls = menu.calls;
+  applier.Apply(GetSystemMenuState(true, false, true));
+  CHECK(menu.Matches(GetSystemMenuState(true, false, true)));
+  CHECK(menu.calls - calls == 5);
+
+  // Opened from the system menu icon instead: only the default changes.
+  calls = menu.calls;
+  applier.Apply(GetSystemMenuState(true, false, false));
+  CHECK(menu.Matches(GetSystemMenuState(true, false, false)));
+  CHECK(menu.calls - calls == 1);
+
+  // Maximized to minimized from the icon: Size and Move stay disabled, Restore stays enabled,
+  // Minimize is disabled and Maximize enabled.
+  calls = menu.calls;
+  applier.Apply(GetSystemMenuState(false, true, false));
+  CHECK(menu.Matches(GetSystemMenuState(false, true, false)));
+  CHECK(menu.calls - calls == 2);
+
+  CHECK(applier.GetStats().calls == menu.calls);
+}
+
+TEST(SystemMenuStateApplierReachesEveryStateFromEveryOther) {
+  for (size_t from = 0; from < 8; ++from) {
+    for (size_t to = 0; to < 8; ++to) {
+      auto from_state = GetSystemMenuState(from & 1, from & 2, from & 4);
+      auto to_state = GetSystemMenuState(to & 1, to & 2, to & 4);
+      FakeMenu menu;
+      auto applier = MakeApplier(menu);
+      applier.Apply(from_state);
+      auto calls = menu.calls;
+      applier.Apply(to_state);
+      CHECK(menu.Matches(to_state));
+
+      // One call per item that differs.
+      uint64_t expected = from_state.default_command != to_state.default_command;
+      for (size_t i = 0; i < kSystemMenuToggledCommands.size(); ++i) {
+        expected += from_state.Enabled(i) != to_state.Enabled(i);
+      }
+      CHECK(menu.calls - calls == expected);
+    }
+  }
+}
+
+TEST(SystemMenuStateApplierSetsEveryItemAfterForget) {
+  FakeMenu menu;
+  auto applier = MakeApplier(menu);
+
+  auto state = GetSystemMenuState(false, false, false);
+  applier.Apply(state);
+  applier.Forget();
+  auto calls = menu.calls;
+  applier.Apply(state);
+  CHECK(menu.calls - calls == 1 + kSystemMenuToggledCommands.size());
+}
+
+TEST(SystemMenuStateApplierForgetsAfterAThrow) {
+  FakeMenu menu;
+  bool fail = true;
+  SystemMenuStateApplier applier{
+      [&](SystemMenuCommand, bool) { ++menu.calls; },
+      [&](SystemMenuCommand) {
+        if (fail) {
+          throw std::runtime_error{"menu is gone"};
+        }
+      }};
+
+  auto state = GetSystemMenuState(false, false, false);
+  bool threw = false;
+  try {
+    applier.Apply(state);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+
+  // Nothing is known about the menu, so every item is set again.
+  fail = false;
+  applier.Apply(state);
+  CHECK(menu.calls == kSystemMenuToggledCommands.size());
+}
+
+TEST(SystemMenuPopupFlagsComeFromTheSettingsCache) {
+  int fetches = 0;
+  bool rtl = true;
+  EnvironmentSettings settings{[&]() {
+                                 ++fetches;
+                                 return rtl;
+                               },
+                               [&]() {
+                                 ++fetches;
+                                 return true;
+                               }};
+
+  auto flags = GetSystemMenuPopupFlags(settings, false);
+  CHECK(flags.layout_rtl && !flags.right_button && flags.right_align);
+  CHECK(GetSystemMenuPopupFlags(settings, true).right_button);
+  CHECK(fetches == 2);
+
+  // A new UI language only shows after the broadcast.
+  rtl = false;
+  CHECK(GetSystemMenuPopupFlags(settings, false).layout_rtl);
+  settings.Invalidate();
+  CHECK(!GetSystemMenuPopupFlags(settings, false).layout_rtl);
+  CHECK(fetches == 4);
+}
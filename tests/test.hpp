@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Just enough of a test framework for the portable headers. TEST registers a function, CHECK
+// reports a failed condition and carries on, so that one run shows every failure.
+namespace test {
+
+struct Case {
+  const char* name;
+  void (*run)();
+};
+
+inline std::vector<Case>& Cases() {
+  static std::vector<Case> cases;
+  return cases;
+}
+
+inline int& Failures() {
+  static int failures = 0;
+  return failures;
+}
+
+struct Registrar {
+  Registrar(const char* name, void (*run)()) { Cases().push_back(Case{name, run}); }
+};
+
+inline void Fail(const char* file, int line, const char* expression) {
+  std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+  ++Failures();
+}
+
+}  // namespace test
+
+#define TEST(name)                                                  \
+  static void name##Test();                                         \
+  static const test::Registrar name##Registrar{#name, &name##Test}; \
+  static void name##Test()
+
+#define CHECK(condition)                          \
+  do {                                            \
+    if (!(condition)) {                           \
+      test::Fail(__FILE__, __LINE__, #condition); \
+    }                                             \
+  } while (false)
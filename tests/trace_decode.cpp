@@ -0,0 +1,127 @@
+// Prints a trace written by the app as text, one message per line, followed by how often each
+// message occurred.
+//
+//   trace_decode TRACE
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+
+#include "hit_test_code.hpp"
+#include "trace_ring.hpp"
+
+namespace {
+
+// The messages WndProc traces, so this does not need <windows.h>.
+const char* MessageName(uint32_t message) {
+  switch (message) {
+    case 0x007B:
+      return "WM_CONTEXTMENU";
+    case 0x0084:
+      return "WM_NCHITTEST";
+    case 0x00A0:
+      return "WM_NCMOUSEMOVE";
+    case 0x00A1:
+      return "WM_NCLBUTTONDOWN";
+    case 0x00A2:
+      return "WM_NCLBUTTONUP";
+    case 0x00A3:
+      return "WM_NCLBUTTONDBLCLK";
+    case 0x00A4:
+      return "WM_NCRBUTTONDOWN";
+    case 0x00A5:
+      return "WM_NCRBUTTONUP";
+    case 0x00A6:
+      return "WM_NCRBUTTONDBLCLK";
+    case 0x0112:
+      return "WM_SYSCOMMAND";
+    case 0x0200:
+      return "WM_MOUSEMOVE";
+    case 0x0201:
+      return "WM_LBUTTONDOWN";
+    case 0x0202:
+      return "WM_LBUTTONUP";
+    case 0x0203:
+      return "WM_LBUTTONDBLCLK";
+    case 0x0204:
+      return "WM_RBUTTONDOWN";
+    case 0x0205:
+      return "WM_RBUTTONUP";
+    case 0x0206:
+      return "WM_RBUTTONDBLCLK";
+    case 0x0211:
+      return "WM_ENTERMENULOOP";
+    case 0x02A2:
+      return "WM_NCMOUSELEAVE";
+    case 0x02A3:
+      return "WM_MOUSELEAVE";
+  }
+  return nullptr;
+}
+
+void PrintRecord(const TraceRecord& record, uint64_t start_ns) {
+  std::printf("%12.3f ms  ", (record.timestamp_ns - start_ns) / 1e6);
+  if (auto name = MessageName(record.message)) {
+    std::printf("%-20s", name);
+  } else {
+    std::printf("0x%04" PRIx32 "%14s", record.message, "");
+  }
+
+  // Mouse positions are packed into lparam like GET_X_LPARAM and GET_Y_LPARAM unpack them.
+  auto x = static_cast<int16_t>(record.lparam & 0xFFFF);
+  auto y = static_cast<int16_t>((record.lparam >> 16) & 0xFFFF);
+  std::printf("  wparam 0x%" PRIx64 "  lparam 0x%" PRIx64 " (%d, %d)",
+              record.wparam,
+              static_cast<uint64_t>(record.lparam),
+              x,
+              y);
+
+  if (record.hit_test != TraceRecord::kNoHitTest) {
+    auto code = static_cast<HitTestCode>(record.hit_test);
+    if (auto name = GetHitTestCodeInfo(code).name) {
+      std::printf("  %s", name);
+    } else {
+      std::printf("  hit test %" PRId32, record.hit_test);
+    }
+  }
+  if (record.element_id) {
+    std::printf("  element %" PRIu32, record.element_id);
+  }
+  std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::fprintf(stderr, "usage: %s TRACE\n", argv[0]);
+    return 2;
+  }
+
+  TraceFileReader reader;
+  if (!reader.Open(argv[1])) {
+    std::fprintf(stderr, "%s: not a trace file\n", argv[1]);
+    return 1;
+  }
+
+  TraceRecord record;
+  uint64_t start_ns = 0;
+  uint64_t end_ns = 0;
+  uint64_t records = 0;
+  std::map<uint32_t, uint64_t> counts;
+  while (reader.Next(record)) {
+    if (records++ == 0) {
+      start_ns = record.timestamp_ns;
+    }
+    end_ns = record.timestamp_ns;
+    ++counts[record.message];
+    PrintRecord(record, start_ns);
+  }
+
+  std::printf("\n%" PRIu64 " records over %.3f s\n", records, (end_ns - start_ns) / 1e9);
+  for (const auto& [message, count] : counts) {
+    auto name = MessageName(message);
+    std::printf("%10" PRIu64 "  %s\n", count, name ? name : "(unknown)");
+  }
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <thread>
+
+#include "benchmark.hpp"
+#include "trace_ring.hpp"
+
+namespace {
+
+constexpr int kMessages = 1'000'000;
+constexpr uint32_t kNcMouseMove = 0x00A0;
+
+}  // namespace
+
+BENCHMARK(TraceLogPushVersusStreamLine) {
+  const char* trace_path = "trace_ring_benchmark.trace";
+  const char* text_path = "trace_ring_benchmark.txt";
+
+  // What WndProc did before the trace log: a formatted line per message. The line goes to a file
+  // here, a console is slower still.
+  {
+    std::ofstream out{text_path};
+    benchmark::Stopwatch stopwatch;
+    for (int i = 0; i < kMessages; ++i) {
+      out << "WM_NCMOUSEMOVE wParam=" << std::hex << 2 << " lParam=" << (i & 0xFFFF) << std::dec
+          << " hit_test=" << 2 << '\n';
+    }
+    out.flush();
+    auto seconds = stopwatch.Seconds();
+    std::printf("  std::ostream line: %.1f ns per message\n", seconds * 1e9 / kMessages);
+  }
+
+  // The UI thread's side of the trace log. Messages come in bursts that fit the ring, with a
+  // pause for the drain thread after each, so that the pushes are stored rather than dropped.
+  {
+    TraceLog log;
+    if (!log.Start(trace_path)) {
+      std::printf("  cannot write %s\n", trace_path);
+      return;
+    }
+    constexpr int kBurst = static_cast<int>(TraceLog::kCapacity / 2);
+    constexpr int kBursts = 200;
+    double seconds = 0;
+    for (int burst = 0; burst < kBursts; ++burst) {
+      benchmark::Stopwatch stopwatch;
+      for (int i = 0; i < kBurst; ++i) {
+        log.Push(kNcMouseMove, 2, i & 0xFFFF, 2, 1);
+      }
+      seconds += stopwatch.Seconds();
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    auto dropped = log.Dropped();
+    log.Stop();
+    std::printf("  TraceLog::Push: %.1f ns per message, %llu of %d records dropped\n",
+                seconds * 1e9 / (kBurst * kBursts),
+                static_cast<unsigned long long>(dropped),
+                kBurst * kBursts);
+  }
+
+  std::remove(trace_path);
+  std::remove(text_path);
+}
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "test.hpp"
+#include "trace_ring.hpp"
+
+namespace {
+
+// ctest runs the tests in the build directory, which is a fine place to leave nothing behind.
+constexpr const char* kTracePath = "trace_ring_test.trace";
+
+}  // namespace
+
+TEST(SpscRingKeepsOrderAndCountsDrops) {
+  SpscRing<int, 4> ring;
+  for (int i = 0; i < 6; ++i) {
+    CHECK(ring.TryPush(i) == (i < 4));
+  }
+  CHECK(ring.Dropped() == 2);
+
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    CHECK(ring.TryPop(value));
+    CHECK(value == i);
+  }
+  CHECK(!ring.TryPop(value));
+
+  // Room again once the consumer caught up, across the wrap of the indices.
+  CHECK(ring.TryPush(7));
+  CHECK(ring.TryPop(value));
+  CHECK(value == 7);
+  CHECK(ring.Dropped() == 2);
+}
+
+TEST(TraceLogRoundTrip) {
+  {
+    TraceLog log;
+    log.Push(1, 2, 3);  // Before Start, dropped silently.
+    CHECK(log.Start(kTracePath));
+    for (uint32_t i = 0; i < 1000; ++i) {
+      log.Push(0x00A1, i, -static_cast<int64_t>(i), 9, i % 5);
+    }
+    log.Push(0x0112, 0xF060, 0);
+    log.Stop();
+    CHECK(log.Dropped() == 0);
+  }
+
+  TraceFileReader reader;
+  CHECK(reader.Open(kTracePath));
+  std::vector<TraceRecord> records;
+  TraceRecord record;
+  while (reader.Next(record)) {
+    records.push_back(record);
+  }
+  reader.Close();
+  std::remove(kTracePath);
+
+  // The ring holds 4096 records, so none were dropped however slow the drain thread was.
+  CHECK(records.size() == 1001);
+  for (size_t i = 0; i < records.size() && i < 1000; ++i) {
+    CHECK(records[i].message == 0x00A1);
+    CHECK(records[i].wparam == i);
+    CHECK(records[i].lparam == -static_cast<int64_t>(i));
+    CHECK(records[i].hit_test == 9);
+    CHECK(records[i].element_id == i % 5);
+    CHECK(i == 0 || records[i].timestamp_ns >= records[i - 1].timestamp_ns);
+  }
+  if (records.size() == 1001) {
+    CHECK(records[1000].message == 0x0112);
+    CHECK(records[1000].hit_test == TraceRecord::kNoHitTest);
+  }
+}
+
+TEST(TraceFileReaderRejectsOtherFiles) {
+  TraceFileReader reader;
+  CHECK(!reader.Open("no such file.trace"));
+
+  {
+    TraceFileHeader header{TraceFileHeader::kMagic, TraceFileHeader::kVersion + 1, 40, 0};
+    std::ofstream file{kTracePath, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  CHECK(!reader.Open(kTracePath));
+  std::remove(kTracePath);
+}
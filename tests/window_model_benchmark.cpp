@@ -0,0 +1,99 @@
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "benchmark.hpp"
+#include "composition_recorder.hpp"
+#include "fake_compositor.hpp"
+#include "fake_window.hpp"
+#include "mouse_event.hpp"
+
+// What a process hosting many titlebar windows spends per window on everything but the HWND and
+// the visual tree: creating the model, laying it out through a drag resize and a DPI change,
+// moving the mouse over it and tearing it down.
+BENCHMARK(WindowModelStress) {
+  constexpr size_t kWindows = 10'000;
+  constexpr int32_t kWidths[] = {700, 720, 760, 840, 1000};
+
+  FakeCompositor compositor;
+  CompositionRecorder recorder;
+  std::vector<std::unique_ptr<FakeWindow>> windows;
+  windows.reserve(kWindows);
+
+  auto allocations = test::AllocationCount();
+  auto bytes = test::AllocatedBytes();
+  benchmark::Stopwatch create_stopwatch;
+  for (size_t i = 0; i < kWindows; ++i) {
+    windows.push_back(std::make_unique<FakeWindow>(compositor, recorder));
+  }
+  auto create_seconds = create_stopwatch.Seconds();
+  allocations = test::AllocationCount() - allocations;
+  bytes = test::AllocatedBytes() - bytes;
+
+  benchmark::Stopwatch layout_stopwatch;
+  size_t moved = 0;
+  for (auto& window : windows) {
+    for (auto width : kWidths) {
+      moved += window->Model().Layout(Rect{0, 0, width, 500}, 96);
+    }
+    moved += window->Model().Layout(Rect{0, 0, kWidths[0], 500}, 144);
+  }
+  auto layout_seconds = layout_stopwatch.Seconds();
+
+  // Across the caption and out again, like a pointer sweeping over the window.
+  benchmark::Stopwatch mouse_stopwatch;
+  uint64_t events = 0;
+  for (auto& window : windows) {
+    auto& model = window->Model();
+    for (int32_t x = 0; x < kWidths[0]; x += 16) {
+      Point point{x, 20};
+      model.StateMachine().Dispatch(
+          model.FindElement(point),
+          MouseEvent{MouseEventKind::Move, MouseButton::Left, point, true});
+      model.LeaveTracker().Moved(true);
+      ++events;
+    }
+    if (model.LeaveTracker().Left(true)) {
+      model.StateMachine().Dispatch(
+          nullptr, MouseEvent{MouseEventKind::Leave, MouseButton::Left, {}, true});
+      ++events;
+    }
+  }
+  auto mouse_seconds = mouse_stopwatch.Seconds();
+
+  // The arena takes its chunks straight from malloc, so they are not in the heap numbers.
+  size_t arena_bytes = 0;
+  size_t arena_chunks = 0;
+  for (auto& window : windows) {
+    arena_bytes += window->Model().GetArena().GetStats().bytes;
+    arena_chunks += window->Model().GetArena().GetStats().chunk_allocations;
+  }
+
+  // Includes the recorder's ForgetValues, which every window does on its way out and which has
+  // to clear the shadow of all the windows still around.
+  benchmark::Stopwatch destroy_stopwatch;
+  windows.clear();
+  auto destroy_seconds = destroy_stopwatch.Seconds();
+  benchmark::Consume(moved + events);
+
+  std::printf("  %zu windows, %zu bytes each, %zu bytes of elements in %.1f arena chunks of %zu\n",
+              kWindows,
+              sizeof(FakeWindow),
+              arena_bytes / kWindows,
+              static_cast<double>(arena_chunks) / kWindows,
+              Arena::kDefaultChunkSize);
+  std::printf("  setup: %.0f ns and %.1f heap allocations of %.0f bytes in all per window\n",
+              create_seconds * 1e9 / kWindows,
+              static_cast<double>(allocations) / kWindows,
+              static_cast<double>(bytes) / kWindows);
+  std::printf("  layout: %.0f ns per window for %zu layouts, %.1f elements moved per layout\n",
+              layout_seconds * 1e9 / kWindows,
+              std::size(kWidths) + 1,
+              static_cast<double>(moved) / (kWindows * (std::size(kWidths) + 1)));
+  std::printf("  mouse: %.0f ns per window for %.0f events\n",
+              mouse_seconds * 1e9 / kWindows,
+              static_cast<double>(events) / kWindows);
+  std::printf("  teardown: %.0f ns per window\n", destroy_seconds * 1e9 / kWindows);
+}
@@ -0,0 +1,72 @@
+#include "composition_recorder.hpp"
+#include "fake_compositor.hpp"
+#include "fake_window.hpp"
+#include "system_menu.hpp"
+#include "test.hpp"
+#include "window_model.hpp"
+
+TEST(WindowModelLaysOutTheCaption) {
+  FakeCompositor compositor;
+  CompositionRecorder recorder;
+  FakeWindow window{compositor, recorder};
+  auto& model = window.Model();
+
+  CHECK(model.Layout(Rect{0, 0, 700, 500}, 96) == 5);
+  CHECK(window.Close().Bounds() == (Rect{656, 0, 700, 47}));
+  CHECK(window.Minimize().Bounds() == (Rect{568, 0, 612, 47}));
+  CHECK(window.Caption().Bounds() == (Rect{0, 0, 700, 47}));
+  CHECK(window.Close().Dpi() == 96);
+  CHECK(window.Close().Visual().offset.x == 656);
+  CHECK(compositor.Writes() == 10);
+
+  // Nothing moves for the same size, a wider window only moves the buttons and the caption. The
+  // buttons keep their size and the caption its offset, so half the writes are skipped.
+  CHECK(model.Layout(Rect{0, 0, 700, 500}, 96) == 0);
+  CHECK(model.Layout(Rect{0, 0, 800, 500}, 96) == 4);
+  CHECK(compositor.Writes() == 14);
+  CHECK(recorder.GetStats().Skipped() == 4);
+
+  CHECK(model.Layout(Rect{0, 0, 800, 500}, 192) == 5);
+  CHECK(window.Close().Bounds() == (Rect{712, 0, 800, 94}));
+  CHECK(window.Caption().Dpi() == 192);
+}
+
+TEST(WindowModelFindsTheElementUnderAPoint) {
+  FakeCompositor compositor;
+  CompositionRecorder recorder;
+  FakeWindow window{compositor, recorder};
+  auto& model = window.Model();
+  model.Layout(Rect{0, 0, 700, 500}, 96);
+
+  CHECK(model.FindElement({690, 10}) == &window.Close());
+  CHECK(model.FindElement({300, 10}) == &window.Caption());
+  CHECK(model.FindElement({300, 100}) == nullptr);
+}
+
+TEST(WindowModelRoutesMouseAndMenuState) {
+  FakeCompositor compositor;
+  CompositionRecorder recorder;
+  FakeWindow window{compositor, recorder};
+  auto& model = window.Model();
+  model.Layout(Rect{0, 0, 700, 500}, 96);
+
+  Point point{690, 10};
+  auto* close = model.FindElement(point);
+  model.StateMachine().Dispatch(close,
+                                MouseEvent{MouseEventKind::Move, MouseButton::Left, point, true});
+  model.StateMachine().Dispatch(close,
+                                MouseEvent{MouseEventKind::Down, MouseButton::Left, point, true});
+  model.StateMachine().Dispatch(close,
+                                MouseEvent{MouseEventKind::Up, MouseButton::Left, point, true});
+  CHECK(window.Close().Clicks() == 1);
+  CHECK(window.Close().Visual().state == 1.0f);
+
+  model.LeaveTracker().Moved(true);
+  model.LeaveTracker().Moved(true);
+  CHECK(window.GetStats().leave_arms == 1);
+
+  // The first time sets every item, the same state again sets nothing.
+  model.MenuApplier().Apply(GetSystemMenuState(false, false, true));
+  model.MenuApplier().Apply(GetSystemMenuState(false, false, true));
+  CHECK(window.GetStats().menu_calls == 1 + kSystemMenuToggledCommands.size());
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <thread>
+
+// One traced window message. Written to disk as is, so the layout is fixed: 40 bytes, no padding,
+// little endian like everything we run on.
+struct TraceRecord {
+  static constexpr int32_t kNoHitTest = std::numeric_limits<int32_t>::min();
+
+  uint64_t timestamp_ns;
+  uint32_t message;
+  int32_t hit_test;
+  uint64_t wparam;
+  int64_t lparam;
+  uint32_t element_id;
+  uint32_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 40, "TraceRecord is part of the file format");
+
+// A trace file is this header followed by TraceRecords until the end of the file.
+struct TraceFileHeader {
+  static constexpr uint32_t kMagic = 0x52545057;  // "WPTR"
+  static constexpr uint32_t kVersion = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t reserved;
+};
+static_assert(sizeof(TraceFileHeader) == 16, "TraceFileHeader is part of the file format");
+
+// Reads back a file written by TraceLog, for the tools that decode and replay traces.
+class TraceFileReader {
+ public:
+  TraceFileReader() = default;
+  TraceFileReader(const TraceFileReader&) = delete;
+  TraceFileReader& operator=(const TraceFileReader&) = delete;
+  ~TraceFileReader() { Close(); }
+
+  // Fails for a file that is missing, or has a header this reader does not understand.
+  bool Open(const char* path) {
+    Close();
+#if defined(_MSC_VER)
+    if (fopen_s(&file_, path, "rb") != 0) {
+      file_ = nullptr;
+    }
+#else
+    file_ = std::fopen(path, "rb");
+#endif
+    if (!file_) {
+      return false;
+    }
+
+    TraceFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file_) != 1 ||
+        header.magic != TraceFileHeader::kMagic || header.version != TraceFileHeader::kVersion ||
+        header.record_size != sizeof(TraceRecord)) {
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  // A record cut short at the end of the file, as left by a process that did not exit cleanly,
+  // ends the trace.
+  bool Next(TraceRecord& record) {
+    return file_ && std::fread(&record, sizeof(record), 1, file_) == 1;
+  }
+
+  void Close() {
+    if (file_) {
+      std::fclose(file_);
+      file_ = nullptr;
+    }
+  }
+
+ private:
+  std::FILE* file_ = nullptr;
+};
+
+// Fixed-size single-producer single-consumer queue. The producer never blocks and never
+// allocates: when the consumer falls behind, records are dropped and counted instead.
+template <typename T, size_t Capacity>
+class SpscRing {
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+ public:
+  bool TryPush(const T& value) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ == Capacity) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ == Capacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    items_[head & (Capacity - 1)] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T& value) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) {
+        return false;
+      }
+    }
+    value = items_[tail & (Capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  // Producer and consumer state live on separate cache lines so they do not bounce between
+  // cores on every record.
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+  std::atomic<uint64_t> dropped_{0};
+
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+
+  alignas(64) std::array<T, Capacity> items_;
+};
+
+// Records go into a ring on the calling thread and a background thread writes them out in
+// batches, so tracing a message costs a clock read and a copy instead of console I/O.
+class TraceLog {
+ public:
+  static constexpr size_t kCapacity = 4096;
+
+  TraceLog() = default;
+  TraceLog(const TraceLog&) = delete;
+  TraceLog& operator=(const TraceLog&) = delete;
+  ~TraceLog() { Stop(); }
+
+  bool Start(const char* path) {
+    if (file_) {
+      return true;
+    }
+#if defined(_MSC_VER)
+    if (fopen_s(&file_, path, "wb") != 0) {
+      file_ = nullptr;
+    }
+#else
+    file_ = std::fopen(path, "wb");
+#endif
+    if (!file_) {
+      return false;
+    }
+
+    TraceFileHeader header{
+        TraceFileHeader::kMagic, TraceFileHeader::kVersion, sizeof(TraceRecord), 0};
+    std::fwrite(&header, sizeof(header), 1, file_);
+
+    running_.store(true, std::memory_order_relaxed);
+    drain_thread_ = std::thread{[this]() { Drain(); }};
+    return true;
+  }
+
+  // Writes out whatever is still queued.
+  void Stop() {
+    if (!file_) {
+      return;
+    }
+    running_.store(false, std::memory_order_release);
+    drain_thread_.join();
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+
+  // Cheap enough for every message, a no-op until Start.
+  void Push(uint32_t message,
+            uint64_t wparam,
+            int64_t lparam,
+            int32_t hit_test = TraceRecord::kNoHitTest,
+            uint32_t element_id = 0) {
+    if (!file_) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    ring_.TryPush(TraceRecord{static_cast<uint64_t>(timestamp),
+                              message,
+                              hit_test,
+                              wparam,
+                              lparam,
+                              element_id,
+                              0});
+  }
+
+  uint64_t Dropped() const { return ring_.Dropped(); }
+
+ private:
+  static constexpr size_t kBatchSize = 256;
+  static constexpr auto kIdleSleep = std::chrono::milliseconds{5};
+
+  void Drain() {
+    std::array<TraceRecord, kBatchSize> batch;
+    for (;;) {
+      // Read the flag first, so that nothing pushed before Stop is left behind.
+      auto running = running_.load(std::memory_order_acquire);
+
+      size_t count = 0;
+      while (count < batch.size() && ring_.TryPop(batch[count])) {
+        ++count;
+      }
+      if (count) {
+        std::fwrite(batch.data(), sizeof(TraceRecord), count, file_);
+        continue;
+      }
+
+      if (!running) {
+        break;
+      }
+      std::fflush(file_);
+      std::this_thread::sleep_for(kIdleSleep);
+    }
+  }
+
+  SpscRing<TraceRecord, kCapacity> ring_;
+  std::FILE* file_ = nullptr;
+  std::atomic<bool> running_{false};
+  std::thread drain_thread_;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"
+#include "element_set.hpp"
+#include "geometry.hpp"
+#include "mouse_leave_tracker.hpp"
+#include "mouse_state_machine.hpp"
+#include "row_layout.hpp"
+#include "system_menu.hpp"
+
+// The part of a titlebar window that does not need Windows: the arena its elements live in, the
+// element set, the caption layout, and the mouse and system menu state. Window adds the HWND and
+// the visual tree on top; the tests and benchmarks run the same model against stand-in elements.
+//
+// ElementT derives from ElementSetMember and has Bounds(const Rect&) and SetDpi(uint32_t), plus
+// what MouseStateMachine needs.
+template <typename ElementT>
+class WindowModel {
+ public:
+  WindowModel(int32_t caption_height,
+              typename MouseStateMachine<ElementT>::SetState set_state,
+              MouseLeaveTracker::Arm arm_leave,
+              SystemMenuStateApplier::EnableItem enable_menu_item,
+              SystemMenuStateApplier::SetDefaultItem set_default_menu_item)
+      : caption_layout_{caption_height},
+        state_machine_{std::move(set_state)},
+        leave_tracker_{std::move(arm_leave)},
+        menu_applier_{std::move(enable_menu_item), std::move(set_default_menu_item)} {}
+
+  WindowModel(const WindowModel&) = delete;
+  WindowModel& operator=(const WindowModel&) = delete;
+
+  // Holds the elements and whatever else lives as long as the window. Objects made here are
+  // destroyed newest first, after everything else in the model.
+  Arena& GetArena() { return arena_; }
+  const Arena& GetArena() const { return arena_; }
+
+  // The elements in z-order, bottom first.
+  void SetElements(std::initializer_list<std::reference_wrapper<ElementT>> elements) {
+    elements_.Reset(elements);
+  }
+
+  const ElementSet<ElementT>& Elements() const { return elements_; }
+
+  // Slots are added in element order, so a slot indexes straight into caption_layout_elements_.
+  void AddToCaptionLayout(ElementT& element, RowLayout::Anchor anchor, int32_t width = 0) {
+    caption_layout_.Add(anchor, width);
+    caption_layout_elements_.push_back(&element);
+  }
+
+  // Moves the elements whose bounds changed and hands every element the DPI. Returns the number
+  // of elements moved.
+  size_t Layout(const Rect& client_rect, uint32_t dpi) {
+    auto on_changed = [this](RowLayout::Slot slot, const Rect& bounds) {
+      caption_layout_elements_[slot]->Bounds(bounds);
+    };
+    auto changed = caption_layout_.Arrange(client_rect, dpi, on_changed);
+
+    // A no-op unless the DPI changed, so the brushes are only rebuilt when they have to be.
+    for (ElementT& element : elements_.BottomUp()) {
+      element.SetDpi(dpi);
+    }
+    return changed;
+  }
+
+  ElementT* FindElement(const Point& client_point) const {
+    return elements_.FindAtClientPointTopDown(client_point);
+  }
+
+  MouseStateMachine<ElementT>& StateMachine() { return state_machine_; }
+  const MouseStateMachine<ElementT>& StateMachine() const { return state_machine_; }
+
+  MouseLeaveTracker& LeaveTracker() { return leave_tracker_; }
+  const MouseLeaveTracker& LeaveTracker() const { return leave_tracker_; }
+
+  SystemMenuStateApplier& MenuApplier() { return menu_applier_; }
+  const SystemMenuStateApplier& MenuApplier() const { return menu_applier_; }
+
+ private:
+  // Declared first, so that it is destroyed after every member that points into it.
+  Arena arena_;
+
+  ElementSet<ElementT> elements_;
+  RowLayout caption_layout_;
+  std::vector<ElementT*> caption_layout_elements_;
+  MouseStateMachine<ElementT> state_machine_;
+  MouseLeaveTracker leave_tracker_;
+  SystemMenuStateApplier menu_applier_;
+};